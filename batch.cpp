@@ -0,0 +1,32 @@
+#include "PAZ_Graphics"
+#include "common.hpp"
+#include <algorithm>
+
+const paz::VertexBuffer& paz::quad_vertices()
+{
+    static PAZ_CONTEXT_LOCAL VertexBuffer q;
+    if(q.empty())
+    {
+        q.addAttribute(2, std::array<float, 8>{1, -1, 1, 1, -1, -1, -1, 1});
+    }
+    return q;
+}
+
+void paz::reserve_instances(InstanceBuffer& instances, std::size_t size, int
+    numAttributes)
+{
+    if(instances.size() >= size)
+    {
+        return;
+    }
+    std::size_t capacity = std::max<std::size_t>(instances.size(), 256);
+    while(capacity < size)
+    {
+        capacity *= 2;
+    }
+    instances = InstanceBuffer(capacity);
+    for(int i = 0; i < numAttributes; ++i)
+    {
+        instances.addAttribute(4, DataType::Float);
+    }
+}
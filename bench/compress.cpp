@@ -0,0 +1,59 @@
+#include "PAZ_Graphics"
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+
+static constexpr int Res = 2048;
+static constexpr int NumRuns = 3;
+
+int main()
+{
+    // Smooth gradients with some high-frequency detail.
+    paz::Image img(paz::ImageFormat::RGBA8UNorm, Res, Res);
+    for(int i = 0; i < Res; ++i)
+    {
+        for(int j = 0; j < Res; ++j)
+        {
+            unsigned char* p = img.bytes().data() + 4*(Res*i + j);
+            p[0] = 127.5 + 127.5*std::sin(0.05*j);
+            p[1] = 127.5 + 127.5*std::cos(0.03*i + 0.01*j);
+            p[2] = (i^j)&255;
+            p[3] = 255*i/(Res - 1);
+        }
+    }
+
+    const std::pair<paz::TextureFormat, const char*> formats[] =
+    {
+        {paz::TextureFormat::BC1RGBAUNorm, "BC1"},
+        {paz::TextureFormat::BC3RGBAUNorm, "BC3"},
+        {paz::TextureFormat::BC4RUNorm, "BC4"},
+        {paz::TextureFormat::BC5RGUNorm, "BC5"},
+        {paz::TextureFormat::BC7RGBAUNorm, "BC7"}
+    };
+    const std::pair<paz::CompressionQuality, const char*> qualities[] =
+    {
+        {paz::CompressionQuality::Fast, "Fast"},
+        {paz::CompressionQuality::Normal, "Normal"},
+        {paz::CompressionQuality::High, "High"}
+    };
+
+    std::cout << std::fixed << std::setprecision(1);
+    for(const auto& f : formats)
+    {
+        for(const auto& q : qualities)
+        {
+            double best = 1e9;
+            for(int i = 0; i < NumRuns; ++i)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                const auto data = paz::compress(img, f.first, q.first);
+                best = std::min(best, std::chrono::duration<double>(std::
+                    chrono::steady_clock::now() - start).count());
+            }
+            std::cout << std::setw(3) << f.second << " " << std::setw(6) << q.
+                second << ": " << std::setw(8) << 1e3*best << " ms, " << std::
+                setw(8) << Res*Res/best*1e-6 << " Mpx/s" << std::endl;
+        }
+    }
+}
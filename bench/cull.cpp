@@ -0,0 +1,66 @@
+#include "PAZ_Graphics"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <random>
+
+static constexpr std::size_t NumBounds = 1 << 20;
+static constexpr int NumRuns = 10;
+
+int main()
+{
+    // Objects scattered around the camera, about a quarter of them in view.
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<float> pos(-100.f, 100.f);
+    std::uniform_real_distribution<float> size(0.1f, 2.f);
+    std::vector<float> x(NumBounds), y(NumBounds), z(NumBounds), r(NumBounds);
+    std::vector<float> minX(NumBounds), minY(NumBounds), minZ(NumBounds), maxX(
+        NumBounds), maxY(NumBounds), maxZ(NumBounds);
+    for(std::size_t i = 0; i < NumBounds; ++i)
+    {
+        x[i] = pos(gen);
+        y[i] = pos(gen);
+        z[i] = pos(gen);
+        r[i] = size(gen);
+        minX[i] = x[i] - r[i];
+        minY[i] = y[i] - r[i];
+        minZ[i] = z[i] - r[i];
+        maxX[i] = x[i] + r[i];
+        maxY[i] = y[i] + r[i];
+        maxZ[i] = z[i] + r[i];
+    }
+    paz::BoundingSpheres spheres;
+    spheres.x = x.data();
+    spheres.y = y.data();
+    spheres.z = z.data();
+    spheres.radius = r.data();
+    spheres.size = NumBounds;
+    paz::BoundingBoxes boxes;
+    boxes.minX = minX.data();
+    boxes.minY = minY.data();
+    boxes.minZ = minZ.data();
+    boxes.maxX = maxX.data();
+    boxes.maxY = maxY.data();
+    boxes.maxZ = maxZ.data();
+    boxes.size = NumBounds;
+    const auto viewProjection = paz::perspective(1.5, 16./9., 0.1, 150.);
+
+    std::cout << std::fixed << std::setprecision(2);
+    for(int i = 0; i < 2; ++i)
+    {
+        double best = 1e9;
+        std::size_t numKept = 0;
+        for(int j = 0; j < NumRuns; ++j)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            numKept = (i ? paz::cull(viewProjection, boxes) : paz::cull(
+                viewProjection, spheres)).size();
+            best = std::min(best, std::chrono::duration<double>(std::chrono::
+                steady_clock::now() - start).count());
+        }
+        std::cout << (i ? "Boxes:   " : "Spheres: ") << std::setw(8) << 1e3*
+            best << " ms, " << numKept << "/" << NumBounds << " kept" << std::
+            endl;
+    }
+}
@@ -0,0 +1,118 @@
+#include "PAZ_Graphics"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <random>
+
+static constexpr std::size_t NumInstances = 1 << 20;
+static constexpr int NumRuns = 10;
+
+template<typename T>
+static double best_time(const T& f)
+{
+    double best = 1e9;
+    for(int i = 0; i < NumRuns; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::
+            steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+int main()
+{
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+    std::vector<float> x(NumInstances), y(NumInstances), z(NumInstances), qx(
+        NumInstances), qy(NumInstances), qz(NumInstances), qw(NumInstances),
+        scale(NumInstances);
+    for(std::size_t i = 0; i < NumInstances; ++i)
+    {
+        x[i] = 100.f*dist(gen);
+        y[i] = 100.f*dist(gen);
+        z[i] = 100.f*dist(gen);
+        qx[i] = dist(gen);
+        qy[i] = dist(gen);
+        qz[i] = dist(gen);
+        qw[i] = dist(gen);
+        const float len = std::sqrt(qx[i]*qx[i] + qy[i]*qy[i] + qz[i]*qz[i] +
+            qw[i]*qw[i]);
+        qx[i] /= len;
+        qy[i] /= len;
+        qz[i] /= len;
+        qw[i] /= len;
+        scale[i] = 1.f + dist(gen);
+    }
+    paz::InstanceTransforms transforms;
+    transforms.x = x.data();
+    transforms.y = y.data();
+    transforms.z = z.data();
+    transforms.qx = qx.data();
+    transforms.qy = qy.data();
+    transforms.qz = qz.data();
+    transforms.qw = qw.data();
+    transforms.scale = scale.data();
+    transforms.size = NumInstances;
+    std::array<std::vector<float>, 4> columns;
+    for(auto& n : columns)
+    {
+        n.resize(4*NumInstances);
+    }
+    const std::array<float*, 4> out = {columns[0].data(), columns[1].data(),
+        columns[2].data(), columns[3].data()};
+    std::vector<std::array<float, 16>> models(NumInstances);
+    const auto view = paz::look_at({0.f, 0.f, 10.f}, {0.f, 0.f, 0.f}, {0.f,
+        1.f, 0.f});
+
+    // The scalar path builds each matrix on its own and scatters its columns.
+    const double scalarModel = best_time([&]()
+    {
+        for(std::size_t i = 0; i < NumInstances; ++i)
+        {
+            const auto r = paz::rotation({qx[i], qy[i], qz[i], qw[i]});
+            models[i] = paz::transform({x[i], y[i], z[i]}, {scale[i]*r[0],
+                scale[i]*r[1], scale[i]*r[2], scale[i]*r[4], scale[i]*r[5],
+                scale[i]*r[6], scale[i]*r[8], scale[i]*r[9], scale[i]*r[10]});
+            for(int j = 0; j < 4; ++j)
+            {
+                std::copy(models[i].begin() + 4*j, models[i].begin() + 4*(j +
+                    1), out[j] + 4*i);
+            }
+        }
+    });
+    const double batchModel = best_time([&]()
+    {
+        paz::model_matrices(transforms, out);
+    });
+    const double scalarProduct = best_time([&]()
+    {
+        for(std::size_t i = 0; i < NumInstances; ++i)
+        {
+            for(int j = 0; j < 4; ++j)
+            {
+                for(int k = 0; k < 4; ++k)
+                {
+                    out[j][4*i + k] = view[k]*models[i][4*j] + view[4 + k]*
+                        models[i][4*j + 1] + view[8 + k]*models[i][4*j + 2] +
+                        view[12 + k]*models[i][4*j + 3];
+                }
+            }
+        }
+    });
+    const double batchProduct = best_time([&]()
+    {
+        paz::multiply(view, models.data(), NumInstances, out);
+    });
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Model matrices: " << std::setw(7) << 1e3*scalarModel <<
+        " ms scalar, " << std::setw(7) << 1e3*batchModel << " ms batched" <<
+        std::endl;
+    std::cout << "View products:  " << std::setw(7) << 1e3*scalarProduct <<
+        " ms scalar, " << std::setw(7) << 1e3*batchProduct << " ms batched" <<
+        std::endl;
+}
@@ -0,0 +1,72 @@
+#include "PAZ_Graphics"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+static constexpr int Width = 3840;
+static constexpr int Height = 2160;
+static constexpr int NumRuns = 10;
+
+static const std::string VertSrc = 1 + R"===(
+layout(location = 0) in vec2 pos;
+out vec2 uv;
+void main()
+{
+    uv = 0.5*pos + 0.5;
+    gl_Position = vec4(pos, 0, 1);
+}
+)===";
+
+static const std::string FragSrc = 1 + R"===(
+in vec2 uv;
+layout(location = 0) out vec4 color;
+void main()
+{
+    color = vec4(uv, 0.5 + 0.5*sin(40.*uv.x*uv.y), 1);
+}
+)===";
+
+int main()
+{
+    paz::Window::DisableHidpi();
+    paz::Window::Resize(Width, Height, true);
+
+    paz::VertexBuffer quadVerts;
+    quadVerts.addAttribute(2, std::array<float, 8>{1, -1, 1, 1, -1, -1, -1, 1});
+    const paz::VertexFunction vert(VertSrc);
+    const paz::FragmentFunction frag(FragSrc);
+    paz::RenderPass pass(vert, frag);
+    pass.begin();
+    pass.draw(paz::PrimitiveType::TriangleStrip, quadVerts);
+    pass.end();
+    paz::Window::EndFrame();
+
+    std::cout << "Viewport: " << paz::Window::ViewportWidth() << "x" << paz::
+        Window::ViewportHeight() << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+
+    double best = 1e9;
+    for(int i = 0; i < NumRuns; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const paz::Image img = paz::Window::ReadPixels();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::
+            steady_clock::now() - start).count());
+    }
+    std::cout << "ReadPixels():        " << std::setw(8) << 1e3*best << " ms"
+        << std::endl;
+
+    // Reusing the destination avoids allocating and zeroing it each time.
+    paz::Image img;
+    best = 1e9;
+    for(int i = 0; i < NumRuns; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        paz::Window::ReadPixels(img);
+        best = std::min(best, std::chrono::duration<double>(std::chrono::
+            steady_clock::now() - start).count());
+    }
+    std::cout << "ReadPixels(Image&):  " << std::setw(8) << 1e3*best << " ms"
+        << std::endl;
+}
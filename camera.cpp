@@ -1,5 +1,87 @@
 #include "PAZ_Graphics"
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <thread>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static constexpr std::size_t MinBoundsPerThread = 1 << 16;
+
+using Planes = std::array<std::array<float, 4>, 6>;
+
+// The planes bound clip space (|x|, |y|, |z| <= w) and are normalized so that
+// signed distances can be compared with radii.
+static Planes frustum_planes(const std::array<float, 16>& m)
+{
+    Planes p;
+    for(int i = 0; i < 3; ++i)
+    {
+        for(int j = 0; j < 4; ++j)
+        {
+            p[2*i][j] = m[4*j + 3] + m[4*j + i];
+            p[2*i + 1][j] = m[4*j + 3] - m[4*j + i];
+        }
+    }
+    for(auto& n : p)
+    {
+        const float len = std::sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+        if(len > 0.f)
+        {
+            for(auto& c : n)
+            {
+                c /= len;
+            }
+        }
+    }
+    return p;
+}
+
+// Splits the bounds evenly between threads and joins the kept indices in
+// order.
+template<typename T>
+static std::vector<unsigned int> cull_threaded(std::size_t size, const T&
+    cullRange)
+{
+    if(size > std::numeric_limits<unsigned int>::max())
+    {
+        throw std::invalid_argument("Too many bounds to cull.");
+    }
+    const int numThreads = std::max<std::size_t>(1, std::min<std::size_t>(std::
+        thread::hardware_concurrency(), size/MinBoundsPerThread));
+    std::vector<std::vector<unsigned int>> kept(numThreads);
+    std::vector<std::thread> threads;
+    for(int i = 1; i < numThreads; ++i)
+    {
+        threads.emplace_back([&, i]()
+        {
+            cullRange(size*i/numThreads, size*(i + 1)/numThreads, kept[i]);
+        });
+    }
+    cullRange(0, size/numThreads, kept[0]);
+    for(auto& n : threads)
+    {
+        n.join();
+    }
+    for(int i = 1; i < numThreads; ++i)
+    {
+        kept[0].insert(kept[0].end(), kept[i].begin(), kept[i].end());
+    }
+    return std::move(kept[0]);
+}
+
+#ifdef __SSE2__
+// Writes the kept indices without branching on which were kept.
+static void push_mask(int mask, std::size_t first, unsigned int*& out)
+{
+    for(int i = 0; i < 4; ++i)
+    {
+        *out = first + i;
+        out += (mask >> i)&1;
+    }
+}
+#endif
 
 std::array<float, 16> paz::perspective(float yFov, float ratio, float zNear,
     float zFar)
@@ -28,6 +110,37 @@ std::array<float, 16> paz::ortho(const float left, const float right, const
     return res;
 }
 
+// The camera looks down its negative z-axis, as `perspective()` expects.
+std::array<float, 16> paz::look_at(const std::array<float, 3>& eye, const std::
+    array<float, 3>& target, const std::array<float, 3>& up)
+{
+    const auto normalize = [](std::array<float, 3> v)
+    {
+        const float len = std::sqrt(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+        if(!len)
+        {
+            throw std::invalid_argument("Camera direction is degenerate.");
+        }
+        return std::array<float, 3>{v[0]/len, v[1]/len, v[2]/len};
+    };
+    const auto cross = [](const std::array<float, 3>& a, const std::array<float,
+        3>& b)
+    {
+        return std::array<float, 3>{a[1]*b[2] - a[2]*b[1], a[2]*b[0] - a[0]*
+            b[2], a[0]*b[1] - a[1]*b[0]};
+    };
+    const auto f = normalize({target[0] - eye[0], target[1] - eye[1], target[2]
+        - eye[2]});
+    const auto r = normalize(cross(f, up));
+    const auto u = cross(r, f);
+    return {r[0], u[0], -f[0], 0.f,
+            r[1], u[1], -f[1], 0.f,
+            r[2], u[2], -f[2], 0.f,
+            -(r[0]*eye[0] + r[1]*eye[1] + r[2]*eye[2]),
+            -(u[0]*eye[0] + u[1]*eye[1] + u[2]*eye[2]),
+            f[0]*eye[0] + f[1]*eye[1] + f[2]*eye[2], 1.f};
+}
+
 #if 0
 std::array<float, 16> paz::translation(const std::array<float, 3>& delta)
 {
@@ -122,3 +235,126 @@ std::array<float, 16> paz::transform(const std::array<float, 3>& delta, const
               rot[6],   rot[7],   rot[8], 0.f,
             delta[0], delta[1], delta[2], 1.f};
 }
+
+std::vector<unsigned int> paz::cull(const std::array<float, 16>& viewProjection,
+    const BoundingSpheres& bounds)
+{
+    if(bounds.size && (!bounds.x || !bounds.y || !bounds.z || !bounds.radius))
+    {
+        throw std::invalid_argument("Bounding spheres are missing a component."
+            );
+    }
+    const Planes p = frustum_planes(viewProjection);
+    return cull_threaded(bounds.size, [&](std::size_t begin, std::size_t end,
+        std::vector<unsigned int>& out)
+    {
+        out.resize(end - begin);
+        unsigned int* next = out.data();
+        std::size_t i = begin;
+#ifdef __SSE2__
+        // Four spheres are tested against each plane at once.
+        __m128 planes[6][4];
+        for(int j = 0; j < 6; ++j)
+        {
+            for(int k = 0; k < 4; ++k)
+            {
+                planes[j][k] = _mm_set1_ps(p[j][k]);
+            }
+        }
+        for(; i + 4 <= end; i += 4)
+        {
+            const __m128 x = _mm_loadu_ps(bounds.x + i);
+            const __m128 y = _mm_loadu_ps(bounds.y + i);
+            const __m128 z = _mm_loadu_ps(bounds.z + i);
+            const __m128 negR = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(
+                bounds.radius + i));
+            __m128 inside = _mm_cmpeq_ps(x, x);
+            for(const auto& n : planes)
+            {
+                const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(n[0], x),
+                    _mm_mul_ps(n[1], y)), _mm_add_ps(_mm_mul_ps(n[2], z),
+                    n[3]));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negR));
+            }
+            push_mask(_mm_movemask_ps(inside), i, next);
+        }
+#endif
+        for(; i < end; ++i)
+        {
+            bool inside = true;
+            for(const auto& n : p)
+            {
+                inside = inside && n[0]*bounds.x[i] + n[1]*bounds.y[i] + n[2]*
+                    bounds.z[i] + n[3] >= -bounds.radius[i];
+            }
+            *next = i;
+            next += inside;
+        }
+        out.resize(next - out.data());
+    });
+}
+
+std::vector<unsigned int> paz::cull(const std::array<float, 16>& viewProjection,
+    const BoundingBoxes& bounds)
+{
+    if(bounds.size && (!bounds.minX || !bounds.minY || !bounds.minZ || !bounds.
+        maxX || !bounds.maxY || !bounds.maxZ))
+    {
+        throw std::invalid_argument("Bounding boxes are missing a component.");
+    }
+    const Planes p = frustum_planes(viewProjection);
+
+    // A box is outside if its corner furthest along a plane's normal is.
+    std::array<std::array<const float*, 3>, 6> corner;
+    for(int j = 0; j < 6; ++j)
+    {
+        corner[j] = {p[j][0] < 0.f ? bounds.minX : bounds.maxX, p[j][1] < 0.f ?
+            bounds.minY : bounds.maxY, p[j][2] < 0.f ? bounds.minZ : bounds.
+            maxZ};
+    }
+    return cull_threaded(bounds.size, [&](std::size_t begin, std::size_t end,
+        std::vector<unsigned int>& out)
+    {
+        out.resize(end - begin);
+        unsigned int* next = out.data();
+        std::size_t i = begin;
+#ifdef __SSE2__
+        // Four boxes are tested against each plane at once.
+        __m128 planes[6][4];
+        for(int j = 0; j < 6; ++j)
+        {
+            for(int k = 0; k < 4; ++k)
+            {
+                planes[j][k] = _mm_set1_ps(p[j][k]);
+            }
+        }
+        const __m128 zero = _mm_setzero_ps();
+        for(; i + 4 <= end; i += 4)
+        {
+            __m128 inside = _mm_cmpeq_ps(zero, zero);
+            for(int j = 0; j < 6; ++j)
+            {
+                const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planes[j][0],
+                    _mm_loadu_ps(corner[j][0] + i)), _mm_mul_ps(planes[j][1],
+                    _mm_loadu_ps(corner[j][1] + i))), _mm_add_ps(_mm_mul_ps(
+                    planes[j][2], _mm_loadu_ps(corner[j][2] + i)), planes[j][
+                    3]));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(d, zero));
+            }
+            push_mask(_mm_movemask_ps(inside), i, next);
+        }
+#endif
+        for(; i < end; ++i)
+        {
+            bool inside = true;
+            for(int j = 0; j < 6; ++j)
+            {
+                inside = inside && p[j][0]*corner[j][0][i] + p[j][1]*corner[j][
+                    1][i] + p[j][2]*corner[j][2][i] + p[j][3] >= 0.f;
+            }
+            *next = i;
+            next += inside;
+        }
+        out.resize(next - out.data());
+    });
+}
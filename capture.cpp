@@ -0,0 +1,501 @@
+#include "PAZ_Graphics"
+#include "common.hpp"
+#include "internal_data.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <thread>
+#ifdef PAZ_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static constexpr std::size_t MaxFramesInFlight = 3;
+static constexpr std::size_t MaxFramesQueued = 4;
+static constexpr std::size_t SharedHeaderSize = 64;
+static constexpr std::size_t SlotHeaderSize = 64;
+
+namespace
+{
+    enum class Sink
+    {
+        File, Pipe, SharedMemory
+    };
+
+    struct PendingFrame
+    {
+        paz::ReadbackRequest request;
+        std::chrono::steady_clock::time_point ended;
+    };
+
+    struct QueuedFrame
+    {
+        paz::Image pixels;
+        std::chrono::steady_clock::time_point ended;
+    };
+
+    struct Capture
+    {
+        bool active = false;
+        Sink sink;
+        paz::CaptureFormat format;
+        int fps;
+        std::FILE* file = nullptr;
+        std::string sharedName;
+        int numSlots;
+        void* shared = nullptr;
+        std::size_t sharedSize;
+        std::size_t slotSize;
+        int width;
+        int height;
+
+        // Owned by the render thread.
+        std::deque<PendingFrame> inFlight;
+
+        // Shared with the converter thread.
+        std::thread converter;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<QueuedFrame> queue;
+        bool stopping;
+        std::string error;
+        paz::CaptureStats stats;
+        double totalLatency;
+
+        ~Capture();
+    };
+}
+
+static Capture& capture()
+{
+    static PAZ_CONTEXT_LOCAL Capture c;
+    return c;
+}
+
+// Full-range BT.601 with chroma averaged over 2x2 blocks (`C420jpeg`).
+static void rgba_to_yuv420(const unsigned char* rgba, int width, int height,
+    std::vector<unsigned char>& yuv)
+{
+    const int chromaWidth = (width + 1)/2;
+    const int chromaHeight = (height + 1)/2;
+    const std::size_t numLuma = static_cast<std::size_t>(width)*height;
+    const std::size_t numChroma = static_cast<std::size_t>(chromaWidth)*
+        chromaHeight;
+    yuv.resize(numLuma + 2*numChroma);
+    unsigned char* y = yuv.data();
+    unsigned char* u = y + numLuma;
+    unsigned char* v = u + numChroma;
+    for(std::size_t i = 0; i < numLuma; ++i)
+    {
+        const unsigned char* p = rgba + 4*i;
+        y[i] = (77*p[0] + 150*p[1] + 29*p[2] + 128) >> 8;
+    }
+    for(int i = 0; i < chromaHeight; ++i)
+    {
+        for(int j = 0; j < chromaWidth; ++j)
+        {
+            int r = 0;
+            int g = 0;
+            int b = 0;
+            int n = 0;
+            for(int k = 2*i; k < std::min(2*i + 2, height); ++k)
+            {
+                for(int l = 2*j; l < std::min(2*j + 2, width); ++l)
+                {
+                    const unsigned char* p = rgba + 4*(static_cast<std::
+                        size_t>(width)*k + l);
+                    r += p[0];
+                    g += p[1];
+                    b += p[2];
+                    ++n;
+                }
+            }
+            r /= n;
+            g /= n;
+            b /= n;
+            const std::size_t idx = static_cast<std::size_t>(chromaWidth)*i + j;
+            u[idx] = std::min(255, (-43*r - 85*g + 128*b + 32896) >> 8);
+            v[idx] = std::min(255, (128*r - 107*g - 21*b + 32896) >> 8);
+        }
+    }
+}
+
+static void write_bytes(std::FILE* file, const void* data, std::size_t size)
+{
+    if(std::fwrite(data, 1, size, file) != size)
+    {
+        throw std::runtime_error("Failed to write captured frame.");
+    }
+}
+
+static void open_shared_memory(Capture& c)
+{
+#ifdef PAZ_UNIX
+    c.slotSize = (SlotHeaderSize + 4*static_cast<std::size_t>(c.width)*c.
+        height + 63)/64*64;
+    c.sharedSize = SharedHeaderSize + c.numSlots*c.slotSize;
+    const int fd = shm_open(c.sharedName.c_str(), O_CREAT|O_RDWR, 0600);
+    if(fd < 0)
+    {
+        throw std::runtime_error("Failed to open shared memory object \"" + c.
+            sharedName + "\".");
+    }
+    if(ftruncate(fd, c.sharedSize))
+    {
+        close(fd);
+        throw std::runtime_error("Failed to size shared memory object \"" + c.
+            sharedName + "\".");
+    }
+    void* ptr = mmap(nullptr, c.sharedSize, PROT_READ|PROT_WRITE, MAP_SHARED,
+        fd, 0);
+    close(fd);
+    if(ptr == MAP_FAILED)
+    {
+        throw std::runtime_error("Failed to map shared memory object \"" + c.
+            sharedName + "\".");
+    }
+    c.shared = ptr;
+
+    unsigned char* base = static_cast<unsigned char*>(c.shared);
+    const std::uint32_t dims[] = {static_cast<std::uint32_t>(c.width), static_cast<
+        std::uint32_t>(c.height), static_cast<std::uint32_t>(c.numSlots)};
+    const std::uint64_t slotSize = c.slotSize;
+    std::memcpy(base, "PAZCAP1", 8);
+    std::memcpy(base + 8, dims, sizeof(dims));
+    std::memcpy(base + 24, &slotSize, sizeof(slotSize));
+    new(base + 32) std::atomic<std::uint64_t>(0);
+    for(int i = 0; i < c.numSlots; ++i)
+    {
+        new(base + SharedHeaderSize + i*c.slotSize) std::atomic<std::uint64_t>(
+            0);
+    }
+#else
+    static_cast<void>(c);
+#endif
+}
+
+static void write_frame(Capture& c, const paz::Image& pixels, std::uint64_t
+    idx, std::vector<unsigned char>& rgba, std::vector<unsigned char>& yuv)
+{
+    const int width = pixels.width();
+    const int height = pixels.height();
+    rgba.resize(4*static_cast<std::size_t>(width)*height);
+    paz::convert_to_srgb(reinterpret_cast<const std::uint16_t*>(pixels.bytes().
+        data()), 8*width, rgba.data(), width, height, true);
+
+    if(c.sink == Sink::SharedMemory)
+    {
+        if(!c.shared)
+        {
+            open_shared_memory(c);
+        }
+
+        // Readers retry if the sequence is odd or changes while they copy.
+        unsigned char* base = static_cast<unsigned char*>(c.shared);
+        unsigned char* slot = base + SharedHeaderSize + (idx%c.numSlots)*c.
+            slotSize;
+        auto* seq = reinterpret_cast<std::atomic<std::uint64_t>*>(slot);
+        seq->store(2*idx + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::copy(rgba.begin(), rgba.end(), slot + SlotHeaderSize);
+        seq->store(2*idx + 2, std::memory_order_release);
+        reinterpret_cast<std::atomic<std::uint64_t>*>(base + 32)->store(idx +
+            1, std::memory_order_release);
+    }
+    else if(c.format == paz::CaptureFormat::Y4m)
+    {
+        if(!idx)
+        {
+            const std::string header = "YUV4MPEG2 W" + std::to_string(width) +
+                " H" + std::to_string(height) + " F" + std::to_string(c.fps) +
+                ":1 Ip A1:1 C420jpeg\n";
+            write_bytes(c.file, header.data(), header.size());
+        }
+        rgba_to_yuv420(rgba.data(), width, height, yuv);
+        write_bytes(c.file, "FRAME\n", 6);
+        write_bytes(c.file, yuv.data(), yuv.size());
+    }
+    else
+    {
+        write_bytes(c.file, rgba.data(), rgba.size());
+    }
+}
+
+static void convert_frames(Capture& c)
+{
+    std::vector<unsigned char> rgba;
+    std::vector<unsigned char> yuv;
+    for(std::uint64_t idx = 0;; ++idx)
+    {
+        QueuedFrame f;
+        {
+            std::unique_lock<std::mutex> lock(c.mutex);
+            c.cv.wait(lock, [&](){ return c.stopping || !c.queue.empty(); });
+            if(c.queue.empty())
+            {
+                return;
+            }
+            f = std::move(c.queue.front());
+            c.queue.pop_front();
+        }
+        try
+        {
+            write_frame(c, f.pixels, idx, rgba, yuv);
+        }
+        catch(const std::exception& e)
+        {
+            std::lock_guard<std::mutex> lock(c.mutex);
+            c.error = e.what();
+            c.stats.framesDropped += c.queue.size() + 1;
+            c.queue.clear();
+            return;
+        }
+        const double latency = std::chrono::duration<double>(std::chrono::
+            steady_clock::now() - f.ended).count();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        ++c.stats.framesWritten;
+        c.totalLatency += latency;
+        c.stats.meanLatency = c.totalLatency/c.stats.framesWritten;
+        c.stats.maxLatency = std::max(c.stats.maxLatency, latency);
+    }
+}
+
+static void start_capture(Capture& c, Sink sink, paz::CaptureFormat format,
+    int fps)
+{
+    c.sink = sink;
+    c.format = format;
+    c.fps = fps;
+    c.width = 0;
+    c.height = 0;
+    c.stopping = false;
+    c.error.clear();
+    c.stats = {};
+    c.totalLatency = 0.;
+    c.converter = std::thread(convert_frames, std::ref(c));
+    c.active = true;
+}
+
+static void finish_capture(Capture& c)
+{
+    {
+        std::lock_guard<std::mutex> lock(c.mutex);
+        c.stopping = true;
+    }
+    c.cv.notify_one();
+    c.converter.join();
+    c.inFlight.clear();
+    c.active = false;
+
+    if(c.sink == Sink::File)
+    {
+        std::fclose(c.file);
+    }
+    else if(c.sink == Sink::Pipe)
+    {
+#ifdef PAZ_WINDOWS
+        _pclose(c.file);
+#else
+        pclose(c.file);
+#endif
+    }
+#ifdef PAZ_UNIX
+    else if(c.shared)
+    {
+        munmap(c.shared, c.sharedSize);
+        shm_unlink(c.sharedName.c_str());
+    }
+#endif
+    c.file = nullptr;
+    c.shared = nullptr;
+}
+
+Capture::~Capture()
+{
+    if(active)
+    {
+        finish_capture(*this);
+    }
+}
+
+static void check_capture_format(paz::CaptureFormat format, int fps)
+{
+    if(format != paz::CaptureFormat::RawRgba && format != paz::CaptureFormat::
+        Y4m)
+    {
+        throw std::invalid_argument("Unknown capture format.");
+    }
+    if(fps < 1)
+    {
+        throw std::invalid_argument("Capture frame rate must be positive.");
+    }
+}
+
+void paz::retire_captured_frames(bool wait)
+{
+    auto& c = capture();
+    while(!c.inFlight.empty() && (wait || c.inFlight.front().request.ready()))
+    {
+        auto& req = *c.inFlight.front().request._data;
+        if(!req._done)
+        {
+            req.finish();
+            req._done = true;
+        }
+        QueuedFrame f = {std::move(req._result), c.inFlight.front().ended};
+        c.inFlight.pop_front();
+
+        std::unique_lock<std::mutex> lock(c.mutex);
+        if(!c.width)
+        {
+            c.width = f.pixels.width();
+            c.height = f.pixels.height();
+        }
+        if(f.pixels.width() != c.width || f.pixels.height() != c.height || c.
+            queue.size() >= MaxFramesQueued || !c.error.empty())
+        {
+            ++c.stats.framesDropped;
+            continue;
+        }
+        c.queue.push_back(std::move(f));
+        lock.unlock();
+        c.cv.notify_one();
+    }
+}
+
+void paz::capture_frame()
+{
+    auto& c = capture();
+    if(!c.active)
+    {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(c.mutex);
+        if(!c.error.empty())
+        {
+            const std::string error = c.error;
+            lock.unlock();
+            finish_capture(c);
+            throw std::runtime_error("Capture failed: " + error);
+        }
+    }
+
+    // Hand finished readbacks to the converter without waiting for the rest.
+    retire_captured_frames(false);
+
+    const auto color = final_framebuffer().colorAttachment(0);
+    if(c.inFlight.size() >= MaxFramesInFlight || !color.width() || !color.
+        height())
+    {
+        std::lock_guard<std::mutex> lock(c.mutex);
+        ++c.stats.framesDropped;
+        return;
+    }
+    c.inFlight.push_back({color.readAsync(0, 0, color.width(), color.height()),
+        std::chrono::steady_clock::now()});
+}
+
+void paz::Window::StartCapture(const std::string& path, CaptureFormat format,
+    int fps)
+{
+    initialize();
+
+    auto& c = capture();
+    if(c.active)
+    {
+        throw std::logic_error("Capture is already in progress.");
+    }
+    check_capture_format(format, fps);
+    c.file = std::fopen(path.c_str(), "wb");
+    if(!c.file)
+    {
+        throw std::runtime_error("Failed to open \"" + path + "\" for capture."
+            );
+    }
+    start_capture(c, Sink::File, format, fps);
+}
+
+void paz::Window::StartCaptureToPipe(const std::string& command, CaptureFormat
+    format, int fps)
+{
+    initialize();
+
+    auto& c = capture();
+    if(c.active)
+    {
+        throw std::logic_error("Capture is already in progress.");
+    }
+    check_capture_format(format, fps);
+#ifdef PAZ_WINDOWS
+    c.file = _popen(command.c_str(), "wb");
+#else
+    c.file = popen(command.c_str(), "w");
+#endif
+    if(!c.file)
+    {
+        throw std::runtime_error("Failed to start \"" + command + "\" for captu"
+            "re.");
+    }
+    start_capture(c, Sink::Pipe, format, fps);
+}
+
+void paz::Window::StartCaptureToSharedMemory(const std::string& name, int
+    numSlots)
+{
+    initialize();
+
+#ifdef PAZ_UNIX
+    auto& c = capture();
+    if(c.active)
+    {
+        throw std::logic_error("Capture is already in progress.");
+    }
+    if(numSlots < 1)
+    {
+        throw std::invalid_argument("Shared memory capture needs at least one s"
+            "lot.");
+    }
+    c.sharedName = name;
+    c.numSlots = numSlots;
+    start_capture(c, Sink::SharedMemory, CaptureFormat::RawRgba, 1);
+#else
+    static_cast<void>(name);
+    static_cast<void>(numSlots);
+    throw std::logic_error("Shared memory capture is not supported on this plat"
+        "form.");
+#endif
+}
+
+void paz::Window::StopCapture()
+{
+    initialize();
+
+    auto& c = capture();
+    if(!c.active)
+    {
+        return;
+    }
+    retire_captured_frames(true);
+    finish_capture(c);
+    if(!c.error.empty())
+    {
+        throw std::runtime_error("Capture failed: " + c.error);
+    }
+}
+
+paz::CaptureStats paz::Window::CaptureStatistics()
+{
+    initialize();
+
+    auto& c = capture();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    return c.stats;
+}
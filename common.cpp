@@ -1,13 +1,121 @@
 #include "common.hpp"
+#include "internal_data.hpp"
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+static constexpr int MinPixelsPerThread = 1 << 16;
+
+namespace
+{
+    // Workers for `convert_to_srgb`, started on first use and kept for the
+    // life of the process. Concurrent callers take turns.
+    class ConvertPool
+    {
+        std::mutex _callMutex;
+        std::mutex _mutex;
+        std::condition_variable _posted;
+        std::condition_variable _finished;
+        std::vector<std::thread> _workers;
+        const std::function<void(int)>* _task = nullptr;
+        std::size_t _generation = 0;
+        int _numTasks = 0;
+        int _remaining = 0;
+        bool _stop = false;
+
+        void work(int idx)
+        {
+            std::size_t seen = 0;
+            std::unique_lock<std::mutex> lk(_mutex);
+            while(true)
+            {
+                _posted.wait(lk, [&](){ return _stop || seen != _generation; });
+                if(_stop)
+                {
+                    return;
+                }
+                seen = _generation;
+                if(idx >= _numTasks)
+                {
+                    continue;
+                }
+                lk.unlock();
+                (*_task)(idx + 1);
+                lk.lock();
+                if(!--_remaining)
+                {
+                    _finished.notify_one();
+                }
+            }
+        }
+
+    public:
+        ConvertPool(int numWorkers)
+        {
+            for(int i = 0; i < numWorkers; ++i)
+            {
+                _workers.emplace_back(&ConvertPool::work, this, i);
+            }
+        }
+
+        ~ConvertPool()
+        {
+            {
+                std::lock_guard<std::mutex> lk(_mutex);
+                _stop = true;
+            }
+            _posted.notify_all();
+            for(auto& n : _workers)
+            {
+                n.join();
+            }
+        }
+
+        int size() const
+        {
+            return static_cast<int>(_workers.size()) + 1;
+        }
+
+        // Runs `task(0)` through `task(numTasks - 1)`, the first on the
+        // calling thread, and returns when all have finished.
+        void run(int numTasks, const std::function<void(int)>& task)
+        {
+            if(numTasks == 1)
+            {
+                task(0);
+                return;
+            }
+            std::lock_guard<std::mutex> call(_callMutex);
+            {
+                std::lock_guard<std::mutex> lk(_mutex);
+                _task = &task;
+                _numTasks = numTasks - 1;
+                _remaining = numTasks - 1;
+                ++_generation;
+            }
+            _posted.notify_all();
+            task(0);
+            std::unique_lock<std::mutex> lk(_mutex);
+            _finished.wait(lk, [&](){ return !_remaining; });
+        }
+    };
+}
 
 paz::Framebuffer paz::final_framebuffer()
 {
-    static const Framebuffer f = []()
+    static PAZ_CONTEXT_LOCAL const Framebuffer f = []()
     {
+        RenderTarget color(TextureFormat::RGBA16UNorm);
+        RenderTarget depth(TextureFormat::Depth16UNorm);
+        static_cast<Texture&>(color)._data->_exactSize = true;
+        static_cast<Texture&>(depth)._data->_exactSize = true;
         Framebuffer f;
-        f.attach(RenderTarget(TextureFormat::RGBA16UNorm));
-        f.attach(RenderTarget(TextureFormat::Depth16UNorm));
+        f.attach(color);
+        f.attach(depth);
         return f;
     }();
     return f;
@@ -22,19 +130,70 @@ unsigned char paz::to_srgb(double x)
     return std::round(x*255.);
 }
 
-paz::Image paz::flip_image(const paz::Image& image)
+void paz::convert_to_srgb(const std::uint16_t* src, std::size_t srcRowPitch,
+    unsigned char* dst, int width, int height, bool flip)
 {
-    if(image.height() < 2)
+    static const auto lut = []()
     {
-        return image;
+        std::array<unsigned char, 65536> lut;
+        for(std::size_t i = 0; i < lut.size(); ++i)
+        {
+            lut[i] = to_srgb(i/65535.);
+        }
+        return lut;
+    }();
+
+    // Split rows evenly between threads.
+    static ConvertPool pool(std::max(1, static_cast<int>(std::thread::
+        hardware_concurrency())) - 1);
+    const int numThreads = std::max(1, std::min({pool.size(), width*height/
+        MinPixelsPerThread, height}));
+    pool.run(numThreads, [&](int idx)
+    {
+        for(int i = height*idx/numThreads; i < height*(idx + 1)/numThreads; ++i)
+        {
+            const std::uint16_t* s = reinterpret_cast<const std::uint16_t*>(
+                reinterpret_cast<const unsigned char*>(src) + srcRowPitch*(flip
+                ? height - i - 1 : i));
+            unsigned char* d = dst + 4*static_cast<std::size_t>(width)*i;
+            for(int j = 0; j < 4*width; j += 4)
+            {
+                d[j] = lut[s[j]];
+                d[j + 1] = lut[s[j + 1]];
+                d[j + 2] = lut[s[j + 2]];
+                d[j + 3] = (s[j + 3] + 128u)/257u;
+            }
+        }
+    });
+}
+
+std::size_t paz::check_row_pitch(std::size_t rowPitch, std::size_t
+    bytesPerRow, std::size_t bytesPerPixel)
+{
+    if(!rowPitch)
+    {
+        return bytesPerRow;
     }
-    paz::Image flipped = image;
-    const std::size_t bytesPerRow = image.bytes().size()/image.height();
-    for(int i = 0; i < image.height(); ++i)
+    if(rowPitch < bytesPerRow || rowPitch%bytesPerPixel)
     {
-        std::copy(image.bytes().begin() + bytesPerRow*i, image.bytes().begin() +
-            bytesPerRow*(i + 1), flipped.bytes().begin() + bytesPerRow*(image.
-            height() - i - 1));
+        throw std::invalid_argument("Row pitch must be a multiple of the pixel "
+            "size and at least one row.");
+    }
+    return rowPitch;
+}
+
+std::unique_ptr<unsigned char[]> paz::flip_rows(const void* data, std::size_t
+    rowPitch, std::size_t bytesPerRow, int height)
+{
+    // Every byte is overwritten, so skip value-initialization.
+    std::unique_ptr<unsigned char[]> flipped(new unsigned char[bytesPerRow*
+        height]);
+    for(int i = 0; i < height; ++i)
+    {
+        const unsigned char* src = reinterpret_cast<const unsigned char*>(data)
+            + rowPitch*i;
+        std::copy(src, src + bytesPerRow, flipped.get() + bytesPerRow*(height -
+            i - 1));
     }
     return flipped;
 }
@@ -43,7 +202,7 @@ paz::Initializer& paz::initialize()
 {
     try
     {
-        static paz::Initializer initializer;
+        static PAZ_CONTEXT_LOCAL paz::Initializer initializer;
         return initializer;
     }
     catch(const std::exception& e)
@@ -52,3 +211,34 @@ paz::Initializer& paz::initialize()
             string(e.what()));
     }
 }
+
+bool paz::is_compressed(TextureFormat format)
+{
+    return format == TextureFormat::BC1RGBAUNorm || format == TextureFormat::
+        BC3RGBAUNorm || format == TextureFormat::BC4RUNorm || format ==
+        TextureFormat::BC5RGUNorm || format == TextureFormat::BC7RGBAUNorm;
+}
+
+std::size_t paz::compressed_size(TextureFormat format, int width, int height)
+{
+    const std::size_t bytesPerBlock = format == TextureFormat::BC1RGBAUNorm ||
+        format == TextureFormat::BC4RUNorm ? 8 : 16;
+    return bytesPerBlock*((width + 3)/4)*((height + 3)/4);
+}
+
+paz::ImageFormat paz::readback_format(TextureFormat format)
+{
+    if(format == TextureFormat::Depth16UNorm)
+    {
+        return ImageFormat::R16UNorm;
+    }
+    if(format == TextureFormat::Depth32Float)
+    {
+        return ImageFormat::R32Float;
+    }
+    if(static_cast<int>(format) > static_cast<int>(TextureFormat::RGBA32Float))
+    {
+        throw std::logic_error("Texture format cannot be read back.");
+    }
+    return static_cast<ImageFormat>(format);
+}
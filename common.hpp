@@ -9,15 +9,62 @@
 #include <unordered_set>
 #include <cstdint>
 #include <chrono>
+#include <memory>
+
+// Headless builds give each thread its own context, so per-context state is
+// thread-local there.
+#ifdef PAZ_HEADLESS
+#define PAZ_CONTEXT_LOCAL thread_local
+#else
+#define PAZ_CONTEXT_LOCAL
+#endif
+
+#define PAZ_PROFILE(name) const paz::ProfileScope pazProfileScope(name)
 
 namespace paz
 {
     void register_target(void* t);
     void unregister_target(void* t);
     void resize_targets();
+    void release_transients();
+    void capture_frame();
+    void retire_captured_frames(bool wait);
+    void process_uploads();
+#ifdef PAZ_MACOS
+    void begin_pass_timing(const std::string& name, void* descriptor);
+#else
+    void begin_pass_timing(const std::string& name);
+    void end_pass_timing();
+#endif
+    void resolve_gpu_timing();
+    FrameStats& frame_stats();
+    void end_frame_stats();
+    void count_draw(PrimitiveType type, std::size_t numVertices, std::size_t
+        numInstances);
+    void mark_redraw();
+    void wake_event_loop();
+    void wait_for_redraw_request(double timeout);
+    void pace_frame(bool background);
     Framebuffer final_framebuffer();
+    // Shared by the text and sprite batches.
+    const VertexBuffer& quad_vertices();
+    // Grows `instances` geometrically to hold at least `size` instances of
+    // `numAttributes` four-component float attributes.
+    void reserve_instances(InstanceBuffer& instances, std::size_t size, int
+        numAttributes);
     unsigned char to_srgb(double x);
-    Image flip_image(const Image& img);
+    void convert_to_srgb(const std::uint16_t* src, std::size_t srcRowPitch,
+        unsigned char* dst, int width, int height, bool flip);
+    std::size_t check_row_pitch(std::size_t rowPitch, std::size_t bytesPerRow,
+        std::size_t bytesPerPixel);
+    std::unique_ptr<unsigned char[]> flip_rows(const void* data, std::size_t
+        rowPitch, std::size_t bytesPerRow, int height);
+    bool is_compressed(TextureFormat format);
+    // Converts blocks between bottom-to-top and top-to-bottom row order.
+    std::unique_ptr<unsigned char[]> flip_blocks(TextureFormat format, const
+        void* data, int width, int height);
+    std::size_t compressed_size(TextureFormat format, int width, int height);
+    ImageFormat readback_format(TextureFormat format);
 #ifndef PAZ_MACOS
     void begin_frame();
 #endif
@@ -25,9 +72,36 @@ namespace paz
     ID3D11Device* d3d_device();
     ID3D11DeviceContext* d3d_context();
 #endif
+    // Counts the construction and destruction of the object holding it.
+    template<std::uint64_t FrameStats::*Created, std::uint64_t FrameStats::*
+        Destroyed>
+    struct ObjectCounter
+    {
+        ObjectCounter()
+        {
+            ++(frame_stats().*Created);
+        }
+        ObjectCounter(const ObjectCounter&) : ObjectCounter() {}
+        ObjectCounter& operator=(const ObjectCounter&)
+        {
+            return *this;
+        }
+        ~ObjectCounter()
+        {
+            ++(frame_stats().*Destroyed);
+        }
+    };
+    using BufferCounter = ObjectCounter<&FrameStats::buffersCreated,
+        &FrameStats::buffersDestroyed>;
+    using TextureCounter = ObjectCounter<&FrameStats::texturesCreated,
+        &FrameStats::texturesDestroyed>;
+    using ProgramCounter = ObjectCounter<&FrameStats::programsCreated,
+        &FrameStats::programsDestroyed>;
     struct Initializer
     {
         std::unordered_set<void*> renderTargets;
+        bool growOnlyTargets = false;
+        bool gpuTiming = false;
         Initializer();
         ~Initializer();
     };
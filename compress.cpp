@@ -0,0 +1,835 @@
+#include "PAZ_Graphics"
+#include "common.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <thread>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static constexpr int MinBlocksPerThread = 1024;
+
+static constexpr std::array<float, 4> Bc1Weights = {0.f, 1.f, 1.f/3.f, 2.f/
+    3.f};
+static constexpr std::array<int, 16> Bc7Weights = {0, 4, 9, 13, 17, 21, 26, 30,
+    34, 38, 43, 47, 51, 55, 60, 64};
+
+// Texels are stored one channel per row so four can be processed at once.
+struct Block
+{
+    alignas(16) float c[4][16];
+};
+
+using Palette = float[16][4];
+
+static void load_block(const paz::Image& image, int numChannels, int blockX,
+    int blockY, Block& b)
+{
+    for(int i = 0; i < 4; ++i)
+    {
+        const unsigned char* src = image.bytes().data() + (static_cast<std::
+            size_t>(4*blockY + i)*image.width() + 4*blockX)*numChannels;
+        for(int j = 0; j < 4; ++j)
+        {
+            for(int c = 0; c < 4; ++c)
+            {
+                b.c[c][4*i + j] = c < numChannels ? src[numChannels*j + c] : (c
+                    == 3 ? 255.f : 0.f);
+            }
+        }
+    }
+}
+
+// Assigns each texel to the closest palette entry and returns the total
+// squared error.
+static float nearest_indices(const float (*c)[16], int numChannels, const
+    Palette& palette, int n, std::uint8_t* idx)
+{
+    float err = 0.f;
+#ifdef __SSE2__
+    for(int i = 0; i < 16; i += 4)
+    {
+        __m128 best = _mm_set1_ps(std::numeric_limits<float>::max());
+        __m128 bestIdx = _mm_setzero_ps();
+        for(int j = 0; j < n; ++j)
+        {
+            __m128 d = _mm_setzero_ps();
+            for(int k = 0; k < numChannels; ++k)
+            {
+                const __m128 diff = _mm_sub_ps(_mm_load_ps(c[k] + i),
+                    _mm_set1_ps(palette[j][k]));
+                d = _mm_add_ps(d, _mm_mul_ps(diff, diff));
+            }
+            const __m128 less = _mm_cmplt_ps(d, best);
+            best = _mm_min_ps(d, best);
+            bestIdx = _mm_or_ps(_mm_and_ps(less, _mm_set1_ps(j)), _mm_andnot_ps(
+                less, bestIdx));
+        }
+        alignas(16) float e[4];
+        alignas(16) std::int32_t k[4];
+        _mm_store_ps(e, best);
+        _mm_store_si128(reinterpret_cast<__m128i*>(k), _mm_cvtps_epi32(
+            bestIdx));
+        for(int j = 0; j < 4; ++j)
+        {
+            err += e[j];
+            idx[i + j] = k[j];
+        }
+    }
+#else
+    for(int i = 0; i < 16; ++i)
+    {
+        float best = std::numeric_limits<float>::max();
+        for(int j = 0; j < n; ++j)
+        {
+            float d = 0.f;
+            for(int k = 0; k < numChannels; ++k)
+            {
+                const float diff = c[k][i] - palette[j][k];
+                d += diff*diff;
+            }
+            if(d < best)
+            {
+                best = d;
+                idx[i] = j;
+            }
+        }
+        err += best;
+    }
+#endif
+    return err;
+}
+
+// Chooses endpoints spanning the block's colors, along the principal axis
+// unless speed is preferred.
+static void fit_endpoints(const Block& b, int numChannels, paz::
+    CompressionQuality quality, float* e0, float* e1)
+{
+    float lo[4];
+    float hi[4];
+    for(int c = 0; c < numChannels; ++c)
+    {
+        lo[c] = *std::min_element(b.c[c], b.c[c] + 16);
+        hi[c] = *std::max_element(b.c[c], b.c[c] + 16);
+    }
+    if(quality == paz::CompressionQuality::Fast)
+    {
+        for(int c = 0; c < numChannels; ++c)
+        {
+            const float inset = (hi[c] - lo[c])/16.f;
+            e0[c] = hi[c] - inset;
+            e1[c] = lo[c] + inset;
+        }
+        return;
+    }
+
+    float mean[4] = {};
+    for(int c = 0; c < numChannels; ++c)
+    {
+        for(int i = 0; i < 16; ++i)
+        {
+            mean[c] += b.c[c][i];
+        }
+        mean[c] /= 16.f;
+    }
+    float cov[4][4] = {};
+    for(int i = 0; i < 16; ++i)
+    {
+        for(int c = 0; c < numChannels; ++c)
+        {
+            for(int d = c; d < numChannels; ++d)
+            {
+                cov[c][d] += (b.c[c][i] - mean[c])*(b.c[d][i] - mean[d]);
+            }
+        }
+    }
+    for(int c = 0; c < numChannels; ++c)
+    {
+        for(int d = 0; d < c; ++d)
+        {
+            cov[c][d] = cov[d][c];
+        }
+    }
+
+    // Find the principal axis by power iteration.
+    float axis[4];
+    float norm = 0.f;
+    for(int c = 0; c < numChannels; ++c)
+    {
+        axis[c] = hi[c] - lo[c];
+        norm = std::max(norm, axis[c]);
+    }
+    if(!norm)
+    {
+        std::copy(mean, mean + numChannels, e0);
+        std::copy(mean, mean + numChannels, e1);
+        return;
+    }
+    for(int i = 0; i < 8; ++i)
+    {
+        float next[4] = {};
+        norm = 0.f;
+        for(int c = 0; c < numChannels; ++c)
+        {
+            for(int d = 0; d < numChannels; ++d)
+            {
+                next[c] += cov[c][d]*axis[d];
+            }
+            norm = std::max(norm, std::abs(next[c]));
+        }
+        if(!norm)
+        {
+            break;
+        }
+        for(int c = 0; c < numChannels; ++c)
+        {
+            axis[c] = next[c]/norm;
+        }
+    }
+    norm = 0.f;
+    for(int c = 0; c < numChannels; ++c)
+    {
+        norm += axis[c]*axis[c];
+    }
+    float tMin = std::numeric_limits<float>::max();
+    float tMax = std::numeric_limits<float>::lowest();
+    for(int i = 0; i < 16; ++i)
+    {
+        float t = 0.f;
+        for(int c = 0; c < numChannels; ++c)
+        {
+            t += (b.c[c][i] - mean[c])*axis[c];
+        }
+        tMin = std::min(tMin, t/norm);
+        tMax = std::max(tMax, t/norm);
+    }
+    for(int c = 0; c < numChannels; ++c)
+    {
+        e0[c] = std::clamp(mean[c] + tMax*axis[c], 0.f, 255.f);
+        e1[c] = std::clamp(mean[c] + tMin*axis[c], 0.f, 255.f);
+    }
+}
+
+// Solves for the endpoints that minimize the error of the given indices, where
+// entry `k` of the palette is `(1 - t[k])*e0 + t[k]*e1`.
+static bool refine_endpoints(const float (*c)[16], int numChannels, const std::
+    uint8_t* idx, const float* t, float* e0, float* e1)
+{
+    float a00 = 0.f;
+    float a01 = 0.f;
+    float a11 = 0.f;
+    float b0[4] = {};
+    float b1[4] = {};
+    for(int i = 0; i < 16; ++i)
+    {
+        const float w1 = t[idx[i]];
+        const float w0 = 1.f - w1;
+        a00 += w0*w0;
+        a01 += w0*w1;
+        a11 += w1*w1;
+        for(int k = 0; k < numChannels; ++k)
+        {
+            b0[k] += w0*c[k][i];
+            b1[k] += w1*c[k][i];
+        }
+    }
+    const float det = a00*a11 - a01*a01;
+    if(std::abs(det) < 1e-6f)
+    {
+        return false;
+    }
+    for(int k = 0; k < numChannels; ++k)
+    {
+        e0[k] = std::clamp((a11*b0[k] - a01*b1[k])/det, 0.f, 255.f);
+        e1[k] = std::clamp((a00*b1[k] - a01*b0[k])/det, 0.f, 255.f);
+    }
+    return true;
+}
+
+static std::uint16_t to_565(const float* e)
+{
+    const int r = std::lround(e[0]*31.f/255.f);
+    const int g = std::lround(e[1]*63.f/255.f);
+    const int b = std::lround(e[2]*31.f/255.f);
+    return r << 11 | g << 5 | b;
+}
+
+static void from_565(std::uint16_t c, float* e)
+{
+    const int r = c >> 11;
+    const int g = c >> 5 & 63;
+    const int b = c & 31;
+    e[0] = r << 3 | r >> 2;
+    e[1] = g << 2 | g >> 4;
+    e[2] = b << 3 | b >> 2;
+}
+
+static float quantize_bc1(const Block& b, const float* e0, const float* e1,
+    std::uint16_t& c0, std::uint16_t& c1, std::uint8_t* idx)
+{
+    c0 = to_565(e0);
+    c1 = to_565(e1);
+    if(c0 < c1)
+    {
+        std::swap(c0, c1);
+    }
+    Palette p;
+    from_565(c0, p[0]);
+    from_565(c1, p[1]);
+    for(int k = 0; k < 3; ++k)
+    {
+        p[2][k] = std::round((2.f*p[0][k] + p[1][k])/3.f);
+        p[3][k] = std::round((p[0][k] + 2.f*p[1][k])/3.f);
+    }
+
+    // Equal endpoints select three-color mode, where only index zero is safe.
+    return nearest_indices(b.c, 3, p, c0 == c1 ? 1 : 4, idx);
+}
+
+static void encode_bc1(const Block& b, paz::CompressionQuality quality,
+    unsigned char* out)
+{
+    float e0[4];
+    float e1[4];
+    fit_endpoints(b, 3, quality, e0, e1);
+    std::uint16_t c0, c1;
+    std::uint8_t idx[16] = {};
+    float err = quantize_bc1(b, e0, e1, c0, c1, idx);
+    if(quality == paz::CompressionQuality::High)
+    {
+        for(int i = 0; i < 2 && refine_endpoints(b.c, 3, idx, Bc1Weights.data(),
+            e0, e1); ++i)
+        {
+            std::uint16_t n0, n1;
+            std::uint8_t nIdx[16] = {};
+            const float nErr = quantize_bc1(b, e0, e1, n0, n1, nIdx);
+            if(nErr >= err)
+            {
+                break;
+            }
+            err = nErr;
+            c0 = n0;
+            c1 = n1;
+            std::copy(nIdx, nIdx + 16, idx);
+        }
+    }
+
+    out[0] = c0 & 0xff;
+    out[1] = c0 >> 8;
+    out[2] = c1 & 0xff;
+    out[3] = c1 >> 8;
+    for(int i = 0; i < 4; ++i)
+    {
+        out[4 + i] = idx[4*i] | idx[4*i + 1] << 2 | idx[4*i + 2] << 4 | idx[4*
+            i + 3] << 6;
+    }
+}
+
+// Evaluates a pair of endpoints exactly as a decoder would interpret them.
+static float quantize_bc4(const float (*c)[16], int r0, int r1, std::uint8_t*
+    idx)
+{
+    Palette p;
+    p[0][0] = r0;
+    p[1][0] = r1;
+    if(r0 > r1)
+    {
+        for(int k = 2; k < 8; ++k)
+        {
+            p[k][0] = std::round(((8 - k)*r0 + (k - 1)*r1)/7.f);
+        }
+    }
+    else
+    {
+        for(int k = 2; k < 6; ++k)
+        {
+            p[k][0] = std::round(((6 - k)*r0 + (k - 1)*r1)/5.f);
+        }
+        p[6][0] = 0.f;
+        p[7][0] = 255.f;
+    }
+    return nearest_indices(c, 1, p, 8, idx);
+}
+
+static void encode_bc4(const float (*c)[16], paz::CompressionQuality quality,
+    unsigned char* out)
+{
+    const float lo = *std::min_element(c[0], c[0] + 16);
+    const float hi = *std::max_element(c[0], c[0] + 16);
+    int r0 = hi;
+    int r1 = lo;
+    std::uint8_t idx[16] = {};
+    float err = quantize_bc4(c, r0, r1, idx);
+    if(quality == paz::CompressionQuality::High && r0 != r1)
+    {
+        const auto tryEndpoints = [&](int n0, int n1)
+        {
+            std::uint8_t nIdx[16] = {};
+            const float nErr = quantize_bc4(c, n0, n1, nIdx);
+            if(nErr < err)
+            {
+                err = nErr;
+                r0 = n0;
+                r1 = n1;
+                std::copy(nIdx, nIdx + 16, idx);
+            }
+        };
+
+        // Refine the eight-value interpolation.
+        std::array<float, 8> t = {0.f, 1.f};
+        for(int k = 2; k < 8; ++k)
+        {
+            t[k] = (k - 1)/7.f;
+        }
+        float e0 = r0;
+        float e1 = r1;
+        if(refine_endpoints(c, 1, idx, t.data(), &e0, &e1))
+        {
+            const int n0 = std::lround(e0);
+            const int n1 = std::lround(e1);
+            tryEndpoints(std::max(n0, n1), std::min(n0, n1));
+        }
+
+        // Try six-value interpolation with explicit extremes.
+        float inLo = 255.f;
+        float inHi = 0.f;
+        for(int i = 0; i < 16; ++i)
+        {
+            if(c[0][i] > 0.f && c[0][i] < 255.f)
+            {
+                inLo = std::min(inLo, c[0][i]);
+                inHi = std::max(inHi, c[0][i]);
+            }
+        }
+        if(inLo <= inHi)
+        {
+            tryEndpoints(inLo, inHi);
+        }
+    }
+
+    out[0] = r0;
+    out[1] = r1;
+    std::uint64_t bits = 0;
+    for(int i = 0; i < 16; ++i)
+    {
+        bits |= static_cast<std::uint64_t>(idx[i]) << 3*i;
+    }
+    for(int i = 0; i < 6; ++i)
+    {
+        out[2 + i] = bits >> 8*i & 0xff;
+    }
+}
+
+// Mode 6 stores one subset of RGBA endpoints with seven bits and a shared
+// low bit each, and four-bit indices.
+struct Bc7Endpoints
+{
+    int v0[4];
+    int v1[4];
+    int p0;
+    int p1;
+};
+
+static void quantize_bc7_endpoint(const float* e, int p, int* v)
+{
+    for(int k = 0; k < 4; ++k)
+    {
+        v[k] = std::clamp(static_cast<int>(std::lround((e[k] - p)/2.f)), 0,
+            127);
+    }
+}
+
+static float bc7_endpoint_error(const float* e, int p, const int* v)
+{
+    float err = 0.f;
+    for(int k = 0; k < 4; ++k)
+    {
+        const float diff = (v[k] << 1 | p) - e[k];
+        err += diff*diff;
+    }
+    return err;
+}
+
+static float evaluate_bc7(const Block& b, const Bc7Endpoints& ep, std::uint8_t*
+    idx)
+{
+    Palette p;
+    for(int k = 0; k < 4; ++k)
+    {
+        const int a = ep.v0[k] << 1 | ep.p0;
+        const int c = ep.v1[k] << 1 | ep.p1;
+        for(int j = 0; j < 16; ++j)
+        {
+            p[j][k] = ((64 - Bc7Weights[j])*a + Bc7Weights[j]*c + 32) >> 6;
+        }
+    }
+    return nearest_indices(b.c, 4, p, 16, idx);
+}
+
+// Picks low bits, trying every combination if quality is preferred.
+static float quantize_bc7(const Block& b, const float* e0, const float* e1,
+    paz::CompressionQuality quality, Bc7Endpoints& ep, std::uint8_t* idx)
+{
+    if(quality != paz::CompressionQuality::High)
+    {
+        int v[2][4];
+        float err[2];
+        for(int p = 0; p < 2; ++p)
+        {
+            quantize_bc7_endpoint(e0, p, v[p]);
+            err[p] = bc7_endpoint_error(e0, p, v[p]);
+        }
+        ep.p0 = err[1] < err[0];
+        std::copy(v[ep.p0], v[ep.p0] + 4, ep.v0);
+        for(int p = 0; p < 2; ++p)
+        {
+            quantize_bc7_endpoint(e1, p, v[p]);
+            err[p] = bc7_endpoint_error(e1, p, v[p]);
+        }
+        ep.p1 = err[1] < err[0];
+        std::copy(v[ep.p1], v[ep.p1] + 4, ep.v1);
+        return evaluate_bc7(b, ep, idx);
+    }
+
+    float best = std::numeric_limits<float>::max();
+    for(int i = 0; i < 4; ++i)
+    {
+        Bc7Endpoints n;
+        n.p0 = i & 1;
+        n.p1 = i >> 1;
+        quantize_bc7_endpoint(e0, n.p0, n.v0);
+        quantize_bc7_endpoint(e1, n.p1, n.v1);
+        std::uint8_t nIdx[16] = {};
+        const float err = evaluate_bc7(b, n, nIdx);
+        if(err < best)
+        {
+            best = err;
+            ep = n;
+            std::copy(nIdx, nIdx + 16, idx);
+        }
+    }
+    return best;
+}
+
+static void encode_bc7(const Block& b, paz::CompressionQuality quality,
+    unsigned char* out)
+{
+    float e0[4];
+    float e1[4];
+    fit_endpoints(b, 4, quality, e0, e1);
+    Bc7Endpoints ep;
+    std::uint8_t idx[16] = {};
+    float err = quantize_bc7(b, e0, e1, quality, ep, idx);
+    if(quality == paz::CompressionQuality::High)
+    {
+        std::array<float, 16> t;
+        for(int k = 0; k < 16; ++k)
+        {
+            t[k] = Bc7Weights[k]/64.f;
+        }
+        for(int i = 0; i < 2 && refine_endpoints(b.c, 4, idx, t.data(), e0, e1);
+            ++i)
+        {
+            Bc7Endpoints n;
+            std::uint8_t nIdx[16] = {};
+            const float nErr = quantize_bc7(b, e0, e1, quality, n, nIdx);
+            if(nErr >= err)
+            {
+                break;
+            }
+            err = nErr;
+            ep = n;
+            std::copy(nIdx, nIdx + 16, idx);
+        }
+    }
+
+    // The first index has an implicit high bit of zero.
+    if(idx[0] & 8)
+    {
+        std::swap(ep.v0, ep.v1);
+        std::swap(ep.p0, ep.p1);
+        for(int i = 0; i < 16; ++i)
+        {
+            idx[i] = 15 - idx[i];
+        }
+    }
+
+    std::uint64_t bits[2] = {};
+    int pos = 0;
+    const auto put = [&](unsigned int v, int n)
+    {
+        for(int i = 0; i < n; ++i, ++pos)
+        {
+            bits[pos/64] |= static_cast<std::uint64_t>(v >> i & 1) << pos%64;
+        }
+    };
+    put(1 << 6, 7);
+    for(int k = 0; k < 4; ++k)
+    {
+        put(ep.v0[k], 7);
+        put(ep.v1[k], 7);
+    }
+    put(ep.p0, 1);
+    put(ep.p1, 1);
+    put(idx[0], 3);
+    for(int i = 1; i < 16; ++i)
+    {
+        put(idx[i], 4);
+    }
+    for(int i = 0; i < 16; ++i)
+    {
+        out[i] = bits[i/8] >> 8*(i%8) & 0xff;
+    }
+}
+
+std::vector<unsigned char> paz::compress(const Image& image, TextureFormat
+    format, CompressionQuality quality)
+{
+    if(!is_compressed(format))
+    {
+        throw std::invalid_argument("Requested format is not block-compressed."
+            );
+    }
+    int numChannels;
+    switch(image.format())
+    {
+        case ImageFormat::R8UNorm: numChannels = 1; break;
+        case ImageFormat::RG8UNorm: numChannels = 2; break;
+        case ImageFormat::RGBA8UNorm: numChannels = 4; break;
+        default: throw std::invalid_argument("Image must be 8-bit normalized R"
+            ", RG, or RGBA.");
+    }
+    if(image.width()%4 || image.height()%4)
+    {
+        throw std::invalid_argument("Block-compressed textures must have dimen"
+            "sions that are multiples of four.");
+    }
+
+    const int blocksX = image.width()/4;
+    const int blocksY = image.height()/4;
+    std::vector<unsigned char> res(compressed_size(format, image.width(), image.
+        height()));
+    const std::size_t bytesPerBlock = res.size()/std::max(blocksX*blocksY, 1);
+    const auto encodeRows = [&](int begin, int end)
+    {
+        Block b;
+        for(int i = begin; i < end; ++i)
+        {
+            for(int j = 0; j < blocksX; ++j)
+            {
+                load_block(image, numChannels, j, i, b);
+                unsigned char* out = res.data() + bytesPerBlock*(static_cast<
+                    std::size_t>(i)*blocksX + j);
+                switch(format)
+                {
+                    case TextureFormat::BC1RGBAUNorm:
+                        encode_bc1(b, quality, out);
+                        break;
+                    case TextureFormat::BC3RGBAUNorm:
+                        encode_bc4(b.c + 3, quality, out);
+                        encode_bc1(b, quality, out + 8);
+                        break;
+                    case TextureFormat::BC4RUNorm:
+                        encode_bc4(b.c, quality, out);
+                        break;
+                    case TextureFormat::BC5RGUNorm:
+                        encode_bc4(b.c, quality, out);
+                        encode_bc4(b.c + 1, quality, out + 8);
+                        break;
+                    default:
+                        encode_bc7(b, quality, out);
+                        break;
+                }
+            }
+        }
+    };
+
+    // Split block rows evenly between threads.
+    const int numThreads = std::max(1, std::min({static_cast<int>(std::thread::
+        hardware_concurrency()), blocksX*blocksY/MinBlocksPerThread,
+        blocksY}));
+    std::vector<std::thread> threads;
+    for(int i = 1; i < numThreads; ++i)
+    {
+        threads.emplace_back(encodeRows, blocksY*i/numThreads, blocksY*(i + 1)/
+            numThreads);
+    }
+    encodeRows(0, blocksY/numThreads);
+    for(auto& n : threads)
+    {
+        n.join();
+    }
+
+    return res;
+}
+
+static unsigned int get_bits(const unsigned char* b, int offset, int n)
+{
+    unsigned int v = 0;
+    for(int i = 0; i < n; ++i)
+    {
+        v |= (b[(offset + i)/8] >> (offset + i)%8 & 1u) << i;
+    }
+    return v;
+}
+
+static void set_bits(unsigned char* b, int offset, int n, unsigned int v)
+{
+    for(int i = 0; i < n; ++i)
+    {
+        const int k = offset + i;
+        b[k/8] = (b[k/8] & ~(1u << k%8)) | (v >> i & 1u) << k%8;
+    }
+}
+
+// BC4 stores twelve bits of indices per row after its two endpoints.
+static void flip_bc4(unsigned char* b)
+{
+    std::array<unsigned int, 4> rows;
+    for(int i = 0; i < 4; ++i)
+    {
+        rows[i] = get_bits(b + 2, 12*i, 12);
+    }
+    for(int i = 0; i < 4; ++i)
+    {
+        set_bits(b + 2, 12*i, 12, rows[3 - i]);
+    }
+}
+
+// BC1 stores one byte of indices per row after its two endpoints.
+static void flip_bc1(unsigned char* b)
+{
+    std::swap(b[4], b[7]);
+    std::swap(b[5], b[6]);
+}
+
+namespace
+{
+    struct EndpointPair
+    {
+        int first;
+        int second;
+        int bits;
+    };
+}
+
+// The first index of each set omits its most significant bit, which must be
+// clear. If the flipped anchor's is set, the endpoints it selects between are
+// swapped and every index inverted, which decodes identically.
+static void flip_bc7_indices(unsigned char* b, int offset, int bits, const std::
+    vector<EndpointPair>& endpoints)
+{
+    std::array<unsigned int, 16> idx;
+    for(int i = 0, pos = offset; i < 16; pos += i ? bits : bits - 1, ++i)
+    {
+        idx[i] = get_bits(b, pos, i ? bits : bits - 1);
+    }
+    std::array<unsigned int, 16> flipped;
+    for(int i = 0; i < 16; ++i)
+    {
+        flipped[i] = idx[4*(3 - i/4) + i%4];
+    }
+    if(flipped[0] >> (bits - 1))
+    {
+        for(auto& n : flipped)
+        {
+            n = (1u << bits) - 1 - n;
+        }
+        for(const auto& n : endpoints)
+        {
+            const unsigned int e = get_bits(b, n.first, n.bits);
+            set_bits(b, n.first, n.bits, get_bits(b, n.second, n.bits));
+            set_bits(b, n.second, n.bits, e);
+        }
+    }
+    for(int i = 0, pos = offset; i < 16; pos += i ? bits : bits - 1, ++i)
+    {
+        set_bits(b, pos, i ? bits : bits - 1, flipped[i]);
+    }
+}
+
+// Partition shapes do not stay in the shape table when flipped, so only the
+// single-subset modes can be flipped losslessly.
+static void flip_bc7(unsigned char* b)
+{
+    int mode = 0;
+    while(mode < 8 && !(b[0] >> mode & 1))
+    {
+        ++mode;
+    }
+    switch(mode)
+    {
+        case 4:
+        {
+            const std::vector<EndpointPair> color = {{8, 13, 5}, {18, 23, 5},
+                {28, 33, 5}};
+            const std::vector<EndpointPair> alpha = {{38, 44, 6}};
+            const bool swapped = b[0] >> 7 & 1;
+            flip_bc7_indices(b, 50, 2, swapped ? alpha : color);
+            flip_bc7_indices(b, 81, 3, swapped ? color : alpha);
+            break;
+        }
+        case 5:
+            flip_bc7_indices(b, 66, 2, {{8, 15, 7}, {22, 29, 7}, {36, 43, 7}});
+            flip_bc7_indices(b, 97, 2, {{50, 58, 8}});
+            break;
+        case 6:
+            flip_bc7_indices(b, 65, 4, {{7, 14, 7}, {21, 28, 7}, {35, 42, 7},
+                {49, 56, 7}, {63, 64, 1}});
+            break;
+        case 8:
+            // Reserved blocks decode to zero either way.
+            break;
+        default:
+            throw std::invalid_argument("BC7 blocks must use mode 4, 5, or 6 to"
+                " be flipped.");
+    }
+}
+
+std::unique_ptr<unsigned char[]> paz::flip_blocks(TextureFormat format, const
+    void* data, int width, int height)
+{
+    const int blocksX = (width + 3)/4;
+    const int blocksY = (height + 3)/4;
+    const std::size_t size = compressed_size(format, width, height);
+    const std::size_t bytesPerBlock = size/std::max(blocksX*blocksY, 1);
+    const std::size_t bytesPerRow = bytesPerBlock*blocksX;
+
+    // Every byte is overwritten, so skip value-initialization.
+    std::unique_ptr<unsigned char[]> flipped(new unsigned char[size]);
+    for(int i = 0; i < blocksY; ++i)
+    {
+        std::memcpy(flipped.get() + bytesPerRow*i, static_cast<const unsigned
+            char*>(data) + bytesPerRow*(blocksY - i - 1), bytesPerRow);
+    }
+    for(std::size_t i = 0; i < size; i += bytesPerBlock)
+    {
+        unsigned char* b = flipped.get() + i;
+        switch(format)
+        {
+            case TextureFormat::BC1RGBAUNorm:
+                flip_bc1(b);
+                break;
+            case TextureFormat::BC3RGBAUNorm:
+                flip_bc4(b);
+                flip_bc1(b + 8);
+                break;
+            case TextureFormat::BC4RUNorm:
+                flip_bc4(b);
+                break;
+            case TextureFormat::BC5RGUNorm:
+                flip_bc4(b);
+                flip_bc4(b + 8);
+                break;
+            case TextureFormat::BC7RGBAUNorm:
+                flip_bc7(b);
+                break;
+            default:
+                throw std::logic_error("Format is not block-compressed.");
+        }
+    }
+    return flipped;
+}
@@ -19,5 +19,8 @@ static_assert(false, "Failed to detect an acceptable OS (no valid macros define"
 #if defined(PAZ_MACOS) || defined(PAZ_LINUX)
 #define PAZ_UNIX
 #endif
+#if defined(PAZ_HEADLESS) && !defined(PAZ_LINUX)
+static_assert(false, "Headless mode is only supported on Linux.");
+#endif
 
 #endif
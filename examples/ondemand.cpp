@@ -22,19 +22,11 @@ int main(int, char** argv)
         return 1;
     }
 
-    paz::VertexBuffer quadVertices;
-    quadVertices.addAttribute(2, std::array<float, 8>{1, -1, 1, 1, -1, -1, -1,
-        1});
-
     const paz::Texture font(paz::parse_pbm(paz::read_bytes(appDir + "/font.pbm"
         )));
 
-    const paz::VertexFunction fontVert(paz::read_bytes(appDir + "/font.vert").
-        str());
-    const paz::FragmentFunction fontFrag(paz::read_bytes(appDir + "/font.frag").
-        str());
-
-    paz::RenderPass textPass(fontVert, fontFrag);
+    paz::TextBatch text(font, "0123456789abcdefghijklmnopqrstuvwxyz:.|-/+@#",
+        5);
 
     double time = 0.;
     for(std::size_t k = 0; k < NumSteps; ++k)
@@ -47,34 +39,8 @@ int main(int, char** argv)
                 " " << std::setw(4) << k + 1 << "/" << NumSteps;
             str = ss.str();
         }
-        textPass.begin({paz::LoadAction::Clear});
-        textPass.uniform("baseSize", 2*font.height());
-        textPass.uniform("aspectRatio", paz::Window::AspectRatio());
-        textPass.read("font", font);
-        for(std::size_t i = 0; i < str.size(); ++i)
-        {
-            char c = -1;
-            if(str[i] >= '0' && str[i] <= '9')
-            {
-                c = str[i] - '0';
-            }
-            else if(str[i] == '.')
-            {
-                c = 37;
-            }
-            else if(str[i] == '/')
-            {
-                c = 40;
-            }
-            if(c >= 0)
-            {
-                textPass.uniform("row", 0);
-                textPass.uniform("col", static_cast<int>(i));
-                textPass.uniform("character", c);
-                textPass.draw(paz::PrimitiveType::TriangleStrip, quadVertices);
-            }
-        }
-        textPass.end();
+        text.add(str, 2);
+        text.draw(paz::LoadAction::Clear);
         paz::Window::EndFrame();
         time += paz::Window::FrameTime();
     }
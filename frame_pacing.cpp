@@ -0,0 +1,161 @@
+#include "PAZ_Graphics"
+#include "common.hpp"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Redraws may be requested from any thread, which does not know which context
+// to wake, so a request raises the flag of every context. Each context consumes
+// only its own flag.
+static std::mutex _requestMutex;
+static std::condition_variable _requestMade;
+static std::vector<bool*> _requestFlags;
+
+namespace
+{
+    struct RequestFlag
+    {
+        bool _requested = false;
+
+        RequestFlag()
+        {
+            std::lock_guard<std::mutex> lock(_requestMutex);
+            _requestFlags.push_back(&_requested);
+        }
+
+        ~RequestFlag()
+        {
+            std::lock_guard<std::mutex> lock(_requestMutex);
+            _requestFlags.erase(std::find(_requestFlags.begin(), _requestFlags.
+                end(), &_requested));
+        }
+    };
+}
+
+// Registers itself on a context's first use, so take a reference to it before
+// locking `_requestMutex`.
+static PAZ_CONTEXT_LOCAL RequestFlag _redrawRequested;
+
+static PAZ_CONTEXT_LOCAL bool _redrawNeeded = true;
+static PAZ_CONTEXT_LOCAL double _backgroundFps;
+static PAZ_CONTEXT_LOCAL double _fpsLimit;
+static PAZ_CONTEXT_LOCAL std::chrono::steady_clock::time_point _prevFrameEnd;
+
+static std::chrono::steady_clock::duration frame_interval(double fps)
+{
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::
+        chrono::duration<double>(1./fps));
+}
+
+// Sleeps in short steps while more time remains than a pessimistic estimate of
+// how long a step takes, then spins for the rest.
+static void sleep_until_precise(std::chrono::steady_clock::time_point target)
+{
+    static PAZ_CONTEXT_LOCAL double mean = 1e-3;
+    static PAZ_CONTEXT_LOCAL double variance = 0.;
+    while(true)
+    {
+        const auto before = std::chrono::steady_clock::now();
+        if(std::chrono::duration<double>(target - before).count() <= mean + 2.*
+            std::sqrt(variance))
+        {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        const double delta = std::chrono::duration<double>(std::chrono::
+            steady_clock::now() - before).count() - mean;
+        mean += 0.05*delta;
+        variance = 0.95*(variance + 0.05*delta*delta);
+    }
+    while(std::chrono::steady_clock::now() < target)
+    {
+        std::this_thread::yield();
+    }
+}
+
+void paz::mark_redraw()
+{
+    _redrawNeeded = true;
+}
+
+void paz::wait_for_redraw_request(double timeout)
+{
+    RequestFlag& flag = _redrawRequested;
+    std::unique_lock<std::mutex> lock(_requestMutex);
+    _requestMade.wait_for(lock, std::chrono::duration<double>(timeout), [&]()
+    {
+        return flag._requested;
+    });
+}
+
+void paz::pace_frame(bool background)
+{
+    _redrawNeeded = false;
+
+    // Background frames do not need precise timing, so they never spin.
+    if(background && _backgroundFps > 0. && !(_fpsLimit > 0. && _fpsLimit <
+        _backgroundFps))
+    {
+        std::this_thread::sleep_until(_prevFrameEnd + frame_interval(
+            _backgroundFps));
+    }
+    else if(_fpsLimit > 0.)
+    {
+        sleep_until_precise(_prevFrameEnd + frame_interval(_fpsLimit));
+    }
+    _prevFrameEnd = std::chrono::steady_clock::now();
+}
+
+// This does not call `initialize()` because it may be called from any thread.
+void paz::Window::RequestRedraw()
+{
+    {
+        std::lock_guard<std::mutex> lock(_requestMutex);
+        for(auto n : _requestFlags)
+        {
+            *n = true;
+        }
+    }
+    _requestMade.notify_all();
+    wake_event_loop();
+}
+
+bool paz::Window::NeedsRedraw()
+{
+    initialize();
+
+    RequestFlag& flag = _redrawRequested;
+    std::lock_guard<std::mutex> lock(_requestMutex);
+    if(flag._requested)
+    {
+        flag._requested = false;
+        _redrawNeeded = true;
+    }
+    return _redrawNeeded;
+}
+
+void paz::Window::SetBackgroundFrameRate(double fps)
+{
+    initialize();
+
+    if(!(fps >= 0.))
+    {
+        throw std::invalid_argument("Background frame rate must be nonnegative."
+            );
+    }
+    _backgroundFps = fps;
+}
+
+void paz::Window::SetFrameRateLimit(double fps)
+{
+    initialize();
+
+    if(!(fps >= 0.))
+    {
+        throw std::invalid_argument("Frame rate limit must be nonnegative.");
+    }
+    _fpsLimit = fps;
+}
@@ -0,0 +1,49 @@
+#include "PAZ_Graphics"
+#include "common.hpp"
+
+static paz::FrameStats& last_frame_stats()
+{
+    static PAZ_CONTEXT_LOCAL paz::FrameStats s;
+    return s;
+}
+
+paz::FrameStats& paz::frame_stats()
+{
+    static PAZ_CONTEXT_LOCAL FrameStats s;
+    return s;
+}
+
+void paz::end_frame_stats()
+{
+    last_frame_stats() = frame_stats();
+    frame_stats() = {};
+}
+
+void paz::count_draw(PrimitiveType type, std::size_t numVertices, std::size_t
+    numInstances)
+{
+    std::size_t n;
+    switch(type)
+    {
+        case PrimitiveType::Points: n = numVertices; break;
+        case PrimitiveType::Lines: n = numVertices/2; break;
+        case PrimitiveType::LineStrip: n = numVertices ? numVertices - 1 : 0;
+            break;
+        case PrimitiveType::Triangles: n = numVertices/3; break;
+        case PrimitiveType::TriangleStrip: n = numVertices > 2 ? numVertices -
+            2 : 0; break;
+        default: n = 0;
+    }
+    auto& s = frame_stats();
+    ++s.draws;
+    ++s.vertexArrayBinds;
+    s.instances += numInstances;
+    s.primitives += n*numInstances;
+}
+
+paz::FrameStats paz::Window::FrameStatistics()
+{
+    initialize();
+
+    return last_frame_stats();
+}
@@ -1,6 +1,7 @@
 #include "PAZ_Graphics"
 #include "common.hpp"
 #include "internal_data.hpp"
+#include <algorithm>
 
 int paz::Framebuffer::Data::width()
 {
@@ -28,6 +29,21 @@ int paz::Framebuffer::Data::height()
     return 0;
 }
 
+int paz::Framebuffer::Data::allocatedHeight()
+{
+    if(!_colorAttachments.empty())
+    {
+        return std::max(_colorAttachments[0]->_height, _colorAttachments[0]->
+            _allocHeight);
+    }
+    if(_depthStencilAttachment)
+    {
+        return std::max(_depthStencilAttachment->_height,
+            _depthStencilAttachment->_allocHeight);
+    }
+    return 0;
+}
+
 paz::Framebuffer::Framebuffer()
 {
     initialize();
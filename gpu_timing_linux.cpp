@@ -0,0 +1,146 @@
+#include "detect_os.hpp"
+
+#ifdef PAZ_LINUX
+
+#include "PAZ_Graphics"
+#include "common.hpp"
+#include "gl_core_4_1.h"
+#include <array>
+
+static constexpr std::size_t NumTimedFrames = 4;
+
+namespace
+{
+    struct TimedFrame
+    {
+        std::vector<std::string> names;
+        std::vector<GLuint> queries;
+        std::size_t numUsed = 0;
+        bool pending = false;
+
+        ~TimedFrame()
+        {
+            if(!queries.empty())
+            {
+                glDeleteQueries(queries.size(), queries.data());
+            }
+        }
+    };
+
+    struct GpuTiming
+    {
+        std::array<TimedFrame, NumTimedFrames> frames;
+        std::size_t cur = 0;
+        bool passTimed = false;
+        bool frameTimed = false;
+        std::vector<paz::GpuPassTime> latest;
+    };
+}
+
+static GpuTiming& timing()
+{
+    static PAZ_CONTEXT_LOCAL GpuTiming t;
+    return t;
+}
+
+void paz::begin_pass_timing(const std::string& name)
+{
+    if(!initialize().gpuTiming)
+    {
+        return;
+    }
+
+    // Frames are not timed while the ring is full of unread results.
+    auto& t = timing();
+    auto& f = t.frames[t.cur];
+    if(f.pending)
+    {
+        return;
+    }
+    if(f.queries.size() < f.numUsed + 2)
+    {
+        f.queries.resize(f.numUsed + 2);
+        glGenQueries(2, f.queries.data() + f.numUsed);
+    }
+    f.names.push_back(name);
+    glQueryCounter(f.queries[f.numUsed++], GL_TIMESTAMP);
+    t.passTimed = true;
+    t.frameTimed = true;
+}
+
+void paz::end_pass_timing()
+{
+    auto& t = timing();
+    if(t.passTimed)
+    {
+        auto& f = t.frames[t.cur];
+        glQueryCounter(f.queries[f.numUsed++], GL_TIMESTAMP);
+        t.passTimed = false;
+    }
+}
+
+void paz::resolve_gpu_timing()
+{
+    auto& t = timing();
+
+    // A frame skipped because its slot was still pending must not mark that
+    // slot again or advance past the oldest frame.
+    if(t.frameTimed)
+    {
+        t.frames[t.cur].pending = true;
+        t.cur = (t.cur + 1)%NumTimedFrames;
+        t.frameTimed = false;
+    }
+
+    // Timestamps complete in order, so the oldest frame is checked first and
+    // each frame is complete once its last query is.
+    for(std::size_t i = 0; i < NumTimedFrames; ++i)
+    {
+        auto& f = t.frames[(t.cur + i)%NumTimedFrames];
+        if(!f.pending)
+        {
+            continue;
+        }
+        GLuint available;
+        glGetQueryObjectuiv(f.queries[f.numUsed - 1], GL_QUERY_RESULT_AVAILABLE,
+            &available);
+        if(!available)
+        {
+            break;
+        }
+        std::vector<GLuint64> stamps(f.numUsed);
+        for(std::size_t j = 0; j < f.numUsed; ++j)
+        {
+            glGetQueryObjectui64v(f.queries[j], GL_QUERY_RESULT, &stamps[j]);
+        }
+        t.latest.resize(f.names.size());
+        for(std::size_t j = 0; j < f.names.size(); ++j)
+        {
+            t.latest[j].name = std::move(f.names[j]);
+            t.latest[j].start = 1e-9*(stamps[2*j] - stamps[0]);
+            t.latest[j].duration = 1e-9*(stamps[2*j + 1] - stamps[2*j]);
+        }
+        f.names.clear();
+        f.numUsed = 0;
+        f.pending = false;
+    }
+}
+
+void paz::Window::EnableGpuTiming()
+{
+    initialize().gpuTiming = true;
+}
+
+void paz::Window::DisableGpuTiming()
+{
+    initialize().gpuTiming = false;
+}
+
+std::vector<paz::GpuPassTime> paz::Window::GpuPassTimes()
+{
+    initialize();
+
+    return timing().latest;
+}
+
+#endif
@@ -0,0 +1,147 @@
+#include "detect_os.hpp"
+
+#ifdef PAZ_MACOS
+
+#include "PAZ_Graphics"
+#import "app_delegate.hh"
+#import "view_controller.hh"
+#include "common.hpp"
+#import <MetalKit/MetalKit.h>
+
+#define DEVICE [[static_cast<ViewController*>([[static_cast<AppDelegate*>( \
+    [NSApp delegate]) window] contentViewController]) mtkView] device]
+
+static constexpr NSUInteger MaxSamples = 256;
+
+static id _sampleBuffer = nil;
+static bool _unsupported = false;
+static NSUInteger _numSamples = 0;
+static std::vector<std::string> _names;
+static MTLTimestamp _cpuStart;
+static MTLTimestamp _gpuStart;
+static std::vector<paz::GpuPassTime> _latest;
+
+void paz::begin_pass_timing(const std::string& name, void* descriptor)
+{
+    if(!initialize().gpuTiming || _unsupported || _numSamples + 2 > MaxSamples)
+    {
+        return;
+    }
+
+    // Sampling at stage boundaries is the only option on Apple GPUs.
+    if(@available(macOS 11.0, *))
+    {
+        if(!_sampleBuffer)
+        {
+            if(![DEVICE supportsCounterSampling:
+                MTLCounterSamplingPointAtStageBoundary])
+            {
+                _unsupported = true;
+                return;
+            }
+            id<MTLCounterSet> timestamps = nil;
+            for(id<MTLCounterSet> n in [DEVICE counterSets])
+            {
+                if([[n name] isEqualToString:MTLCommonCounterSetTimestamp])
+                {
+                    timestamps = n;
+                }
+            }
+            if(!timestamps)
+            {
+                _unsupported = true;
+                return;
+            }
+            MTLCounterSampleBufferDescriptor* sampleDescriptor =
+                [[MTLCounterSampleBufferDescriptor alloc] init];
+            [sampleDescriptor setCounterSet:timestamps];
+            [sampleDescriptor setStorageMode:MTLStorageModeShared];
+            [sampleDescriptor setSampleCount:MaxSamples];
+            NSError* error = nil;
+            _sampleBuffer = [DEVICE newCounterSampleBufferWithDescriptor:
+                sampleDescriptor error:&error];
+            [sampleDescriptor release];
+            if(!_sampleBuffer)
+            {
+                throw std::runtime_error("Failed to create counter sample buff"
+                    "er: " + std::string([[error localizedDescription]
+                    UTF8String]));
+            }
+        }
+        if(!_numSamples)
+        {
+            [DEVICE sampleTimestamps:&_cpuStart gpuTimestamp:&_gpuStart];
+        }
+        MTLRenderPassSampleBufferAttachmentDescriptor* attachment =
+            [[static_cast<MTLRenderPassDescriptor*>(descriptor)
+            sampleBufferAttachments] objectAtIndexedSubscript:0];
+        [attachment setSampleBuffer:static_cast<id<MTLCounterSampleBuffer>>(
+            _sampleBuffer)];
+        [attachment setStartOfVertexSampleIndex:_numSamples];
+        [attachment setEndOfVertexSampleIndex:MTLCounterDontSample];
+        [attachment setStartOfFragmentSampleIndex:MTLCounterDontSample];
+        [attachment setEndOfFragmentSampleIndex:_numSamples + 1];
+        _numSamples += 2;
+        _names.push_back(name);
+    }
+    else
+    {
+        _unsupported = true;
+    }
+}
+
+void paz::resolve_gpu_timing()
+{
+    if(!_numSamples)
+    {
+        return;
+    }
+
+    // Frames are committed and waited on by `EndFrame()`, so the samples are
+    // already complete.
+    if(@available(macOS 11.0, *))
+    {
+        MTLTimestamp cpuEnd;
+        MTLTimestamp gpuEnd;
+        [DEVICE sampleTimestamps:&cpuEnd gpuTimestamp:&gpuEnd];
+        const double nsPerTick = gpuEnd > _gpuStart ? static_cast<double>(
+            cpuEnd - _cpuStart)/(gpuEnd - _gpuStart) : 1.;
+        NSData* data = [static_cast<id<MTLCounterSampleBuffer>>(_sampleBuffer)
+            resolveCounterRange:NSMakeRange(0, _numSamples)];
+        if(data)
+        {
+            const auto* stamps = static_cast<const MTLCounterResultTimestamp*>(
+                [data bytes]);
+            _latest.resize(_names.size());
+            for(std::size_t i = 0; i < _names.size(); ++i)
+            {
+                _latest[i].name = std::move(_names[i]);
+                _latest[i].start = 1e-9*nsPerTick*(stamps[2*i].timestamp -
+                    stamps[0].timestamp);
+                _latest[i].duration = 1e-9*nsPerTick*(stamps[2*i + 1].
+                    timestamp - stamps[2*i].timestamp);
+            }
+        }
+    }
+    _names.clear();
+    _numSamples = 0;
+}
+
+void paz::Window::EnableGpuTiming()
+{
+    initialize().gpuTiming = true;
+}
+
+void paz::Window::DisableGpuTiming()
+{
+    initialize().gpuTiming = false;
+}
+
+std::vector<paz::GpuPassTime> paz::Window::GpuPassTimes()
+{
+    initialize();
+
+    return _latest;
+}
+
+#endif
@@ -0,0 +1,179 @@
+#include "detect_os.hpp"
+
+#ifdef PAZ_WINDOWS
+
+#include "PAZ_Graphics"
+#include "util_windows.hpp"
+#include "common.hpp"
+#include <array>
+
+static constexpr std::size_t NumTimedFrames = 4;
+
+namespace
+{
+    struct TimedFrame
+    {
+        std::vector<std::string> names;
+        ID3D11Query* disjoint = nullptr;
+        std::vector<ID3D11Query*> queries;
+        std::size_t numUsed = 0;
+        bool pending = false;
+
+        ~TimedFrame()
+        {
+            if(disjoint)
+            {
+                disjoint->Release();
+            }
+            for(auto n : queries)
+            {
+                n->Release();
+            }
+        }
+    };
+
+    struct GpuTiming
+    {
+        std::array<TimedFrame, NumTimedFrames> frames;
+        std::size_t cur = 0;
+        bool passTimed = false;
+        bool frameTimed = false;
+        std::vector<paz::GpuPassTime> latest;
+    };
+}
+
+static GpuTiming& timing()
+{
+    static PAZ_CONTEXT_LOCAL GpuTiming t;
+    return t;
+}
+
+static ID3D11Query* create_query(D3D11_QUERY type)
+{
+    D3D11_QUERY_DESC descriptor = {};
+    descriptor.Query = type;
+    ID3D11Query* query;
+    const auto hr = paz::d3d_device()->CreateQuery(&descriptor, &query);
+    if(hr)
+    {
+        throw std::runtime_error("Failed to create query (" + paz::
+            format_hresult(hr) + ").");
+    }
+    return query;
+}
+
+void paz::begin_pass_timing(const std::string& name)
+{
+    if(!initialize().gpuTiming)
+    {
+        return;
+    }
+
+    // Frames are not timed while the ring is full of unread results.
+    auto& t = timing();
+    auto& f = t.frames[t.cur];
+    if(f.pending)
+    {
+        return;
+    }
+    if(!f.disjoint)
+    {
+        f.disjoint = create_query(D3D11_QUERY_TIMESTAMP_DISJOINT);
+    }
+    while(f.queries.size() < f.numUsed + 2)
+    {
+        f.queries.push_back(create_query(D3D11_QUERY_TIMESTAMP));
+    }
+    if(!f.numUsed)
+    {
+        d3d_context()->Begin(f.disjoint);
+    }
+    f.names.push_back(name);
+    d3d_context()->End(f.queries[f.numUsed++]);
+    t.passTimed = true;
+    t.frameTimed = true;
+}
+
+void paz::end_pass_timing()
+{
+    auto& t = timing();
+    if(t.passTimed)
+    {
+        auto& f = t.frames[t.cur];
+        d3d_context()->End(f.queries[f.numUsed++]);
+        t.passTimed = false;
+    }
+}
+
+void paz::resolve_gpu_timing()
+{
+    auto& t = timing();
+
+    // A frame skipped because its slot was still pending must not mark that
+    // slot again or advance past the oldest frame.
+    if(t.frameTimed)
+    {
+        d3d_context()->End(t.frames[t.cur].disjoint);
+        t.frames[t.cur].pending = true;
+        t.cur = (t.cur + 1)%NumTimedFrames;
+        t.frameTimed = false;
+    }
+
+    // Frames complete in order, so the oldest is checked first.
+    for(std::size_t i = 0; i < NumTimedFrames; ++i)
+    {
+        auto& f = t.frames[(t.cur + i)%NumTimedFrames];
+        if(!f.pending)
+        {
+            continue;
+        }
+        D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+        if(d3d_context()->GetData(f.disjoint, &disjoint, sizeof(disjoint), 0)
+            != S_OK)
+        {
+            break;
+        }
+        std::vector<UINT64> stamps(f.numUsed);
+        bool valid = !disjoint.Disjoint;
+        for(std::size_t j = 0; j < f.numUsed && valid; ++j)
+        {
+            valid = d3d_context()->GetData(f.queries[j], &stamps[j], sizeof(
+                UINT64), 0) == S_OK;
+        }
+
+        // Timings from a frame whose clock changed frequency are discarded.
+        if(valid)
+        {
+            const double period = 1./disjoint.Frequency;
+            t.latest.resize(f.names.size());
+            for(std::size_t j = 0; j < f.names.size(); ++j)
+            {
+                t.latest[j].name = std::move(f.names[j]);
+                t.latest[j].start = period*(stamps[2*j] - stamps[0]);
+                t.latest[j].duration = period*(stamps[2*j + 1] - stamps[2*j]);
+            }
+        }
+        f.names.clear();
+        f.numUsed = 0;
+        f.pending = false;
+    }
+}
+
+void paz::Window::EnableGpuTiming()
+{
+    initialize().gpuTiming = true;
+}
+
+void paz::Window::DisableGpuTiming()
+{
+    initialize().gpuTiming = false;
+}
+
+std::vector<paz::GpuPassTime> paz::Window::GpuPassTimes()
+{
+    initialize();
+
+    return timing().latest;
+}
+
+#endif
@@ -34,11 +34,14 @@ paz::IndexBuffer::IndexBuffer(const unsigned int* data, std::size_t size)
 {
     initialize();
 
+    PAZ_PROFILE("IndexBuffer::IndexBuffer");
+
     _data = std::make_shared<Data>();
 
     _data->_numIndices = size;
     glGenBuffers(1, &_data->_id);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _data->_id);
+    frame_stats().bytesUploaded += sizeof(GLuint)*size;
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*size, data,
         GL_STATIC_DRAW);
 }
@@ -50,6 +53,7 @@ void paz::IndexBuffer::sub(const unsigned int* data, std::size_t size)
         throw std::runtime_error("Number of instances is fixed.");
     }
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _data->_id);
+    frame_stats().bytesUploaded += sizeof(GLuint)*size;
     glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, sizeof(GLuint)*size, data);
 }
 
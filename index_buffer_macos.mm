@@ -46,11 +46,14 @@ paz::IndexBuffer::IndexBuffer(const unsigned int* data, std::size_t size)
 {
     initialize();
 
+    PAZ_PROFILE("IndexBuffer::IndexBuffer");
+
     _data = std::make_shared<Data>();
 
     _data->_numIndices = size;
     if(size)
     {
+        frame_stats().bytesUploaded += sizeof(*data)*size;
         _data->_data = [DEVICE newBufferWithBytes:data length:sizeof(unsigned
         int)*size options:MTLStorageModeShared];
     }
@@ -64,6 +67,7 @@ void paz::IndexBuffer::sub(const unsigned int* data, std::size_t size)
     }
     std::copy(data, data + size, reinterpret_cast<unsigned int*>([static_cast<
         id<MTLBuffer>>(_data->_data) contents]));
+    frame_stats().bytesUploaded += sizeof(*data)*size;
 }
 
 bool paz::IndexBuffer::empty() const
@@ -47,6 +47,8 @@ paz::IndexBuffer::IndexBuffer(const unsigned int* data, std::size_t size)
 {
     initialize();
 
+    PAZ_PROFILE("IndexBuffer::IndexBuffer");
+
     _data = std::make_shared<Data>();
 
     _data->_numIndices = size;
@@ -58,6 +60,7 @@ paz::IndexBuffer::IndexBuffer(const unsigned int* data, std::size_t size)
         bufDescriptor.BindFlags = D3D11_BIND_INDEX_BUFFER;
         D3D11_SUBRESOURCE_DATA srData = {};
         srData.pSysMem = data;
+        frame_stats().bytesUploaded += bufDescriptor.ByteWidth;
         const auto hr = d3d_device()->CreateBuffer(&bufDescriptor, &srData,
             &_data->_buffer);
         if(hr)
@@ -81,6 +84,7 @@ void paz::IndexBuffer::sub(const unsigned int* data, std::size_t size)
     std::copy(data, data + size, reinterpret_cast<unsigned int*>(mappedSr.
         pData));
     d3d_context()->Unmap(_data->_buffer, 0);
+    frame_stats().bytesUploaded += sizeof(*data)*size;
 }
 
 bool paz::IndexBuffer::empty() const
@@ -0,0 +1,106 @@
+#include "PAZ_Graphics"
+#include "common.hpp"
+#include "internal_data.hpp"
+#include <cstring>
+
+void paz::InstanceBuffer::Data::gather(std::size_t idx, const void* data, const
+    std::vector<unsigned int>& indices)
+{
+    PAZ_PROFILE("InstanceBuffer::gatherAttribute");
+    const std::size_t s = stride(idx);
+    if(indices.size() > _numInstances)
+    {
+        throw std::logic_error("More instances gathered than the buffer holds."
+            );
+    }
+    for(auto n : indices)
+    {
+        if(n >= _numInstances)
+        {
+            throw std::logic_error("Instance index " + std::to_string(n) +
+                " is out of range.");
+        }
+    }
+    _numGathered = indices.size();
+    _gathered = true;
+    if(indices.empty())
+    {
+        return;
+    }
+
+    auto* dst = static_cast<unsigned char*>(map(idx, s*indices.size()));
+    const auto* src = static_cast<const unsigned char*>(data);
+    for(std::size_t i = 0; i < indices.size(); ++i)
+    {
+        std::memcpy(dst + s*i, src + s*indices[i], s);
+    }
+    unmap(idx);
+    frame_stats().bytesUploaded += s*indices.size();
+}
+
+void paz::InstanceBuffer::Data::stream(std::size_t idx, const void* data, std::
+    size_t numBytes)
+{
+    PAZ_PROFILE("InstanceBuffer::streamAttribute");
+    const std::size_t s = stride(idx);
+    if(numBytes%s)
+    {
+        throw std::logic_error("Streamed data must hold whole instances.");
+    }
+    if(numBytes/s > _numInstances)
+    {
+        throw std::logic_error("More instances streamed than the buffer holds."
+            );
+    }
+    _numGathered = numBytes/s;
+    _gathered = true;
+    if(!numBytes)
+    {
+        return;
+    }
+
+    std::memcpy(map(idx, numBytes), data, numBytes);
+    unmap(idx);
+    frame_stats().bytesUploaded += numBytes;
+}
+
+std::size_t paz::InstanceBuffer::Data::numDrawn() const
+{
+    return _gathered ? _numGathered : _numInstances;
+}
+
+void paz::InstanceBuffer::gatherAttribute(std::size_t idx, const float* data,
+    const std::vector<unsigned int>& indices)
+{
+    _data->gather(idx, data, indices);
+}
+
+void paz::InstanceBuffer::gatherAttribute(std::size_t idx, const unsigned int*
+    data, const std::vector<unsigned int>& indices)
+{
+    _data->gather(idx, data, indices);
+}
+
+void paz::InstanceBuffer::gatherAttribute(std::size_t idx, const int* data,
+    const std::vector<unsigned int>& indices)
+{
+    _data->gather(idx, data, indices);
+}
+
+void paz::InstanceBuffer::streamAttribute(std::size_t idx, const float* data,
+    std::size_t size)
+{
+    _data->stream(idx, data, sizeof(float)*size);
+}
+
+void paz::InstanceBuffer::streamAttribute(std::size_t idx, const unsigned int*
+    data, std::size_t size)
+{
+    _data->stream(idx, data, sizeof(unsigned int)*size);
+}
+
+void paz::InstanceBuffer::streamAttribute(std::size_t idx, const int* data, std::
+    size_t size)
+{
+    _data->stream(idx, data, sizeof(int)*size);
+}
@@ -47,6 +47,9 @@ void paz::InstanceBuffer::Data::checkSize(int dim, std::size_t size)
         throw std::runtime_error("Number of instances for each attribute must m"
             "atch.");
     }
+
+    // A full upload covers every instance again.
+    _gathered = false;
 }
 
 void paz::InstanceBuffer::Data::addAttribute(int dim, DataType type)
@@ -123,24 +126,30 @@ void paz::InstanceBuffer::addAttribute(int dim, DataType type)
 void paz::InstanceBuffer::addAttribute(int dim, const GLfloat* data, std::size_t
     size)
 {
+    PAZ_PROFILE("InstanceBuffer::addAttribute");
     _data->checkSize(dim, size);
     _data->addAttribute(dim, DataType::Float);
+    frame_stats().bytesUploaded += sizeof(GLfloat)*size;
     glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*size, data, GL_STATIC_DRAW);
 }
 
 void paz::InstanceBuffer::addAttribute(int dim, const GLuint* data, std::size_t
     size)
 {
+    PAZ_PROFILE("InstanceBuffer::addAttribute");
     _data->checkSize(dim, size);
     _data->addAttribute(dim, DataType::UInt);
+    frame_stats().bytesUploaded += sizeof(GLuint)*size;
     glBufferData(GL_ARRAY_BUFFER, sizeof(GLuint)*size, data, GL_STATIC_DRAW);
 }
 
 void paz::InstanceBuffer::addAttribute(int dim, const GLint* data, std::size_t
     size)
 {
+    PAZ_PROFILE("InstanceBuffer::addAttribute");
     _data->checkSize(dim, size);
     _data->addAttribute(dim, DataType::SInt);
+    frame_stats().bytesUploaded += sizeof(GLint)*size;
     glBufferData(GL_ARRAY_BUFFER, sizeof(GLint)*size, data, GL_STATIC_DRAW);
 }
 
@@ -159,6 +168,7 @@ void paz::InstanceBuffer::subAttribute(std::size_t idx, const GLfloat* data,
     }
     _data->checkSize(_data->_dims[idx], size);
     glBindBuffer(GL_ARRAY_BUFFER, _data->_ids[idx]);
+    frame_stats().bytesUploaded += sizeof(GLfloat)*size;
     glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(GLfloat)*size, data);
 }
 
@@ -177,6 +187,7 @@ void paz::InstanceBuffer::subAttribute(std::size_t idx, const GLuint* data,
     }
     _data->checkSize(_data->_dims[idx], size);
     glBindBuffer(GL_ARRAY_BUFFER, _data->_ids[idx]);
+    frame_stats().bytesUploaded += sizeof(GLuint)*size;
     glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(GLuint)*size, data);
 }
 
@@ -195,9 +206,39 @@ void paz::InstanceBuffer::subAttribute(std::size_t idx, const GLint* data, std::
     }
     _data->checkSize(_data->_dims[idx], size);
     glBindBuffer(GL_ARRAY_BUFFER, _data->_ids[idx]);
+    frame_stats().bytesUploaded += sizeof(GLint)*size;
     glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(GLint)*size, data);
 }
 
+std::size_t paz::InstanceBuffer::Data::stride(std::size_t idx) const
+{
+    if(idx >= _ids.size())
+    {
+        throw std::logic_error("Attribute index " + std::to_string(idx) +
+            " is out of range.");
+    }
+    return sizeof(GLfloat)*_dims[idx];
+}
+
+void* paz::InstanceBuffer::Data::map(std::size_t idx, std::size_t size)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, _ids[idx]);
+    void* ptr = glMapBufferRange(GL_ARRAY_BUFFER, 0, size, GL_MAP_WRITE_BIT|
+        GL_MAP_INVALIDATE_BUFFER_BIT);
+    if(!ptr)
+    {
+        throw std::runtime_error("Failed to map instance buffer: " + gl_error(
+            glGetError()) + ".");
+    }
+    return ptr;
+}
+
+void paz::InstanceBuffer::Data::unmap(std::size_t idx)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, _ids[idx]);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+}
+
 bool paz::InstanceBuffer::empty() const
 {
     return !_data || !_data->_numInstances;
@@ -44,6 +44,9 @@ void paz::InstanceBuffer::Data::checkSize(int dim, std::size_t size)
         throw std::runtime_error("Number of instances for each attribute must m"
             "atch.");
     }
+
+    // A full upload covers every instance again.
+    _gathered = false;
 }
 
 paz::InstanceBuffer::InstanceBuffer()
@@ -80,10 +83,12 @@ void paz::InstanceBuffer::addAttribute(int dim, DataType type)
 void paz::InstanceBuffer::addAttribute(int dim, const float* data, std::size_t
     size)
 {
+    PAZ_PROFILE("InstanceBuffer::addAttribute");
     _data->_dims.push_back(dim);
     _data->checkSize(dim, size);
     if(size)
     {
+        frame_stats().bytesUploaded += sizeof(*data)*size;
         _data->_buffers.push_back([DEVICE newBufferWithBytes:data length:sizeof(
             float)*size options:MTLStorageModeShared]);
     }
@@ -92,10 +97,12 @@ void paz::InstanceBuffer::addAttribute(int dim, const float* data, std::size_t
 void paz::InstanceBuffer::addAttribute(int dim, const unsigned int* data, std::
     size_t size)
 {
+    PAZ_PROFILE("InstanceBuffer::addAttribute");
     _data->_dims.push_back(dim);
     _data->checkSize(dim, size);
     if(size)
     {
+        frame_stats().bytesUploaded += sizeof(*data)*size;
         _data->_buffers.push_back([DEVICE newBufferWithBytes:data length:sizeof(
             unsigned int)*size options:MTLStorageModeShared]);
     }
@@ -104,10 +111,12 @@ void paz::InstanceBuffer::addAttribute(int dim, const unsigned int* data, std::
 void paz::InstanceBuffer::addAttribute(int dim, const int* data, std::size_t
     size)
 {
+    PAZ_PROFILE("InstanceBuffer::addAttribute");
     _data->_dims.push_back(dim);
     _data->checkSize(dim, size);
     if(size)
     {
+        frame_stats().bytesUploaded += sizeof(*data)*size;
         _data->_buffers.push_back([DEVICE newBufferWithBytes:data length:sizeof(
             int)*size options:MTLStorageModeShared]);
     }
@@ -124,6 +133,7 @@ void paz::InstanceBuffer::subAttribute(std::size_t idx, const float* data, std::
     _data->checkSize(_data->_dims[idx], size);
     std::copy(data, data + size, reinterpret_cast<float*>([static_cast<id<
         MTLBuffer>>(_data->_buffers[idx]) contents]));
+    frame_stats().bytesUploaded += sizeof(*data)*size;
 }
 
 void paz::InstanceBuffer::subAttribute(std::size_t idx, const unsigned int*
@@ -137,6 +147,7 @@ void paz::InstanceBuffer::subAttribute(std::size_t idx, const unsigned int*
     _data->checkSize(_data->_dims[idx], size);
     std::copy(data, data + size, reinterpret_cast<unsigned int*>([static_cast<
         id<MTLBuffer>>(_data->_buffers[idx]) contents]));
+    frame_stats().bytesUploaded += sizeof(*data)*size;
 }
 
 void paz::InstanceBuffer::subAttribute(std::size_t idx, const int* data, std::
@@ -150,8 +161,26 @@ void paz::InstanceBuffer::subAttribute(std::size_t idx, const int* data, std::
     _data->checkSize(_data->_dims[idx], size);
     std::copy(data, data + size, reinterpret_cast<int*>([static_cast<id<
         MTLBuffer>>(_data->_buffers[idx]) contents]));
+    frame_stats().bytesUploaded += sizeof(*data)*size;
+}
+
+std::size_t paz::InstanceBuffer::Data::stride(std::size_t idx) const
+{
+    if(idx >= _buffers.size())
+    {
+        throw std::logic_error("Attribute index " + std::to_string(idx) +
+            " is out of range.");
+    }
+    return sizeof(float)*_dims[idx];
+}
+
+void* paz::InstanceBuffer::Data::map(std::size_t idx, std::size_t)
+{
+    return [static_cast<id<MTLBuffer>>(_buffers[idx]) contents];
 }
 
+void paz::InstanceBuffer::Data::unmap(std::size_t) {}
+
 bool paz::InstanceBuffer::empty() const
 {
     return !_data || !_data->_numInstances;
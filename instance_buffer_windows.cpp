@@ -34,6 +34,7 @@ void paz::InstanceBuffer::Data::addAttribute(int dim, DataType type, const void*
         bufDescriptor.BindFlags = D3D11_BIND_VERTEX_BUFFER;
         D3D11_SUBRESOURCE_DATA srData = {};
         srData.pSysMem = data;
+        frame_stats().bytesUploaded += bufDescriptor.ByteWidth;
         const auto hr = d3d_device()->CreateBuffer(&bufDescriptor, &srData,
             &_buffers.back());
         if(hr)
@@ -83,6 +84,9 @@ void paz::InstanceBuffer::Data::checkSize(int dim, std::size_t size)
         throw std::runtime_error("Number of instances for each attribute must m"
             "atch.");
     }
+
+    // A full upload covers every instance again.
+    _gathered = false;
 }
 
 void paz::InstanceBuffer::addAttribute(int dim, DataType type)
@@ -120,24 +124,33 @@ void paz::InstanceBuffer::addAttribute(int dim, DataType type)
 void paz::InstanceBuffer::addAttribute(int dim, const float* data, std::size_t
     size)
 {
+    PAZ_PROFILE("InstanceBuffer::addAttribute");
     _data->addAttribute(dim, DataType::Float, data, size);
 }
 
 void paz::InstanceBuffer::addAttribute(int dim, const unsigned int* data, std::
     size_t size)
 {
+    PAZ_PROFILE("InstanceBuffer::addAttribute");
     _data->addAttribute(dim, DataType::UInt, data, size);
 }
 
 void paz::InstanceBuffer::addAttribute(int dim, const int* data, std::size_t
     size)
 {
+    PAZ_PROFILE("InstanceBuffer::addAttribute");
     _data->addAttribute(dim, DataType::SInt, data, size);
 }
 
 void paz::InstanceBuffer::subAttribute(std::size_t idx, const float* data, std::
     size_t size)
 {
+    if(idx >= _data->_buffers.size())
+    {
+        throw std::logic_error("Attribute index " + std::to_string(idx) +
+            " is out of range.");
+    }
+    _data->checkSize(_data->_strides[idx]/TypeSize, size);
     D3D11_MAPPED_SUBRESOURCE mappedSr;
     const auto hr = d3d_context()->Map(_data->_buffers[idx], 0,
         D3D11_MAP_WRITE_DISCARD, 0, &mappedSr);
@@ -148,11 +161,18 @@ void paz::InstanceBuffer::subAttribute(std::size_t idx, const float* data, std::
     }
     std::copy(data, data + size, reinterpret_cast<float*>(mappedSr.pData));
     d3d_context()->Unmap(_data->_buffers[idx], 0);
+    frame_stats().bytesUploaded += sizeof(*data)*size;
 }
 
 void paz::InstanceBuffer::subAttribute(std::size_t idx, const unsigned int*
     data, std::size_t size)
 {
+    if(idx >= _data->_buffers.size())
+    {
+        throw std::logic_error("Attribute index " + std::to_string(idx) +
+            " is out of range.");
+    }
+    _data->checkSize(_data->_strides[idx]/TypeSize, size);
     D3D11_MAPPED_SUBRESOURCE mappedSr;
     const auto hr = d3d_context()->Map(_data->_buffers[idx], 0,
         D3D11_MAP_WRITE_DISCARD, 0, &mappedSr);
@@ -164,11 +184,18 @@ void paz::InstanceBuffer::subAttribute(std::size_t idx, const unsigned int*
     std::copy(data, data + size, reinterpret_cast<unsigned int*>(mappedSr.
         pData));
     d3d_context()->Unmap(_data->_buffers[idx], 0);
+    frame_stats().bytesUploaded += sizeof(*data)*size;
 }
 
 void paz::InstanceBuffer::subAttribute(std::size_t idx, const int* data, std::
     size_t size)
 {
+    if(idx >= _data->_buffers.size())
+    {
+        throw std::logic_error("Attribute index " + std::to_string(idx) +
+            " is out of range.");
+    }
+    _data->checkSize(_data->_strides[idx]/TypeSize, size);
     D3D11_MAPPED_SUBRESOURCE mappedSr;
     const auto hr = d3d_context()->Map(_data->_buffers[idx], 0,
         D3D11_MAP_WRITE_DISCARD, 0, &mappedSr);
@@ -179,6 +206,35 @@ void paz::InstanceBuffer::subAttribute(std::size_t idx, const int* data, std::
     }
     std::copy(data, data + size, reinterpret_cast<int*>(mappedSr.pData));
     d3d_context()->Unmap(_data->_buffers[idx], 0);
+    frame_stats().bytesUploaded += sizeof(*data)*size;
+}
+
+std::size_t paz::InstanceBuffer::Data::stride(std::size_t idx) const
+{
+    if(idx >= _buffers.size())
+    {
+        throw std::logic_error("Attribute index " + std::to_string(idx) +
+            " is out of range.");
+    }
+    return _strides[idx];
+}
+
+void* paz::InstanceBuffer::Data::map(std::size_t idx, std::size_t)
+{
+    D3D11_MAPPED_SUBRESOURCE mappedSr;
+    const auto hr = d3d_context()->Map(_buffers[idx], 0,
+        D3D11_MAP_WRITE_DISCARD, 0, &mappedSr);
+    if(hr)
+    {
+        throw std::runtime_error("Failed to map instance buffer (" +
+            format_hresult(hr) + ").");
+    }
+    return mappedSr.pData;
+}
+
+void paz::InstanceBuffer::Data::unmap(std::size_t idx)
+{
+    d3d_context()->Unmap(_buffers[idx], 0);
 }
 
 bool paz::InstanceBuffer::empty() const
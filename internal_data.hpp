@@ -3,11 +3,17 @@
 
 #include "detect_os.hpp"
 #include "PAZ_Graphics"
+#include "common.hpp"
 #ifdef PAZ_LINUX
 #include "shader_linux.hpp"
 #elif defined(PAZ_WINDOWS)
 #include "windows.hpp"
 #endif
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -35,10 +41,69 @@ struct paz::Texture::Data
     WrapMode _wrapT;
     bool _isRenderTarget = false;
     double _scale = 1.;
+    int _maxMipLevel = -1;
+    bool _mipmapsDirty = false;
+    int _allocWidth = 0;
+    int _allocHeight = 0;
+    bool _exactSize = false;
+    TextureCounter _counter;
     ~Data();
     void init(const void* data = nullptr);
     void ensureMipmaps();
     void resize(int width, int height);
+    bool updateSize(int width, int height);
+    void setMaxMipLevel(int level);
+#ifdef PAZ_LINUX
+    void queueRead(ReadbackRequest::Data& req, int x, int y, int width, int
+        height, std::size_t size) const;
+#endif
+#ifdef PAZ_WINDOWS
+    void recreate();
+#endif
+};
+
+struct paz::TextureUpload::Data
+{
+#ifdef PAZ_MACOS
+    void* _buffer = nullptr;
+    std::size_t _index = 0;
+#elif defined(PAZ_LINUX)
+    std::size_t _buffer = 0;
+#else
+    ID3D11Texture2D* _staging = nullptr;
+#endif
+    // Only compared against, since `Texture::Data` is not accessible here.
+    std::shared_ptr<void> _texture;
+    int _width = 0;
+    int _height = 0;
+    std::size_t _bytesPerRow = 0;
+    unsigned char* _firstRow = nullptr;
+    std::ptrdiff_t _rowStride = 0;
+    bool _done = false;
+    ~Data();
+};
+
+struct paz::TextureArray::Data
+{
+#ifdef PAZ_MACOS
+    void* _sampler = nullptr;
+    void* _texture = nullptr;
+#elif defined(PAZ_LINUX)
+    unsigned int _id = 0;
+#else
+    ID3D11Texture2D* _texture = nullptr;
+    ID3D11SamplerState* _sampler = nullptr;
+    ID3D11ShaderResourceView* _resourceView = nullptr;
+#endif
+    int _width = 0;
+    int _height = 0;
+    int _layers = 0;
+    TextureFormat _format;
+    MipmapFilter _mipFilter = MipmapFilter::None;
+    bool _mipmapsDirty = false;
+    TextureCounter _counter;
+    ~Data();
+    void ensureMipmaps();
 };
 
 struct paz::VertexBuffer::Data
@@ -61,6 +126,7 @@ struct paz::VertexBuffer::Data
         size);
 #endif
     std::size_t _numVertices = 0;
+    BufferCounter _counter;
     ~Data();
     void checkSize(int dim, std::size_t size);
 };
@@ -85,8 +151,18 @@ struct paz::InstanceBuffer::Data
         size);
 #endif
     std::size_t _numInstances = 0;
+    std::size_t _numGathered = 0;
+    bool _gathered = false;
+    BufferCounter _counter;
     ~Data();
     void checkSize(int dim, std::size_t size);
+    std::size_t stride(std::size_t idx) const;
+    void* map(std::size_t idx, std::size_t size);
+    void unmap(std::size_t idx);
+    void gather(std::size_t idx, const void* data, const std::vector<unsigned
+        int>& indices);
+    void stream(std::size_t idx, const void* data, std::size_t numBytes);
+    std::size_t numDrawn() const;
 };
 
 struct paz::IndexBuffer::Data
@@ -99,6 +175,7 @@ struct paz::IndexBuffer::Data
     ID3D11Buffer* _buffer = nullptr;
 #endif
     std::size_t _numIndices = 0;
+    BufferCounter _counter;
     ~Data();
 };
 
@@ -114,6 +191,7 @@ struct paz::Framebuffer::Data
 #endif
     int width();
     int height();
+    int allocatedHeight();
 };
 
 struct paz::VertexFunction::Data
@@ -177,6 +255,171 @@ struct paz::RenderPass::Data
     void mapUniforms();
 #endif
     std::shared_ptr<Framebuffer::Data> _fbo;
+    ProgramCounter _counter;
+    std::string _name;
+};
+
+struct paz::OcclusionQuery::Data
+{
+#ifdef PAZ_MACOS
+    struct Issued
+    {
+        std::shared_ptr<void> _results;
+        std::size_t _offset;
+        void* _commandBuffer;
+    };
+    std::deque<Issued> _pending;
+#elif defined(PAZ_LINUX)
+    std::deque<unsigned int> _pending;
+    std::vector<unsigned int> _free;
+    unsigned int _latest = 0;
+#else
+    std::deque<ID3D11Predicate*> _pending;
+    std::vector<ID3D11Predicate*> _free;
+    ID3D11Predicate* _latest = nullptr;
+#endif
+    bool _visible = true;
+    bool _active = false;
+    ~Data();
+    void poll();
+};
+
+struct paz::ReadbackRequest::Data
+{
+#ifdef PAZ_MACOS
+    void* _buffer = nullptr;
+    std::size_t _index = 0;
+    void* _commandBuffer = nullptr;
+#elif defined(PAZ_LINUX)
+    std::size_t _buffer = 0;
+    void* _fence = nullptr;
+    // Waits for the transfer and maps the pack buffer until `unmap()`.
+    const void* map();
+    void unmap();
+#else
+    std::size_t _staging = 0;
+    int _srcX = 0;
+    int _srcY = 0;
+#endif
+    Image _result;
+    bool _toSrgb = false;
+    bool _done = false;
+    ~Data();
+#ifdef PAZ_WINDOWS
+    void acquire(TextureFormat format, int width, int height);
+#else
+    void acquire(std::size_t size);
+#endif
+    bool poll();
+    void finish();
+    void complete();
+};
+
+struct paz::RenderGraph::Data
+{
+    struct TargetDesc
+    {
+        TextureFormat _format;
+        double _scale;
+        int _width;
+        int _height;
+        MinMagFilter _minFilter;
+        MinMagFilter _magFilter;
+        MipmapFilter _mipFilter;
+        WrapMode _wrapS;
+        WrapMode _wrapT;
+        bool _keep = false;
+        bool aliases(const TargetDesc& t) const;
+    };
+    struct PassDesc
+    {
+        VertexFunction _vert;
+        FragmentFunction _frag;
+        std::vector<std::pair<std::string, std::size_t>> _reads;
+        std::vector<std::size_t> _writes;
+        std::function<void(RenderPass&)> _draw;
+        std::vector<LoadAction> _colorLoadActions;
+        LoadAction _depthLoadAction;
+        std::vector<BlendMode> _modes;
+    };
+    std::vector<TargetDesc> _targets;
+    std::vector<PassDesc> _passes;
+    bool _compiled = false;
+    std::vector<std::size_t> _order;
+    std::vector<RenderPass> _renderPasses;
+    std::vector<std::size_t> _physicalIdx;
+    std::vector<RenderTarget> _physical;
+    void compile();
+};
+
+struct paz::TextBatch::Data
+{
+    RenderPass _pass;
+    Texture _font;
+    std::array<int, 256> _glyphIdx;
+    int _numGlyphs;
+    int _scale;
+    std::vector<float> _cells;
+    std::vector<float> _colors;
+    InstanceBuffer _instances;
+};
+
+struct paz::SpriteBatch::Data
+{
+    struct Bucket
+    {
+        std::vector<float> _transforms;
+        std::vector<float> _rects;
+        std::vector<float> _colors;
+        InstanceBuffer _instances;
+    };
+    Framebuffer _fbo;
+    VertexFunction _vert;
+    FragmentFunction _frag;
+    std::map<BlendMode, RenderPass> _passes;
+    std::vector<Texture> _pages;
+    std::vector<int> _spritePages;
+    std::vector<std::array<float, 4>> _spriteRects;
+    std::map<std::pair<BlendMode, int>, Bucket> _buckets;
+    std::size_t _size = 0;
+};
+
+struct paz::ResourceLoader::Data
+{
+    struct Upload
+    {
+        std::size_t _bytes = 0;
+        std::function<void()> _run;
+    };
+    struct Job
+    {
+        std::function<Upload()> _decode;
+        std::function<void(std::exception_ptr)> _complete;
+    };
+    struct Decoded
+    {
+        Upload _upload;
+        std::exception_ptr _error;
+        std::function<void(std::exception_ptr)> _complete;
+    };
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    std::condition_variable _jobAdded;
+    std::condition_variable _jobDecoded;
+    std::deque<Job> _jobs;
+    std::deque<Decoded> _decoded;
+    std::size_t _numDecoding = 0;
+    std::size_t _bytesDecoded = 0;
+    bool _stopping = false;
+    double _budgetSeconds = 2e-3;
+    std::size_t _budgetBytes = 8 << 20;
+    LoaderStats _stats;
+    static std::vector<Data*>& registry();
+    Data(int numThreads);
+    ~Data();
+    void push(Job&& job);
+    void decode();
+    void upload(bool budgeted);
 };
 
 #endif
@@ -122,7 +122,7 @@ paz::Key paz::convert_keycode(int key) noexcept
     return Key::Unknown;
 }
 
-#elif defined(PAZ_LINUX)
+#elif defined(PAZ_LINUX) && !defined(PAZ_HEADLESS)
 
 #include "gl_core_4_1.h"
 #include <GLFW/glfw3.h>
@@ -276,7 +276,7 @@ paz::GamepadButton paz::convert_button(int button) noexcept
     return GamepadButton::Unknown;
 }
 
-#else
+#elif defined(PAZ_WINDOWS)
 
 #define CASE(a, b) case 0x##a: return Key::b;
 
@@ -0,0 +1,358 @@
+#include "PAZ_Graphics"
+#include "common.hpp"
+#include "internal_data.hpp"
+#include <algorithm>
+#include <chrono>
+
+template<typename T, typename U>
+static void add_attribute(U& attributes, int dim, paz::DataType type, const T*
+    data, std::size_t size)
+{
+    attributes.push_back({dim, type, std::vector<unsigned char>(
+        reinterpret_cast<const unsigned char*>(data), reinterpret_cast<const
+        unsigned char*>(data + size))});
+}
+
+template<typename T>
+static std::function<void(std::exception_ptr)> complete(const T& state)
+{
+    return [state](std::exception_ptr e)
+    {
+        state->error = e;
+        state->done = true;
+    };
+}
+
+void paz::VertexData::addAttribute(int dim, const float* data, std::size_t size)
+{
+    add_attribute(_attributes, dim, DataType::Float, data, size);
+}
+
+void paz::VertexData::addAttribute(int dim, const unsigned int* data, std::
+    size_t size)
+{
+    add_attribute(_attributes, dim, DataType::UInt, data, size);
+}
+
+void paz::VertexData::addAttribute(int dim, const int* data, std::size_t size)
+{
+    add_attribute(_attributes, dim, DataType::SInt, data, size);
+}
+
+std::vector<paz::ResourceLoader::Data*>& paz::ResourceLoader::Data::registry()
+{
+    static PAZ_CONTEXT_LOCAL std::vector<Data*> r;
+    return r;
+}
+
+paz::ResourceLoader::Data::Data(int numThreads)
+{
+    registry().push_back(this);
+    for(int i = 0; i < numThreads; ++i)
+    {
+        _workers.emplace_back(&Data::decode, this);
+    }
+}
+
+paz::ResourceLoader::Data::~Data()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _jobAdded.notify_all();
+    for(auto& n : _workers)
+    {
+        n.join();
+    }
+
+    // Finish what has been decoded and fail what has not, so no request is
+    // left waiting.
+    upload(false);
+    const auto error = std::make_exception_ptr(std::runtime_error("Resource lo"
+        "ader was destroyed before the request was decoded."));
+    for(auto& n : _jobs)
+    {
+        n._decode = nullptr;
+        n._complete(error);
+    }
+    auto& r = registry();
+    r.erase(std::remove(r.begin(), r.end(), this), r.end());
+}
+
+void paz::ResourceLoader::Data::push(Job&& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _jobs.push_back(std::move(job));
+        ++_numDecoding;
+    }
+    _jobAdded.notify_one();
+}
+
+void paz::ResourceLoader::Data::decode()
+{
+    while(true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _jobAdded.wait(lock, [&](){ return _stopping || !_jobs.empty(); });
+            // Jobs still queued are failed by the destructor.
+            if(_stopping)
+            {
+                return;
+            }
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+        Decoded d;
+        d._complete = std::move(job._complete);
+        try
+        {
+            d._upload = job._decode();
+        }
+        catch(...)
+        {
+            d._error = std::current_exception();
+        }
+
+        // Anything the job captured must be released before the render thread
+        // can finish the request, since results may only be destroyed there.
+        job._decode = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            --_numDecoding;
+            _bytesDecoded += d._upload._bytes;
+            _decoded.push_back(std::move(d));
+        }
+        _jobDecoded.notify_all();
+    }
+}
+
+void paz::ResourceLoader::Data::upload(bool budgeted)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const auto elapsed = [&]()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+            start).count();
+    };
+    std::size_t bytes = 0;
+    bool first = true;
+    while(true)
+    {
+        Decoded d;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if(_decoded.empty() || (budgeted && !first && (elapsed() >=
+                _budgetSeconds || bytes + _decoded.front()._upload._bytes >
+                _budgetBytes)))
+            {
+                break;
+            }
+            d = std::move(_decoded.front());
+            _decoded.pop_front();
+            _bytesDecoded -= d._upload._bytes;
+        }
+        first = false;
+        bytes += d._upload._bytes;
+        if(d._error)
+        {
+            d._complete(d._error);
+            continue;
+        }
+        try
+        {
+            d._upload._run();
+        }
+        catch(...)
+        {
+            d._complete(std::current_exception());
+            continue;
+        }
+        d._complete(nullptr);
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_stats.numLoaded;
+    }
+    if(budgeted)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stats.bytesUploadedLastFrame = bytes;
+        _stats.uploadTimeLastFrame = elapsed();
+    }
+}
+
+void paz::process_uploads()
+{
+    for(auto n : ResourceLoader::Data::registry())
+    {
+        n->upload(true);
+    }
+}
+
+paz::ResourceLoader::ResourceLoader(int numThreads)
+{
+    initialize();
+
+    if(numThreads < 0)
+    {
+        throw std::invalid_argument("Number of loader threads cannot be negativ"
+            "e.");
+    }
+    if(!numThreads)
+    {
+        numThreads = std::max(1, static_cast<int>(std::thread::
+            hardware_concurrency()) - 1);
+    }
+    _data = std::make_shared<Data>(numThreads);
+}
+
+void paz::ResourceLoader::setUploadBudget(double seconds, std::size_t bytes)
+{
+    if(seconds <= 0. || !bytes)
+    {
+        throw std::invalid_argument("Upload budget must be positive.");
+    }
+    std::lock_guard<std::mutex> lock(_data->_mutex);
+    _data->_budgetSeconds = seconds;
+    _data->_budgetBytes = bytes;
+}
+
+paz::LoadRequest<paz::Texture> paz::ResourceLoader::loadTexture(std::function<
+    Image()> decode, MinMagFilter minFilter, MinMagFilter magFilter,
+    MipmapFilter mipFilter, WrapMode wrapS, WrapMode wrapT)
+{
+    LoadRequest<Texture> req;
+    req._state = std::make_shared<LoadRequest<Texture>::State>();
+    const auto state = req._state;
+    _data->push({[=]()
+    {
+        const auto image = std::make_shared<const Image>(decode());
+        return Data::Upload{image->bytes().size(), [=]()
+        {
+            state->result = Texture(*image, minFilter, magFilter, mipFilter,
+                wrapS, wrapT);
+        }};
+    }, complete(state)});
+    return req;
+}
+
+paz::LoadRequest<paz::Texture> paz::ResourceLoader::loadCompressedTexture(std::
+    function<Image()> decode, TextureFormat format, CompressionQuality quality,
+    MinMagFilter minFilter, MinMagFilter magFilter, WrapMode wrapS, WrapMode
+    wrapT)
+{
+    if(!is_compressed(format))
+    {
+        throw std::invalid_argument("Requested format is not block-compressed."
+            );
+    }
+    LoadRequest<Texture> req;
+    req._state = std::make_shared<LoadRequest<Texture>::State>();
+    const auto state = req._state;
+    _data->push({[=]()
+    {
+        const Image image = decode();
+        const int width = image.width();
+        const int height = image.height();
+        const auto blocks = std::make_shared<const std::vector<unsigned char>>(
+            compress(image, format, quality));
+        return Data::Upload{blocks->size(), [=]()
+        {
+            state->result = Texture(format, width, height, blocks->data(),
+                minFilter, magFilter, MipmapFilter::None, wrapS, wrapT);
+        }};
+    }, complete(state)});
+    return req;
+}
+
+paz::LoadRequest<paz::VertexBuffer> paz::ResourceLoader::loadVertexBuffer(std::
+    function<VertexData()> decode)
+{
+    LoadRequest<VertexBuffer> req;
+    req._state = std::make_shared<LoadRequest<VertexBuffer>::State>();
+    const auto state = req._state;
+    _data->push({[=]()
+    {
+        const auto data = std::make_shared<const VertexData>(decode());
+        std::size_t bytes = 0;
+        for(const auto& n : data->_attributes)
+        {
+            bytes += n.bytes.size();
+        }
+        return Data::Upload{bytes, [=]()
+        {
+            VertexBuffer vertices;
+            for(const auto& n : data->_attributes)
+            {
+                const std::size_t size = n.bytes.size()/4;
+                if(n.type == DataType::Float)
+                {
+                    vertices.addAttribute(n.dim, reinterpret_cast<const float*>(
+                        n.bytes.data()), size);
+                }
+                else if(n.type == DataType::UInt)
+                {
+                    vertices.addAttribute(n.dim, reinterpret_cast<const
+                        unsigned int*>(n.bytes.data()), size);
+                }
+                else
+                {
+                    vertices.addAttribute(n.dim, reinterpret_cast<const int*>(n.
+                        bytes.data()), size);
+                }
+            }
+            state->result = std::move(vertices);
+        }};
+    }, complete(state)});
+    return req;
+}
+
+paz::LoadRequest<paz::IndexBuffer> paz::ResourceLoader::loadIndexBuffer(std::
+    function<std::vector<unsigned int>()> decode)
+{
+    LoadRequest<IndexBuffer> req;
+    req._state = std::make_shared<LoadRequest<IndexBuffer>::State>();
+    const auto state = req._state;
+    _data->push({[=]()
+    {
+        const auto indices = std::make_shared<const std::vector<unsigned int>>(
+            decode());
+        return Data::Upload{4*indices->size(), [=]()
+        {
+            state->result = IndexBuffer(*indices);
+        }};
+    }, complete(state)});
+    return req;
+}
+
+void paz::ResourceLoader::finish()
+{
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_data->_mutex);
+            _data->_jobDecoded.wait(lock, [&]()
+            {
+                return !_data->_decoded.empty() || !_data->_numDecoding;
+            });
+            if(_data->_decoded.empty())
+            {
+                return;
+            }
+        }
+        _data->upload(false);
+    }
+}
+
+paz::LoaderStats paz::ResourceLoader::stats() const
+{
+    std::lock_guard<std::mutex> lock(_data->_mutex);
+    LoaderStats s = _data->_stats;
+    s.numDecoding = _data->_numDecoding;
+    s.numAwaitingUpload = _data->_decoded.size();
+    s.bytesAwaitingUpload = _data->_bytesDecoded;
+    return s;
+}
@@ -0,0 +1,208 @@
+#include "PAZ_Graphics"
+#include <algorithm>
+#include <cmath>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static constexpr std::size_t BatchSize = 4;
+
+std::array<float, 16> paz::multiply(const std::array<float, 16>& a, const std::
+    array<float, 16>& b)
+{
+    std::array<float, 16> res;
+#ifdef __SSE2__
+    // Each column of the result combines the columns of `a`.
+    const __m128 a0 = _mm_loadu_ps(a.data());
+    const __m128 a1 = _mm_loadu_ps(a.data() + 4);
+    const __m128 a2 = _mm_loadu_ps(a.data() + 8);
+    const __m128 a3 = _mm_loadu_ps(a.data() + 12);
+    for(int i = 0; i < 4; ++i)
+    {
+        const __m128 c = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(b[4*
+            i])), _mm_mul_ps(a1, _mm_set1_ps(b[4*i + 1]))), _mm_add_ps(
+            _mm_mul_ps(a2, _mm_set1_ps(b[4*i + 2])), _mm_mul_ps(a3,
+            _mm_set1_ps(b[4*i + 3]))));
+        _mm_storeu_ps(res.data() + 4*i, c);
+    }
+#else
+    for(int i = 0; i < 4; ++i)
+    {
+        for(int j = 0; j < 4; ++j)
+        {
+            res[4*i + j] = a[j]*b[4*i] + a[4 + j]*b[4*i + 1] + a[8 + j]*b[4*i +
+                2] + a[12 + j]*b[4*i + 3];
+        }
+    }
+#endif
+    return res;
+}
+
+// Cofactor expansion in terms of 2x2 subdeterminants.
+std::array<float, 16> paz::inverse(const std::array<float, 16>& m)
+{
+    const float s0 = m[0]*m[5] - m[4]*m[1];
+    const float s1 = m[0]*m[6] - m[4]*m[2];
+    const float s2 = m[0]*m[7] - m[4]*m[3];
+    const float s3 = m[1]*m[6] - m[5]*m[2];
+    const float s4 = m[1]*m[7] - m[5]*m[3];
+    const float s5 = m[2]*m[7] - m[6]*m[3];
+    const float c5 = m[10]*m[15] - m[14]*m[11];
+    const float c4 = m[9]*m[15] - m[13]*m[11];
+    const float c3 = m[9]*m[14] - m[13]*m[10];
+    const float c2 = m[8]*m[15] - m[12]*m[11];
+    const float c1 = m[8]*m[14] - m[12]*m[10];
+    const float c0 = m[8]*m[13] - m[12]*m[9];
+    const float det = s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+    if(!det || !std::isfinite(det))
+    {
+        throw std::runtime_error("Matrix is singular.");
+    }
+    const float d = 1.f/det;
+    return {( m[5]*c5 - m[6]*c4 + m[7]*c3)*d,
+            (-m[1]*c5 + m[2]*c4 - m[3]*c3)*d,
+            ( m[13]*s5 - m[14]*s4 + m[15]*s3)*d,
+            (-m[9]*s5 + m[10]*s4 - m[11]*s3)*d,
+            (-m[4]*c5 + m[6]*c2 - m[7]*c1)*d,
+            ( m[0]*c5 - m[2]*c2 + m[3]*c1)*d,
+            (-m[12]*s5 + m[14]*s2 - m[15]*s1)*d,
+            ( m[8]*s5 - m[10]*s2 + m[11]*s1)*d,
+            ( m[4]*c4 - m[5]*c2 + m[7]*c0)*d,
+            (-m[0]*c4 + m[1]*c2 - m[3]*c0)*d,
+            ( m[12]*s4 - m[13]*s2 + m[15]*s0)*d,
+            (-m[8]*s4 + m[9]*s2 - m[11]*s0)*d,
+            (-m[4]*c3 + m[5]*c1 - m[6]*c0)*d,
+            ( m[0]*c3 - m[1]*c1 + m[2]*c0)*d,
+            (-m[12]*s3 + m[13]*s1 - m[14]*s0)*d,
+            ( m[8]*s3 - m[9]*s1 + m[10]*s0)*d};
+}
+
+std::array<float, 16> paz::rotation(const std::array<float, 4>& quat)
+{
+    const float x = quat[0];
+    const float y = quat[1];
+    const float z = quat[2];
+    const float w = quat[3];
+    return {1.f - 2.f*(y*y + z*z), 2.f*(x*y + w*z), 2.f*(x*z - w*y), 0.f,
+            2.f*(x*y - w*z), 1.f - 2.f*(x*x + z*z), 2.f*(y*z + w*x), 0.f,
+            2.f*(x*z + w*y), 2.f*(y*z - w*x), 1.f - 2.f*(x*x + y*y), 0.f,
+            0.f, 0.f, 0.f, 1.f};
+}
+
+#ifdef __SSE2__
+// Transposes four columns, one per lane, and writes them to consecutive
+// instances.
+static void store_columns(__m128 x, __m128 y, __m128 z, __m128 w, float* out)
+{
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(out, x);
+    _mm_storeu_ps(out + 4, y);
+    _mm_storeu_ps(out + 8, z);
+    _mm_storeu_ps(out + 12, w);
+}
+#endif
+
+void paz::model_matrices(const InstanceTransforms& transforms, const std::array<
+    float*, 4>& columns)
+{
+    const auto& t = transforms;
+    if(t.size && (!t.x || !t.y || !t.z || !t.qx || !t.qy || !t.qz || !t.qw))
+    {
+        throw std::invalid_argument("Instance transforms are missing a compone"
+            "nt.");
+    }
+    if(t.size && (!columns[0] || !columns[1] || !columns[2] || !columns[3]))
+    {
+        throw std::invalid_argument("Missing output column.");
+    }
+
+    std::size_t i = 0;
+#ifdef __SSE2__
+    // Four instances are computed at once, one per lane, and transposed into
+    // the per-instance layout of the output.
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 two = _mm_set1_ps(2.f);
+    const __m128 zero = _mm_setzero_ps();
+    for(; i + BatchSize <= t.size; i += BatchSize)
+    {
+        const __m128 x = _mm_loadu_ps(t.qx + i);
+        const __m128 y = _mm_loadu_ps(t.qy + i);
+        const __m128 z = _mm_loadu_ps(t.qz + i);
+        const __m128 w = _mm_loadu_ps(t.qw + i);
+        const __m128 s = t.scale ? _mm_loadu_ps(t.scale + i) : one;
+        const __m128 xx = _mm_mul_ps(x, x);
+        const __m128 yy = _mm_mul_ps(y, y);
+        const __m128 zz = _mm_mul_ps(z, z);
+        const __m128 xy = _mm_mul_ps(x, y);
+        const __m128 xz = _mm_mul_ps(x, z);
+        const __m128 yz = _mm_mul_ps(y, z);
+        const __m128 wx = _mm_mul_ps(w, x);
+        const __m128 wy = _mm_mul_ps(w, y);
+        const __m128 wz = _mm_mul_ps(w, z);
+        const __m128 s2 = _mm_mul_ps(two, s);
+        store_columns(_mm_mul_ps(s, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(
+            yy, zz)))), _mm_mul_ps(s2, _mm_add_ps(xy, wz)), _mm_mul_ps(s2,
+            _mm_sub_ps(xz, wy)), zero, columns[0] + 4*i);
+        store_columns(_mm_mul_ps(s2, _mm_sub_ps(xy, wz)), _mm_mul_ps(s,
+            _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)))), _mm_mul_ps(
+            s2, _mm_add_ps(yz, wx)), zero, columns[1] + 4*i);
+        store_columns(_mm_mul_ps(s2, _mm_add_ps(xz, wy)), _mm_mul_ps(s2,
+            _mm_sub_ps(yz, wx)), _mm_mul_ps(s, _mm_sub_ps(one, _mm_mul_ps(two,
+            _mm_add_ps(xx, yy)))), zero, columns[2] + 4*i);
+        store_columns(_mm_loadu_ps(t.x + i), _mm_loadu_ps(t.y + i),
+            _mm_loadu_ps(t.z + i), one, columns[3] + 4*i);
+    }
+#endif
+    for(; i < t.size; ++i)
+    {
+        const float s = t.scale ? t.scale[i] : 1.f;
+        const auto r = rotation({t.qx[i], t.qy[i], t.qz[i], t.qw[i]});
+        for(int j = 0; j < 3; ++j)
+        {
+            for(int k = 0; k < 4; ++k)
+            {
+                columns[j][4*i + k] = s*r[4*j + k];
+            }
+        }
+        columns[3][4*i] = t.x[i];
+        columns[3][4*i + 1] = t.y[i];
+        columns[3][4*i + 2] = t.z[i];
+        columns[3][4*i + 3] = 1.f;
+    }
+}
+
+void paz::multiply(const std::array<float, 16>& a, const std::array<float, 16>*
+    b, std::size_t n, const std::array<float*, 4>& columns)
+{
+    if(n && (!b || !columns[0] || !columns[1] || !columns[2] || !columns[3]))
+    {
+        throw std::invalid_argument("Missing input or output.");
+    }
+#ifdef __SSE2__
+    const __m128 a0 = _mm_loadu_ps(a.data());
+    const __m128 a1 = _mm_loadu_ps(a.data() + 4);
+    const __m128 a2 = _mm_loadu_ps(a.data() + 8);
+    const __m128 a3 = _mm_loadu_ps(a.data() + 12);
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        for(int j = 0; j < 4; ++j)
+        {
+            const float* c = b[i].data() + 4*j;
+            _mm_storeu_ps(columns[j] + 4*i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(
+                a0, _mm_set1_ps(c[0])), _mm_mul_ps(a1, _mm_set1_ps(c[1]))),
+                _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(c[2])), _mm_mul_ps(a3,
+                _mm_set1_ps(c[3])))));
+        }
+    }
+#else
+    for(std::size_t i = 0; i < n; ++i)
+    {
+        const auto m = multiply(a, b[i]);
+        for(int j = 0; j < 4; ++j)
+        {
+            std::copy(m.begin() + 4*j, m.begin() + 4*(j + 1), columns[j] + 4*
+                i);
+        }
+    }
+#endif
+}
@@ -0,0 +1,61 @@
+#include "detect_os.hpp"
+
+#ifdef PAZ_LINUX
+
+#include "PAZ_Graphics"
+#include "internal_data.hpp"
+#include "common.hpp"
+#include "gl_core_4_1.h"
+
+paz::OcclusionQuery::Data::~Data()
+{
+    for(auto n : _pending)
+    {
+        glDeleteQueries(1, &n);
+    }
+    if(!_free.empty())
+    {
+        glDeleteQueries(_free.size(), _free.data());
+    }
+}
+
+void paz::OcclusionQuery::Data::poll()
+{
+    // Queries complete in order. A query in progress cannot be read.
+    while(_pending.size() > (_active ? 1 : 0))
+    {
+        GLuint available;
+        glGetQueryObjectuiv(_pending.front(), GL_QUERY_RESULT_AVAILABLE,
+            &available);
+        if(!available)
+        {
+            break;
+        }
+        GLuint result;
+        glGetQueryObjectuiv(_pending.front(), GL_QUERY_RESULT, &result);
+        _visible = result;
+        _free.push_back(_pending.front());
+        _pending.pop_front();
+    }
+}
+
+paz::OcclusionQuery::OcclusionQuery()
+{
+    initialize();
+
+    _data = std::make_shared<Data>();
+}
+
+bool paz::OcclusionQuery::ready() const
+{
+    _data->poll();
+    return _data->_pending.empty();
+}
+
+bool paz::OcclusionQuery::visible() const
+{
+    _data->poll();
+    return _data->_visible;
+}
+
+#endif
@@ -0,0 +1,56 @@
+#include "detect_os.hpp"
+
+#ifdef PAZ_MACOS
+
+#include "PAZ_Graphics"
+#include "internal_data.hpp"
+#include "common.hpp"
+#import <MetalKit/MetalKit.h>
+
+paz::OcclusionQuery::Data::~Data()
+{
+    for(const auto& n : _pending)
+    {
+        [static_cast<id<MTLCommandBuffer>>(n._commandBuffer) release];
+    }
+}
+
+void paz::OcclusionQuery::Data::poll()
+{
+    // Queries complete in order. A query in progress cannot be read.
+    while(_pending.size() > (_active ? 1 : 0))
+    {
+        const auto& n = _pending.front();
+        if([static_cast<id<MTLCommandBuffer>>(n._commandBuffer) status] <
+            MTLCommandBufferStatusCompleted)
+        {
+            break;
+        }
+        _visible = *reinterpret_cast<const std::uint64_t*>(static_cast<const
+            unsigned char*>([static_cast<id<MTLBuffer>>(n._results.get())
+            contents]) + n._offset);
+        [static_cast<id<MTLCommandBuffer>>(n._commandBuffer) release];
+        _pending.pop_front();
+    }
+}
+
+paz::OcclusionQuery::OcclusionQuery()
+{
+    initialize();
+
+    _data = std::make_shared<Data>();
+}
+
+bool paz::OcclusionQuery::ready() const
+{
+    _data->poll();
+    return _data->_pending.empty();
+}
+
+bool paz::OcclusionQuery::visible() const
+{
+    _data->poll();
+    return _data->_visible;
+}
+
+#endif
@@ -0,0 +1,58 @@
+#include "detect_os.hpp"
+
+#ifdef PAZ_WINDOWS
+
+#include "PAZ_Graphics"
+#include "internal_data.hpp"
+#include "util_windows.hpp"
+#include "common.hpp"
+
+paz::OcclusionQuery::Data::~Data()
+{
+    for(auto n : _pending)
+    {
+        n->Release();
+    }
+    for(auto n : _free)
+    {
+        n->Release();
+    }
+}
+
+void paz::OcclusionQuery::Data::poll()
+{
+    // Queries complete in order. A query in progress cannot be read.
+    while(_pending.size() > (_active ? 1 : 0))
+    {
+        BOOL result;
+        if(d3d_context()->GetData(_pending.front(), &result, sizeof(result),
+            D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+        {
+            break;
+        }
+        _visible = result;
+        _free.push_back(_pending.front());
+        _pending.pop_front();
+    }
+}
+
+paz::OcclusionQuery::OcclusionQuery()
+{
+    initialize();
+
+    _data = std::make_shared<Data>();
+}
+
+bool paz::OcclusionQuery::ready() const
+{
+    _data->poll();
+    return _data->_pending.empty();
+}
+
+bool paz::OcclusionQuery::visible() const
+{
+    _data->poll();
+    return _data->_visible;
+}
+
+#endif
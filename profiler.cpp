@@ -0,0 +1,223 @@
+#include "PAZ_Graphics"
+#include "common.hpp"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+
+static constexpr std::size_t RingSize = 1 << 16;
+
+namespace
+{
+    struct Event
+    {
+        const char* name;
+        std::uint64_t start;
+        std::uint64_t end;
+    };
+
+    struct ThreadRing
+    {
+        std::mutex mutex;
+        std::vector<Event> events;
+        std::size_t next = 0;
+        std::size_t count = 0;
+        std::size_t tid;
+        bool dead = false;
+    };
+}
+
+static std::atomic<bool> _enabled(false);
+static std::mutex _ringsMutex;
+static std::size_t _nextTid = 1;
+
+static std::vector<std::shared_ptr<ThreadRing>>& rings()
+{
+    static std::vector<std::shared_ptr<ThreadRing>> r;
+    return r;
+}
+
+// Drops the rings of exited threads, or only those in `written` if given.
+// Requires `_ringsMutex`.
+static void drop_dead_rings(const std::vector<ThreadRing*>* written = nullptr)
+{
+    rings().erase(std::remove_if(rings().begin(), rings().end(), [&](const std::
+        shared_ptr<ThreadRing>& r)
+    {
+        return r->dead && (!written || std::find(written->begin(), written->
+            end(), r.get()) != written->end());
+    }), rings().end());
+}
+
+namespace
+{
+    // Marks its thread's ring dead on exit. Rings with events outlive their
+    // threads until those events are written or cleared.
+    struct RingOwner
+    {
+        std::shared_ptr<ThreadRing> ring;
+
+        RingOwner() : ring(std::make_shared<ThreadRing>())
+        {
+            std::lock_guard<std::mutex> lock(_ringsMutex);
+            ring->tid = _nextTid++;
+            rings().push_back(ring);
+        }
+
+        ~RingOwner()
+        {
+            std::lock_guard<std::mutex> lock(_ringsMutex);
+            {
+                std::lock_guard<std::mutex> ringLock(ring->mutex);
+                ring->dead = true;
+                if(ring->count)
+                {
+                    return;
+                }
+            }
+            rings().erase(std::find(rings().begin(), rings().end(), ring));
+        }
+    };
+}
+
+static ThreadRing& thread_ring()
+{
+    static thread_local const RingOwner owner;
+    return *owner.ring;
+}
+
+static std::uint64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::
+        steady_clock::now().time_since_epoch()).count();
+}
+
+static void write_escaped(std::ostream& out, const char* str)
+{
+    static constexpr char Hex[] = "0123456789abcdef";
+    for(; *str; ++str)
+    {
+        const unsigned char c = *str;
+        if(c == '"' || c == '\\')
+        {
+            out << '\\' << c;
+        }
+        else if(c < 0x20)
+        {
+            out << "\\u00" << Hex[c >> 4] << Hex[c&0xf];
+        }
+        else
+        {
+            out << c;
+        }
+    }
+}
+
+paz::ProfileScope::ProfileScope(const char* name) : _name(_enabled.load(std::
+    memory_order_relaxed) ? name : nullptr)
+{
+    if(_name)
+    {
+        _start = now();
+    }
+}
+
+paz::ProfileScope::~ProfileScope()
+{
+    if(!_name)
+    {
+        return;
+    }
+    const std::uint64_t end = now();
+    auto& r = thread_ring();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    if(r.events.empty())
+    {
+        r.events.resize(RingSize);
+    }
+    r.events[r.next] = {_name, _start, end};
+    r.next = (r.next + 1)%RingSize;
+    r.count = std::min(r.count + 1, RingSize);
+}
+
+void paz::Profiler::Enable()
+{
+    _enabled = true;
+}
+
+void paz::Profiler::Disable()
+{
+    _enabled = false;
+}
+
+bool paz::Profiler::Enabled()
+{
+    return _enabled;
+}
+
+void paz::Profiler::WriteTrace(const std::string& path)
+{
+    std::vector<std::pair<std::size_t, Event>> events;
+    std::vector<ThreadRing*> written;
+    {
+        std::lock_guard<std::mutex> lock(_ringsMutex);
+        for(const auto& n : rings())
+        {
+            std::lock_guard<std::mutex> ringLock(n->mutex);
+            if(n->dead)
+            {
+                written.push_back(n.get());
+            }
+            for(std::size_t i = 0; i < n->count; ++i)
+            {
+                events.emplace_back(n->tid, n->events[(n->next + RingSize - n->
+                    count + i)%RingSize]);
+            }
+        }
+    }
+    std::uint64_t origin = events.empty() ? 0 : events[0].second.start;
+    for(const auto& n : events)
+    {
+        origin = std::min(origin, n.second.start);
+    }
+
+    std::ofstream out(path);
+    if(!out)
+    {
+        throw std::runtime_error("Failed to open \"" + path + "\" for writing."
+            );
+    }
+    out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+    bool first = true;
+    for(const auto& n : events)
+    {
+        out << (first ? "\n" : ",\n") << "{\"name\":\"";
+        write_escaped(out, n.second.name);
+        out << "\",\"cat\":\"paz\",\"ph\":\"X\",\"ts\":" << 1e-3*(n.second.
+            start - origin) << ",\"dur\":" << 1e-3*(n.second.end - n.second.
+            start) << ",\"pid\":1,\"tid\":" << n.first << "}";
+        first = false;
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    if(!out)
+    {
+        throw std::runtime_error("Failed to write trace to \"" + path + "\".");
+    }
+
+    // Rings of exited threads are only kept until their events are written.
+    std::lock_guard<std::mutex> lock(_ringsMutex);
+    drop_dead_rings(&written);
+}
+
+void paz::Profiler::Clear()
+{
+    std::lock_guard<std::mutex> lock(_ringsMutex);
+    for(const auto& n : rings())
+    {
+        std::lock_guard<std::mutex> ringLock(n->mutex);
+        n->next = 0;
+        n->count = 0;
+    }
+    drop_dead_rings();
+}
@@ -0,0 +1,46 @@
+#include "PAZ_Graphics"
+#include "common.hpp"
+#include "internal_data.hpp"
+#include <cstdint>
+
+paz::ReadbackRequest::ReadbackRequest()
+{
+    initialize();
+}
+
+bool paz::ReadbackRequest::ready() const
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Readback request has not been initialized.");
+    }
+    return _data->_done || _data->poll();
+}
+
+paz::Image paz::ReadbackRequest::get()
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Readback request has not been initialized.");
+    }
+    if(!_data->_done)
+    {
+        _data->complete();
+    }
+    return _data->_result;
+}
+
+void paz::ReadbackRequest::Data::complete()
+{
+    finish();
+    _done = true;
+    if(_toSrgb)
+    {
+        Image srgb(ImageFormat::RGBA8UNorm_sRGB, _result.width(), _result.
+            height());
+        convert_to_srgb(reinterpret_cast<const std::uint16_t*>(_result.bytes().
+            data()), 8*srgb.width(), srgb.bytes().data(), srgb.width(), srgb.
+            height(), false);
+        _result = std::move(srgb);
+    }
+}
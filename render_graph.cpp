@@ -0,0 +1,363 @@
+#include "PAZ_Graphics"
+#include "common.hpp"
+#include "internal_data.hpp"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+static constexpr std::size_t Never = std::numeric_limits<std::size_t>::max();
+
+bool paz::RenderGraph::Data::TargetDesc::aliases(const TargetDesc& t) const
+{
+    return _format == t._format && _scale == t._scale && _width == t._width &&
+        _height == t._height && _minFilter == t._minFilter && _magFilter == t.
+        _magFilter && _mipFilter == t._mipFilter && _wrapS == t._wrapS &&
+        _wrapT == t._wrapT;
+}
+
+void paz::RenderGraph::Data::compile()
+{
+    const std::size_t numPasses = _passes.size();
+    const std::size_t numTargets = _targets.size();
+
+    std::vector<std::vector<std::size_t>> writers(numTargets);
+    for(std::size_t i = 0; i < numPasses; ++i)
+    {
+        for(auto n : _passes[i]._writes)
+        {
+            writers[n].push_back(i);
+        }
+    }
+
+    // Cull passes that do not contribute to the window or a kept target.
+    std::vector<bool> alive(numPasses, false);
+    std::vector<std::size_t> stack;
+    for(std::size_t i = 0; i < numPasses; ++i)
+    {
+        bool needed = _passes[i]._writes.empty();
+        for(auto n : _passes[i]._writes)
+        {
+            needed = needed || _targets[n]._keep;
+        }
+        if(needed)
+        {
+            alive[i] = true;
+            stack.push_back(i);
+        }
+    }
+    while(!stack.empty())
+    {
+        const std::size_t i = stack.back();
+        stack.pop_back();
+        for(const auto& n : _passes[i]._reads)
+        {
+            if(writers[n.second].empty())
+            {
+                throw std::logic_error("Render graph target " + std::to_string(
+                    n.second) + " is read but never written.");
+            }
+            for(auto m : writers[n.second])
+            {
+                if(m == i)
+                {
+                    throw std::logic_error("Render graph pass reads a target it"
+                        " writes.");
+                }
+                if(!alive[m])
+                {
+                    alive[m] = true;
+                    stack.push_back(m);
+                }
+            }
+        }
+    }
+
+    // Readers depend on every writer and writers of the same target run in the
+    // order they were added. Ties are broken by insertion order.
+    std::vector<std::vector<std::size_t>> edges(numPasses);
+    std::vector<std::size_t> inDegree(numPasses, 0);
+    const auto addEdge = [&](std::size_t from, std::size_t to)
+    {
+        edges[from].push_back(to);
+        ++inDegree[to];
+    };
+    for(std::size_t i = 0; i < numPasses; ++i)
+    {
+        if(!alive[i])
+        {
+            continue;
+        }
+        for(const auto& n : _passes[i]._reads)
+        {
+            for(auto m : writers[n.second])
+            {
+                addEdge(m, i);
+            }
+        }
+    }
+    for(const auto& w : writers)
+    {
+        std::size_t prev = Never;
+        for(auto n : w)
+        {
+            if(!alive[n])
+            {
+                continue;
+            }
+            if(prev != Never)
+            {
+                addEdge(prev, n);
+            }
+            prev = n;
+        }
+    }
+    std::priority_queue<std::size_t, std::vector<std::size_t>, std::greater<
+        std::size_t>> ready;
+    std::size_t numAlive = 0;
+    for(std::size_t i = 0; i < numPasses; ++i)
+    {
+        if(alive[i])
+        {
+            ++numAlive;
+            if(!inDegree[i])
+            {
+                ready.push(i);
+            }
+        }
+    }
+    _order.clear();
+    while(!ready.empty())
+    {
+        const std::size_t i = ready.top();
+        ready.pop();
+        _order.push_back(i);
+        for(auto n : edges[i])
+        {
+            if(!--inDegree[n])
+            {
+                ready.push(n);
+            }
+        }
+    }
+    if(_order.size() != numAlive)
+    {
+        throw std::logic_error("Render graph contains a cycle.");
+    }
+
+    // Find the span of passes during which each target must hold its contents.
+    std::vector<std::size_t> first(numTargets, Never);
+    std::vector<std::size_t> last(numTargets, 0);
+    for(std::size_t i = 0; i < _order.size(); ++i)
+    {
+        const auto& p = _passes[_order[i]];
+        const auto use = [&](std::size_t n)
+        {
+            first[n] = std::min(first[n], i);
+            last[n] = _targets[n]._keep ? Never : std::max(last[n], i);
+        };
+        for(const auto& n : p._reads)
+        {
+            use(n.second);
+        }
+        for(auto n : p._writes)
+        {
+            use(n);
+        }
+    }
+
+    // Assign targets to physical render targets, reusing any that are free.
+    std::vector<std::size_t> byFirst;
+    for(std::size_t i = 0; i < numTargets; ++i)
+    {
+        if(first[i] != Never)
+        {
+            byFirst.push_back(i);
+        }
+    }
+    std::stable_sort(byFirst.begin(), byFirst.end(), [&](std::size_t a, std::
+        size_t b)
+    {
+        return first[a] < first[b];
+    });
+    std::vector<std::size_t> physicalTarget;
+    std::vector<std::size_t> busyUntil;
+    _physicalIdx.assign(numTargets, Never);
+    _physical.clear();
+    for(auto n : byFirst)
+    {
+        const auto& t = _targets[n];
+        for(std::size_t i = 0; i < _physical.size(); ++i)
+        {
+            if(busyUntil[i] < first[n] && _targets[physicalTarget[i]].aliases(
+                t))
+            {
+                _physicalIdx[n] = i;
+                busyUntil[i] = last[n];
+                break;
+            }
+        }
+        if(_physicalIdx[n] == Never)
+        {
+            _physicalIdx[n] = _physical.size();
+            physicalTarget.push_back(n);
+            busyUntil.push_back(last[n]);
+            if(t._scale > 0.)
+            {
+                _physical.push_back(RenderTarget(t._format, t._scale, t.
+                    _minFilter, t._magFilter, t._mipFilter, t._wrapS, t.
+                    _wrapT));
+            }
+            else
+            {
+                _physical.push_back(RenderTarget(t._format, t._width, t.
+                    _height, t._minFilter, t._magFilter, t._mipFilter, t._wrapS,
+                    t._wrapT));
+            }
+        }
+    }
+
+    // Consecutive passes that write the same targets share a framebuffer.
+    _renderPasses.clear();
+    std::vector<std::size_t> prevAttachments;
+    Framebuffer fbo;
+    for(auto i : _order)
+    {
+        const auto& p = _passes[i];
+        if(p._writes.empty())
+        {
+            _renderPasses.push_back(RenderPass(p._vert, p._frag, p._modes));
+            prevAttachments.clear();
+            continue;
+        }
+        std::vector<std::size_t> attachments;
+        for(auto n : p._writes)
+        {
+            attachments.push_back(_physicalIdx[n]);
+        }
+        if(attachments != prevAttachments)
+        {
+            fbo = Framebuffer();
+            for(auto n : attachments)
+            {
+                fbo.attach(_physical[n]);
+            }
+            prevAttachments = attachments;
+        }
+        _renderPasses.push_back(RenderPass(fbo, p._vert, p._frag, p._modes));
+    }
+
+    _compiled = true;
+}
+
+paz::RenderGraph::RenderGraph()
+{
+    initialize();
+
+    _data = std::make_shared<Data>();
+}
+
+std::size_t paz::RenderGraph::addTarget(TextureFormat format, double scale,
+    MinMagFilter minFilter, MinMagFilter magFilter, MipmapFilter mipFilter,
+    WrapMode wrapS, WrapMode wrapT)
+{
+    if(scale <= 0.)
+    {
+        throw std::runtime_error("Render target scale must be positive.");
+    }
+    _data->_targets.push_back({format, scale, 0, 0, minFilter, magFilter,
+        mipFilter, wrapS, wrapT});
+    _data->_compiled = false;
+    return _data->_targets.size() - 1;
+}
+
+std::size_t paz::RenderGraph::addTarget(TextureFormat format, int width, int
+    height, MinMagFilter minFilter, MinMagFilter magFilter, MipmapFilter
+    mipFilter, WrapMode wrapS, WrapMode wrapT)
+{
+    _data->_targets.push_back({format, 0., width, height, minFilter, magFilter,
+        mipFilter, wrapS, wrapT});
+    _data->_compiled = false;
+    return _data->_targets.size() - 1;
+}
+
+void paz::RenderGraph::addPass(const VertexFunction& vert, const
+    FragmentFunction& frag, const std::vector<std::pair<std::string, std::
+    size_t>>& reads, const std::vector<std::size_t>& writes, const std::
+    function<void(RenderPass&)>& draw, const std::vector<LoadAction>&
+    colorLoadActions, LoadAction depthLoadAction, const std::vector<BlendMode>&
+    modes)
+{
+    for(const auto& n : reads)
+    {
+        if(n.second >= _data->_targets.size())
+        {
+            throw std::out_of_range("Render graph target " + std::to_string(n.
+                second) + " does not exist.");
+        }
+    }
+    for(auto n : writes)
+    {
+        if(n >= _data->_targets.size())
+        {
+            throw std::out_of_range("Render graph target " + std::to_string(n) +
+                " does not exist.");
+        }
+    }
+    _data->_passes.push_back({vert, frag, reads, writes, draw, colorLoadActions,
+        depthLoadAction, modes});
+    _data->_compiled = false;
+}
+
+void paz::RenderGraph::keep(std::size_t target)
+{
+    if(target >= _data->_targets.size())
+    {
+        throw std::out_of_range("Render graph target " + std::to_string(target)
+            + " does not exist.");
+    }
+    _data->_targets[target]._keep = true;
+    _data->_compiled = false;
+}
+
+void paz::RenderGraph::execute()
+{
+    if(!_data->_compiled)
+    {
+        _data->compile();
+    }
+    for(std::size_t i = 0; i < _data->_order.size(); ++i)
+    {
+        const auto& p = _data->_passes[_data->_order[i]];
+        auto& pass = _data->_renderPasses[i];
+        pass.begin(p._colorLoadActions, p._depthLoadAction);
+        for(const auto& n : p._reads)
+        {
+            pass.read(n.first, _data->_physical[_data->_physicalIdx[n.second]]);
+        }
+        if(p._draw)
+        {
+            p._draw(pass);
+        }
+        pass.end();
+    }
+}
+
+paz::Texture paz::RenderGraph::target(std::size_t target)
+{
+    if(target >= _data->_targets.size())
+    {
+        throw std::out_of_range("Render graph target " + std::to_string(target)
+            + " does not exist.");
+    }
+    if(!_data->_compiled)
+    {
+        _data->compile();
+    }
+    if(_data->_physicalIdx[target] == Never)
+    {
+        throw std::logic_error("Render graph target " + std::to_string(target) +
+            " is not used by any pass.");
+    }
+    return _data->_physical[_data->_physicalIdx[target]];
+}
@@ -0,0 +1,11 @@
+#include "PAZ_Graphics"
+#include "internal_data.hpp"
+
+void paz::RenderPass::setName(const std::string& name)
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Render pass has not been initialized.");
+    }
+    _data->_name = name;
+}
@@ -23,13 +23,18 @@ static constexpr float Clear[] = {0.f, 0.f, 0.f, 0.f};
 static constexpr float Black[] = {0.f, 0.f, 0.f, 1.f};
 static constexpr float White[] = {1.f, 1.f, 1.f, 1.f};
 
-static int _nextSlot;
-static bool _depthTestEnabled;
-static bool _depthMaskEnabled = true;
-static bool _blendEnabled;
-static bool _depthCalledThisPass;
-static bool _cullCalledThisPass;
-static const paz::RenderPass* _pass;
+static PAZ_CONTEXT_LOCAL int _nextSlot;
+static PAZ_CONTEXT_LOCAL bool _depthTestEnabled;
+static PAZ_CONTEXT_LOCAL bool _depthMaskEnabled = true;
+static PAZ_CONTEXT_LOCAL bool _blendEnabled;
+static PAZ_CONTEXT_LOCAL bool _depthCalledThisPass;
+static PAZ_CONTEXT_LOCAL bool _cullCalledThisPass;
+static PAZ_CONTEXT_LOCAL const paz::RenderPass* _pass;
+static PAZ_CONTEXT_LOCAL bool _debugGroupPushed;
+// Holds the query in progress even if its `OcclusionQuery` is destroyed.
+static PAZ_CONTEXT_LOCAL std::shared_ptr<void> _query;
+static PAZ_CONTEXT_LOCAL bool _conditional;
+static PAZ_CONTEXT_LOCAL bool _conditionalRender;
 
 static GLenum primitive_type(paz::PrimitiveType t)
 {
@@ -177,6 +182,8 @@ paz::RenderPass::RenderPass(const Framebuffer& fbo, const VertexFunction& vert,
 {
     initialize();
 
+    PAZ_PROFILE("RenderPass::RenderPass");
+
     _data = std::make_shared<Data>();
 
     _data->_fbo = fbo._data;
@@ -204,6 +211,7 @@ paz::RenderPass::RenderPass(const VertexFunction& vert, const FragmentFunction&
 void paz::RenderPass::begin(const std::vector<LoadAction>& colorLoadActions,
     LoadAction depthLoadAction)
 {
+    PAZ_PROFILE("RenderPass::begin");
     if(_pass)
     {
         throw std::logic_error("Previous render pass was not ended.");
@@ -217,6 +225,13 @@ void paz::RenderPass::begin(const std::vector<LoadAction>& colorLoadActions,
 
     begin_frame();
     glGetError();
+    begin_pass_timing(_data->_name);
+    if(!_data->_name.empty() && ogl_ext_KHR_debug == ogl_LOAD_SUCCEEDED)
+    {
+        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, _data->_name.
+            c_str());
+        _debugGroupPushed = true;
+    }
     _depthCalledThisPass = false;
     _cullCalledThisPass = false;
     _nextSlot = 0;
@@ -370,6 +385,7 @@ void paz::RenderPass::begin(const std::vector<LoadAction>& colorLoadActions,
         throw std::runtime_error("Shader is not initialized.");
     }
     glUseProgram(_data->_shader._id);
+    ++frame_stats().programBinds;
 }
 
 void paz::RenderPass::depth(DepthTestMode mode)
@@ -449,14 +465,27 @@ void paz::RenderPass::depth(DepthTestMode mode)
 
 void paz::RenderPass::end()
 {
+    PAZ_PROFILE("RenderPass::end");
     CHECK_PASS
+    if(_query || _conditional)
+    {
+        throw std::logic_error("Occlusion query or conditional rendering was no"
+            "t ended.");
+    }
+    end_pass_timing();
+    if(_debugGroupPushed)
+    {
+        glPopDebugGroup();
+        _debugGroupPushed = false;
+    }
+    // Mipmaps are regenerated the next time the attachments are read.
     for(auto n : _data->_fbo->_colorAttachments)
     {
-        n->ensureMipmaps();
+        n->_mipmapsDirty = true;
     }
     if(_data->_fbo->_depthStencilAttachment)
     {
-        _data->_fbo->_depthStencilAttachment->ensureMipmaps();
+        _data->_fbo->_depthStencilAttachment->_mipmapsDirty = true;
     }
     const GLenum error = glGetError();
     if(error != GL_NO_ERROR)
@@ -495,7 +524,26 @@ void paz::RenderPass::read(const std::string& name, const Texture& tex)
 {
     CHECK_PASS
     glActiveTexture(GL_TEXTURE0 + _nextSlot);
+    if(tex._data->_mipmapsDirty)
+    {
+        tex._data->ensureMipmaps();
+    }
     glBindTexture(GL_TEXTURE_2D, tex._data->_id);
+    ++frame_stats().textureBinds;
+    uniform(name, _nextSlot);
+    ++_nextSlot;
+}
+
+void paz::RenderPass::read(const std::string& name, const TextureArray& tex)
+{
+    CHECK_PASS
+    glActiveTexture(GL_TEXTURE0 + _nextSlot);
+    if(tex._data->_mipmapsDirty)
+    {
+        tex._data->ensureMipmaps();
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, tex._data->_id);
+    ++frame_stats().textureBinds;
     uniform(name, _nextSlot);
     ++_nextSlot;
 }
@@ -503,6 +551,7 @@ void paz::RenderPass::read(const std::string& name, const Texture& tex)
 void paz::RenderPass::uniform(const std::string& name, int x)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     CHECK_UNIFORM
     glUniform1i(std::get<0>(_data->_shader._uniformIds.at(name)), x);
 }
@@ -510,6 +559,7 @@ void paz::RenderPass::uniform(const std::string& name, int x)
 void paz::RenderPass::uniform(const std::string& name, int x, int y)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     CHECK_UNIFORM
     glUniform2i(std::get<0>(_data->_shader._uniformIds.at(name)), x, y);
 }
@@ -517,6 +567,7 @@ void paz::RenderPass::uniform(const std::string& name, int x, int y)
 void paz::RenderPass::uniform(const std::string& name, int x, int y, int z)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     CHECK_UNIFORM
     glUniform3i(std::get<0>(_data->_shader._uniformIds.at(name)), x, y, z);
 }
@@ -525,6 +576,7 @@ void paz::RenderPass::uniform(const std::string& name, int x, int y, int z, int
     w)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     CHECK_UNIFORM
     glUniform4i(std::get<0>(_data->_shader._uniformIds.at(name)), x, y, z, w);
 }
@@ -533,6 +585,7 @@ void paz::RenderPass::uniform(const std::string& name, const int* x, std::size_t
     size)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     CHECK_UNIFORM
     if(sizeof(int)*size > 4*1024) //TEMP - `set*Bytes` limitation
     {
@@ -567,6 +620,7 @@ void paz::RenderPass::uniform(const std::string& name, const int* x, std::size_t
 void paz::RenderPass::uniform(const std::string& name, unsigned int x)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     CHECK_UNIFORM
     glUniform1ui(std::get<0>(_data->_shader._uniformIds.at(name)), x);
 }
@@ -575,6 +629,7 @@ void paz::RenderPass::uniform(const std::string& name, unsigned int x, unsigned
     int y)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     CHECK_UNIFORM
     glUniform2ui(std::get<0>(_data->_shader._uniformIds.at(name)), x, y);
 }
@@ -583,6 +638,7 @@ void paz::RenderPass::uniform(const std::string& name, unsigned int x, unsigned
     int y, unsigned int z)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     CHECK_UNIFORM
     glUniform3ui(std::get<0>(_data->_shader._uniformIds.at(name)), x, y, z);
 }
@@ -591,6 +647,7 @@ void paz::RenderPass::uniform(const std::string& name, unsigned int x, unsigned
     int y, unsigned int z, unsigned int w)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     CHECK_UNIFORM
     glUniform4ui(std::get<0>(_data->_shader._uniformIds.at(name)), x, y, z, w);
 }
@@ -599,6 +656,7 @@ void paz::RenderPass::uniform(const std::string& name, const unsigned int* x,
     std::size_t size)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     CHECK_UNIFORM
     if(sizeof(unsigned int)*size > 4*1024) //TEMP - `set*Bytes` limitation
     {
@@ -633,6 +691,7 @@ void paz::RenderPass::uniform(const std::string& name, const unsigned int* x,
 void paz::RenderPass::uniform(const std::string& name, float x)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     CHECK_UNIFORM
     glUniform1f(std::get<0>(_data->_shader._uniformIds.at(name)), x);
 }
@@ -640,6 +699,7 @@ void paz::RenderPass::uniform(const std::string& name, float x)
 void paz::RenderPass::uniform(const std::string& name, float x, float y)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     CHECK_UNIFORM
     glUniform2f(std::get<0>(_data->_shader._uniformIds.at(name)), x, y);
 }
@@ -648,6 +708,7 @@ void paz::RenderPass::uniform(const std::string& name, float x, float y, float
     z)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     CHECK_UNIFORM
     glUniform3f(std::get<0>(_data->_shader._uniformIds.at(name)), x, y, z);
 }
@@ -656,6 +717,7 @@ void paz::RenderPass::uniform(const std::string& name, float x, float y, float
     z, float w)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     CHECK_UNIFORM
     glUniform4f(std::get<0>(_data->_shader._uniformIds.at(name)), x, y, z, w);
 }
@@ -664,6 +726,7 @@ void paz::RenderPass::uniform(const std::string& name, const float* x, std::
     size_t size)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     CHECK_UNIFORM
     if(sizeof(float)*size > 4*1024) //TEMP - `set*Bytes` limitation
     {
@@ -709,6 +772,7 @@ void paz::RenderPass::uniform(const std::string& name, const float* x, std::
 
 void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices)
 {
+    PAZ_PROFILE("RenderPass::draw");
     CHECK_PASS
     check_attributes(vertices._data->_types, _data->_shader._attribTypes);
     if(!vertices._data->_numVertices)
@@ -727,12 +791,14 @@ void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices)
     }
 
     glBindVertexArray(vertices._data->_id);
+    count_draw(type, vertices._data->_numVertices, 1);
     glDrawArrays(primitive_type(type), 0, vertices._data->_numVertices);
 }
 
 void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
     const IndexBuffer& indices)
 {
+    PAZ_PROFILE("RenderPass::draw");
     CHECK_PASS
     check_attributes(vertices._data->_types, _data->_shader._attribTypes);
     if(!vertices._data->_numVertices || !indices._data->_numIndices)
@@ -752,6 +818,7 @@ void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
 
     glBindVertexArray(vertices._data->_id);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices._data->_id);
+    count_draw(type, indices._data->_numIndices, 1);
     glDrawElements(primitive_type(type), indices._data->_numIndices,
         GL_UNSIGNED_INT, nullptr);
 }
@@ -759,10 +826,11 @@ void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
 void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
     const InstanceBuffer& instances)
 {
+    PAZ_PROFILE("RenderPass::draw");
     CHECK_PASS
     check_attributes(vertices._data->_types, instances._data->_types, _data->
         _shader._attribTypes);
-    if(!vertices._data->_numVertices || !instances._data->_numInstances)
+    if(!vertices._data->_numVertices || !instances._data->numDrawn())
     {
         return;
     }
@@ -823,18 +891,21 @@ void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
         }
         glVertexAttribDivisor(idx, 1);
     }
+    count_draw(type, vertices._data->_numVertices, instances._data->
+        numDrawn());
     glDrawArraysInstanced(primitive_type(type), 0, vertices._data->_numVertices,
-        instances._data->_numInstances);
+        instances._data->numDrawn());
     glDeleteVertexArrays(1, &vaoId);
 }
 
 void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
     const InstanceBuffer& instances, const IndexBuffer& indices)
 {
+    PAZ_PROFILE("RenderPass::draw");
     CHECK_PASS
     check_attributes(vertices._data->_types, instances._data->_types, _data->
         _shader._attribTypes);
-    if(!vertices._data->_numVertices || !instances._data->_numInstances ||
+    if(!vertices._data->_numVertices || !instances._data->numDrawn() ||
         !indices._data->_numIndices)
     {
         return;
@@ -897,11 +968,90 @@ void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
         glVertexAttribDivisor(idx, 1);
     }
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices._data->_id);
+    count_draw(type, indices._data->_numIndices, instances._data->
+        numDrawn());
     glDrawElementsInstanced(primitive_type(type), indices._data->_numIndices,
-        GL_UNSIGNED_INT, nullptr, instances._data->_numInstances);
+        GL_UNSIGNED_INT, nullptr, instances._data->numDrawn());
     glDeleteVertexArrays(1, &vaoId);
 }
 
+void paz::RenderPass::beginQuery(OcclusionQuery& query)
+{
+    CHECK_PASS
+    if(_query)
+    {
+        throw std::logic_error("Occlusion queries cannot be nested.");
+    }
+    query._data->poll();
+    // The latest issue may be in use by conditional rendering.
+    auto& spare = query._data->_free;
+    if(spare.size() > 1 && spare.back() == query._data->_latest)
+    {
+        std::swap(spare.front(), spare.back());
+    }
+    GLuint id;
+    if(spare.empty() || spare.back() == query._data->_latest)
+    {
+        glGenQueries(1, &id);
+    }
+    else
+    {
+        id = spare.back();
+        spare.pop_back();
+    }
+    glBeginQuery(GL_ANY_SAMPLES_PASSED, id);
+    query._data->_pending.push_back(id);
+    query._data->_latest = id;
+    query._data->_active = true;
+    _query = query._data;
+}
+
+void paz::RenderPass::endQuery()
+{
+    CHECK_PASS
+    if(!_query)
+    {
+        throw std::logic_error("No occlusion query is in progress.");
+    }
+    glEndQuery(GL_ANY_SAMPLES_PASSED);
+    static_cast<OcclusionQuery::Data*>(_query.get())->_active = false;
+    _query.reset();
+}
+
+void paz::RenderPass::beginConditional(const OcclusionQuery& query)
+{
+    CHECK_PASS
+    if(_conditional)
+    {
+        throw std::logic_error("Conditional rendering cannot be nested.");
+    }
+    if(query._data->_active)
+    {
+        throw std::logic_error("Cannot render conditionally on an occlusion que"
+            "ry in progress.");
+    }
+    _conditional = true;
+    _conditionalRender = query._data->_latest;
+    if(_conditionalRender)
+    {
+        glBeginConditionalRender(query._data->_latest, GL_QUERY_NO_WAIT);
+    }
+}
+
+void paz::RenderPass::endConditional()
+{
+    CHECK_PASS
+    if(!_conditional)
+    {
+        throw std::logic_error("Conditional rendering is not in progress.");
+    }
+    if(_conditionalRender)
+    {
+        glEndConditionalRender();
+    }
+    _conditional = false;
+}
+
 paz::Framebuffer paz::RenderPass::framebuffer() const
 {
     Framebuffer temp;
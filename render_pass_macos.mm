@@ -10,6 +10,7 @@
 #include "common.hpp"
 #include "util_macos.hh"
 #import <MetalKit/MetalKit.h>
+#include <cstring>
 
 #define VIEW_CONTROLLER static_cast<ViewController*>([[static_cast<\
     AppDelegate*>([NSApp delegate]) window] contentViewController])
@@ -40,7 +41,17 @@ static_assert(sizeof(unsigned int) == 2 || sizeof(unsigned int) == 4, "Indices "
 static constexpr MTLIndexType IndexType = (sizeof(unsigned int) == 2 ?
     MTLIndexTypeUInt16 : MTLIndexTypeUInt32);
 
+static constexpr std::size_t MaxQueries = 256;
+
 static const paz::RenderPass* _pass;
+static std::vector<std::shared_ptr<void>> _visibilityPool;
+static std::shared_ptr<void> _visibilityResults;
+static id<MTLCommandBuffer> _visibilityCommandBuffer = nil;
+static std::size_t _numQueries;
+// Holds the query in progress even if its `OcclusionQuery` is destroyed.
+static std::shared_ptr<void> _query;
+static bool _conditional;
+static bool _skipDraws;
 
 static MTLPrimitiveType primitive_type(paz::PrimitiveType t)
 {
@@ -142,6 +153,79 @@ static id<MTLRenderPipelineState> create(const void* descriptor, std::
     return pipelineState;
 }
 
+static void bind_texture(id<MTLRenderCommandEncoder> encoder, const std::
+    unordered_map<std::string, int>& vertexArgs, const std::unordered_map<std::
+    string, int>& fragmentArgs, const std::string& name, id<MTLTexture> texture,
+    id<MTLSamplerState> sampler)
+{
+    const std::string textureName = name + "Texture";
+    if(vertexArgs.count(textureName))
+    {
+        [encoder setVertexTexture:texture atIndex:vertexArgs.at(textureName)];
+        const std::string samplerName = name + "Sampler";
+        if(!vertexArgs.count(samplerName))
+        {
+            throw std::logic_error("Vertex function takes texture as argument b"
+                "ut not its sampler.");
+        }
+        [encoder setVertexSamplerState:sampler atIndex:vertexArgs.at(
+            samplerName)];
+    }
+    if(fragmentArgs.count(textureName))
+    {
+        [encoder setFragmentTexture:texture atIndex:fragmentArgs.at(
+            textureName)];
+        const std::string samplerName = name + "Sampler";
+        if(!fragmentArgs.count(samplerName))
+        {
+            throw std::logic_error("Fragment function takes texture as argument"
+                " but not its sampler.");
+        }
+        [encoder setFragmentSamplerState:sampler atIndex:fragmentArgs.at(
+            samplerName)];
+    }
+}
+
+// Each command buffer gets its own zeroed results, reused once no query refers
+// to them.
+static void set_visibility_results(MTLRenderPassDescriptor* descriptor)
+{
+    if([RENDERER commandBuffer] != _visibilityCommandBuffer)
+    {
+        [_visibilityCommandBuffer release];
+        _visibilityCommandBuffer = [[RENDERER commandBuffer] retain];
+        _visibilityResults = nullptr;
+        for(const auto& n : _visibilityPool)
+        {
+            if(n.use_count() == 1)
+            {
+                _visibilityResults = n;
+                break;
+            }
+        }
+        if(!_visibilityResults)
+        {
+            id<MTLBuffer> buffer = [DEVICE newBufferWithLength:MaxQueries*sizeof(
+                std::uint64_t) options:MTLResourceStorageModeShared];
+            if(!buffer)
+            {
+                throw std::runtime_error("Failed to create visibility result b"
+                    "uffer.");
+            }
+            _visibilityResults = std::shared_ptr<void>(buffer, [](void* p)
+            {
+                [static_cast<id<MTLBuffer>>(p) release];
+            });
+            _visibilityPool.push_back(_visibilityResults);
+        }
+        std::memset([static_cast<id<MTLBuffer>>(_visibilityResults.get())
+            contents], 0, MaxQueries*sizeof(std::uint64_t));
+        _numQueries = 0;
+    }
+    [descriptor setVisibilityResultBuffer:static_cast<id<MTLBuffer>>(
+        _visibilityResults.get())];
+}
+
 paz::RenderPass::Data::~Data()
 {
     if(_pipelineState)
@@ -160,6 +244,8 @@ paz::RenderPass::RenderPass(const Framebuffer& fbo, const VertexFunction& vert,
 {
     initialize();
 
+    PAZ_PROFILE("RenderPass::RenderPass");
+
     _data = std::make_shared<Data>();
 
     _data->_vert = vert._data;
@@ -271,6 +357,7 @@ paz::RenderPass::RenderPass(const VertexFunction& vert, const FragmentFunction&
 void paz::RenderPass::begin(const std::vector<LoadAction>& colorLoadActions,
     LoadAction depthLoadAction)
 {
+    PAZ_PROFILE("RenderPass::begin");
     if(_pass)
     {
         throw std::logic_error("Previous render pass was not ended.");
@@ -352,13 +439,24 @@ void paz::RenderPass::begin(const std::vector<LoadAction>& colorLoadActions,
             MTLStoreActionStore];
     }
 
+    set_visibility_results(renderPassDescriptor);
+    begin_pass_timing(_data->_name, renderPassDescriptor);
     _data->_renderEncoder = [[RENDERER commandBuffer]
         renderCommandEncoderWithDescriptor:renderPassDescriptor];
 
     [renderPassDescriptor release];
 
+    // Graphics debuggers show encoder labels, which match the GPU timings.
+    if(!_data->_name.empty())
+    {
+        [static_cast<id<MTLRenderCommandEncoder>>(_data->_renderEncoder)
+            setLabel:[NSString stringWithUTF8String:_data->_name.c_str()]];
+    }
+
+    // Grow-only targets are drawn to their bottom-left sub-rectangle.
     [static_cast<id<MTLRenderCommandEncoder>>(_data->_renderEncoder)
-        setViewport:{0., 0., static_cast<double>(_data->_fbo->width()),
+        setViewport:{0., static_cast<double>(_data->_fbo->allocatedHeight() -
+        _data->_fbo->height()), static_cast<double>(_data->_fbo->width()),
         static_cast<double>(_data->_fbo->height()), 0., 1.}];
 
     // Flip winding order to CCW to match OpenGL standard.
@@ -368,6 +466,7 @@ void paz::RenderPass::begin(const std::vector<LoadAction>& colorLoadActions,
     [static_cast<id<MTLRenderCommandEncoder>>(_data->_renderEncoder)
         setRenderPipelineState:static_cast<id<MTLRenderPipelineState>>(_data->
         _pipelineState)];
+    ++frame_stats().programBinds;
 }
 
 void paz::RenderPass::depth(DepthTestMode mode)
@@ -379,10 +478,17 @@ void paz::RenderPass::depth(DepthTestMode mode)
 
 void paz::RenderPass::end()
 {
+    PAZ_PROFILE("RenderPass::end");
     CHECK_PASS
+    if(_query || _conditional)
+    {
+        throw std::logic_error("Occlusion query or conditional rendering was no"
+            "t ended.");
+    }
     [static_cast<id<MTLRenderCommandEncoder>>(_data->_renderEncoder)
         endEncoding];
     _data->_renderEncoder = nullptr;
+    // Blits cannot be encoded during a pass, so mipmaps are not deferred.
     for(auto n : _data->_fbo->_colorAttachments)
     {
         n->ensureMipmaps();
@@ -421,38 +527,21 @@ void paz::RenderPass::cull(CullMode mode)
 void paz::RenderPass::read(const std::string& name, const Texture& tex)
 {
     CHECK_PASS
-    const std::string textureName = name + "Texture";
-    if(_data->_vertexArgs.count(textureName))
-    {
-        [static_cast<id<MTLRenderCommandEncoder>>(_data->_renderEncoder)
-            setVertexTexture:static_cast<id<MTLTexture>>(tex._data->_texture)
-            atIndex:_data->_vertexArgs.at(textureName)];
-        const std::string samplerName = name + "Sampler";
-        if(!_data->_vertexArgs.count(samplerName))
-        {
-            throw std::logic_error("Vertex function takes texture as argument b"
-                "ut not its sampler.");
-        }
-        [static_cast<id<MTLRenderCommandEncoder>>(_data->_renderEncoder)
-            setVertexSamplerState:static_cast<id<MTLSamplerState>>(tex._data->
-            _sampler) atIndex:_data->_vertexArgs.at(samplerName)];
-    }
-    if(_data->_fragmentArgs.count(textureName))
-    {
-        [static_cast<id<MTLRenderCommandEncoder>>(_data->_renderEncoder)
-            setFragmentTexture:static_cast<id<MTLTexture>>(tex._data->_texture)
-            atIndex:_data->_fragmentArgs.at(textureName)];
-        const std::string samplerName = name + "Sampler";
-        if(!_data->_fragmentArgs.count(samplerName))
-        {
-            throw std::logic_error("Fragment function takes texture as argument"
-                " but not its sampler.");
-        }
+    bind_texture(static_cast<id<MTLRenderCommandEncoder>>(_data->
+        _renderEncoder), _data->_vertexArgs, _data->_fragmentArgs, name,
+        static_cast<id<MTLTexture>>(tex._data->_texture), static_cast<id<
+        MTLSamplerState>>(tex._data->_sampler));
+    ++frame_stats().textureBinds;
+}
 
-        [static_cast<id<MTLRenderCommandEncoder>>(_data->_renderEncoder)
-            setFragmentSamplerState:static_cast<id<MTLSamplerState>>(tex._data->
-            _sampler) atIndex:_data->_fragmentArgs.at(samplerName)];
-    }
+void paz::RenderPass::read(const std::string& name, const TextureArray& tex)
+{
+    CHECK_PASS
+    bind_texture(static_cast<id<MTLRenderCommandEncoder>>(_data->
+        _renderEncoder), _data->_vertexArgs, _data->_fragmentArgs, name,
+        static_cast<id<MTLTexture>>(tex._data->_texture), static_cast<id<
+        MTLSamplerState>>(tex._data->_sampler));
+    ++frame_stats().textureBinds;
 }
 
 void paz::RenderPass::uniform(const std::string& name, int x)
@@ -487,6 +576,7 @@ void paz::RenderPass::uniform(const std::string& name, const int* x, std::size_t
     size)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     const auto l = sizeof(int)*size;
     if(l > 4*1024) //TEMP - `set*Bytes` limitation
     {
@@ -538,6 +628,7 @@ void paz::RenderPass::uniform(const std::string& name, const unsigned int* x,
     std::size_t size)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     const auto l = sizeof(unsigned int)*size;
     if(l > 4*1024) //TEMP - `set*Bytes` limitation
     {
@@ -588,6 +679,7 @@ void paz::RenderPass::uniform(const std::string& name, const float* x, std::
     size_t size)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     const auto l = sizeof(float)*size;
     if(l > 4*1024) //TEMP - `set*Bytes` limitation
     {
@@ -607,7 +699,12 @@ void paz::RenderPass::uniform(const std::string& name, const float* x, std::
 
 void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices)
 {
+    PAZ_PROFILE("RenderPass::draw");
     CHECK_PASS
+    if(_skipDraws)
+    {
+        return;
+    }
     check_attributes(vertices._data->_buffers, _data->_vertexAttributeStrides,
         vertices._data->_numVertices);
     if(!vertices._data->_numVertices)
@@ -622,6 +719,7 @@ void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices)
             i]) offset:0 atIndex:i];
     }
 
+    count_draw(type, vertices._data->_numVertices, 1);
     [static_cast<id<MTLRenderCommandEncoder>>(_data->_renderEncoder)
         drawPrimitives:primitive_type(type) vertexStart:0 vertexCount:vertices.
         _data->_numVertices];
@@ -630,7 +728,12 @@ void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices)
 void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
     const IndexBuffer& indices)
 {
+    PAZ_PROFILE("RenderPass::draw");
     CHECK_PASS
+    if(_skipDraws)
+    {
+        return;
+    }
     check_attributes(vertices._data->_buffers, _data->_vertexAttributeStrides,
         vertices._data->_numVertices);
     if(!vertices._data->_numVertices || !indices._data->_numIndices)
@@ -645,6 +748,7 @@ void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
             i]) offset:0 atIndex:i];
     }
 
+    count_draw(type, indices._data->_numIndices, 1);
     [static_cast<id<MTLRenderCommandEncoder>>(_data->_renderEncoder)
         drawIndexedPrimitives:primitive_type(type) indexCount:indices._data->
         _numIndices indexType:IndexType indexBuffer:static_cast<id<MTLBuffer>>(
@@ -654,11 +758,16 @@ void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
 void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
     const InstanceBuffer& instances)
 {
+    PAZ_PROFILE("RenderPass::draw");
     CHECK_PASS
+    if(_skipDraws)
+    {
+        return;
+    }
 //    check_attributes(vertices._data->_buffers, instances._data->_buffers,
 //        _data->_vertexAttributeStrides, vertices._data->_numVertices,
 //        instances._data->_numVertices);
-    if(!vertices._data->_numVertices || !instances._data->_numInstances)
+    if(!vertices._data->_numVertices || !instances._data->numDrawn())
     {
         return;
     }
@@ -677,19 +786,26 @@ void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
             _buffers[i]) offset:0 atIndex:vertices._data->_buffers.size() + i];
     }
 
+    count_draw(type, vertices._data->_numVertices, instances._data->
+        numDrawn());
     [static_cast<id<MTLRenderCommandEncoder>>(_data->_renderEncoder)
         drawPrimitives:primitive_type(type) vertexStart:0 vertexCount:vertices.
-        _data->_numVertices instanceCount:instances._data->_numInstances];
+        _data->_numVertices instanceCount:instances._data->numDrawn()];
 }
 
 void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
     const InstanceBuffer& instances, const IndexBuffer& indices)
 {
+    PAZ_PROFILE("RenderPass::draw");
     CHECK_PASS
+    if(_skipDraws)
+    {
+        return;
+    }
 //    check_attributes(vertices._data->_buffers, instances._data->_buffers,
 //        _data->_vertexAttributeStrides, vertices._data->_numVertices,
 //        instances._data->_numVertices);
-    if(!vertices._data->_numVertices || !instances._data->_numInstances ||
+    if(!vertices._data->_numVertices || !instances._data->numDrawn() ||
         !indices._data->_numIndices)
     {
         return;
@@ -709,11 +825,74 @@ void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
             _buffers[i]) offset:0 atIndex:vertices._data->_buffers.size() + i];
     }
 
+    count_draw(type, indices._data->_numIndices, instances._data->
+        numDrawn());
     [static_cast<id<MTLRenderCommandEncoder>>(_data->_renderEncoder)
         drawIndexedPrimitives:primitive_type(type) indexCount:indices._data->
         _numIndices indexType:IndexType indexBuffer:static_cast<id<MTLBuffer>>(
         indices._data->_data) indexBufferOffset:0 instanceCount:instances.
-        _data->_numInstances];
+        _data->numDrawn()];
+}
+
+void paz::RenderPass::beginQuery(OcclusionQuery& query)
+{
+    CHECK_PASS
+    if(_query)
+    {
+        throw std::logic_error("Occlusion queries cannot be nested.");
+    }
+    if(_numQueries == MaxQueries)
+    {
+        throw std::runtime_error("Too many occlusion queries in one frame.");
+    }
+    query._data->poll();
+    const std::size_t offset = sizeof(std::uint64_t)*_numQueries++;
+    [static_cast<id<MTLRenderCommandEncoder>>(_data->_renderEncoder)
+        setVisibilityResultMode:MTLVisibilityResultModeBoolean offset:offset];
+    query._data->_pending.push_back({_visibilityResults, offset,
+        [_visibilityCommandBuffer retain]});
+    query._data->_active = true;
+    _query = query._data;
+}
+
+void paz::RenderPass::endQuery()
+{
+    CHECK_PASS
+    if(!_query)
+    {
+        throw std::logic_error("No occlusion query is in progress.");
+    }
+    [static_cast<id<MTLRenderCommandEncoder>>(_data->_renderEncoder)
+        setVisibilityResultMode:MTLVisibilityResultModeDisabled offset:0];
+    static_cast<OcclusionQuery::Data*>(_query.get())->_active = false;
+    _query.reset();
+}
+
+void paz::RenderPass::beginConditional(const OcclusionQuery& query)
+{
+    CHECK_PASS
+    if(_conditional)
+    {
+        throw std::logic_error("Conditional rendering cannot be nested.");
+    }
+    if(query._data->_active)
+    {
+        throw std::logic_error("Cannot render conditionally on an occlusion que"
+            "ry in progress.");
+    }
+    _conditional = true;
+    _skipDraws = !query.visible();
+}
+
+void paz::RenderPass::endConditional()
+{
+    CHECK_PASS
+    if(!_conditional)
+    {
+        throw std::logic_error("Conditional rendering is not in progress.");
+    }
+    _conditional = false;
+    _skipDraws = false;
 }
 
 paz::Framebuffer paz::RenderPass::framebuffer() const
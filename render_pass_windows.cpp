@@ -32,6 +32,23 @@ static constexpr float Black[] = {0.f, 0.f, 0.f, 1.f};
 static constexpr float White[] = {1.f, 1.f, 1.f, 1.f};
 
 static const paz::RenderPass* _pass;
+static bool _eventBegun;
+// Holds the query in progress even if its `OcclusionQuery` is destroyed.
+static std::shared_ptr<void> _query;
+static bool _conditional;
+
+// Lets graphics debuggers group commands by pass. Null before D3D11.1.
+static ID3DUserDefinedAnnotation* annotation()
+{
+    static ID3DUserDefinedAnnotation* a = []()
+    {
+        ID3DUserDefinedAnnotation* p = nullptr;
+        paz::d3d_context()->QueryInterface(__uuidof(ID3DUserDefinedAnnotation),
+            reinterpret_cast<void**>(&p));
+        return p;
+    }();
+    return a;
+}
 
 paz::RenderPass::Data::~Data()
 {
@@ -93,6 +110,8 @@ paz::RenderPass::RenderPass(const Framebuffer& fbo, const VertexFunction& vert,
 {
     initialize();
 
+    PAZ_PROFILE("RenderPass::RenderPass");
+
     _data = std::make_shared<Data>();
 
     _data->_vert = vert._data;
@@ -272,6 +291,7 @@ paz::RenderPass::RenderPass(const VertexFunction& vert, const FragmentFunction&
 void paz::RenderPass::begin(const std::vector<LoadAction>& colorLoadActions,
     LoadAction depthLoadAction)
 {
+    PAZ_PROFILE("RenderPass::begin");
     if(_pass)
     {
         throw std::logic_error("Previous render pass was not ended.");
@@ -285,8 +305,15 @@ void paz::RenderPass::begin(const std::vector<LoadAction>& colorLoadActions,
 
     d3d_context()->VSSetShader(_data->_vert->_shader, nullptr, 0);
     d3d_context()->PSSetShader(_data->_frag->_shader, nullptr, 0);
+    ++frame_stats().programBinds;
 
     begin_frame();
+    begin_pass_timing(_data->_name);
+    if(!_data->_name.empty() && annotation())
+    {
+        annotation()->BeginEvent(utf8_to_wstring(_data->_name).c_str());
+        _eventBegun = true;
+    }
     _data->_rasterDescriptor.FillMode = D3D11_FILL_SOLID;
     _data->_rasterDescriptor.CullMode = D3D11_CULL_NONE;
     _data->_rasterDescriptor.FrontCounterClockwise = true;
@@ -364,7 +391,9 @@ void paz::RenderPass::begin(const std::vector<LoadAction>& colorLoadActions,
         }
     }
 
+    // Grow-only targets are drawn to their bottom-left sub-rectangle.
     D3D11_VIEWPORT viewport = {};
+    viewport.TopLeftY = _data->_fbo->allocatedHeight() - _data->_fbo->height();
     viewport.Width = _data->_fbo->width();
     viewport.Height = _data->_fbo->height();
     viewport.MinDepth = 0.f;
@@ -430,8 +459,29 @@ void paz::RenderPass::depth(DepthTestMode mode)
 
 void paz::RenderPass::end()
 {
+    PAZ_PROFILE("RenderPass::end");
     CHECK_PASS
+    if(_query || _conditional)
+    {
+        throw std::logic_error("Occlusion query or conditional rendering was no"
+            "t ended.");
+    }
+    end_pass_timing();
+    if(_eventBegun)
+    {
+        annotation()->EndEvent();
+        _eventBegun = false;
+    }
     d3d_context()->OMSetBlendState(nullptr, nullptr, 0xffffffff);
+    // Mipmaps are regenerated the next time the attachments are read.
+    for(auto n : _data->_fbo->_colorAttachments)
+    {
+        n->_mipmapsDirty = true;
+    }
+    if(_data->_fbo->_depthStencilAttachment)
+    {
+        _data->_fbo->_depthStencilAttachment->_mipmapsDirty = true;
+    }
     _pass = nullptr;
 }
 
@@ -467,10 +517,32 @@ void paz::RenderPass::read(const std::string& name, const Texture& tex)
     CHECK_PASS
     if(_data->_texAndSamplerSlots.count(name + "Texture"))
     {
+        if(tex._data->_mipmapsDirty)
+        {
+            tex._data->ensureMipmaps();
+        }
         d3d_context()->PSSetShaderResources(_data->_texAndSamplerSlots.at(name +
             "Texture"), 1, &tex._data->_resourceView);
         d3d_context()->PSSetSamplers(_data->_texAndSamplerSlots.at(name +
             "Sampler"), 1, &tex._data->_sampler);
+        ++frame_stats().textureBinds;
+    }
+}
+
+void paz::RenderPass::read(const std::string& name, const TextureArray& tex)
+{
+    CHECK_PASS
+    if(_data->_texAndSamplerSlots.count(name + "Texture"))
+    {
+        if(tex._data->_mipmapsDirty)
+        {
+            tex._data->ensureMipmaps();
+        }
+        d3d_context()->PSSetShaderResources(_data->_texAndSamplerSlots.at(name +
+            "Texture"), 1, &tex._data->_resourceView);
+        d3d_context()->PSSetSamplers(_data->_texAndSamplerSlots.at(name +
+            "Sampler"), 1, &tex._data->_sampler);
+        ++frame_stats().textureBinds;
     }
 }
 
@@ -506,6 +578,7 @@ void paz::RenderPass::uniform(const std::string& name, const int* x, std::size_t
     size)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     if(sizeof(int)*size > 4*1024) //TEMP - `set*Bytes` limitation
     {
         throw std::runtime_error("Too many bytes to send without buffer.");
@@ -558,6 +631,7 @@ void paz::RenderPass::uniform(const std::string& name, const unsigned int* x,
     std::size_t size)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     if(sizeof(unsigned int)*size > 4*1024) //TEMP - `set*Bytes` limitation
     {
         throw std::runtime_error("Too many bytes to send without buffer.");
@@ -609,6 +683,7 @@ void paz::RenderPass::uniform(const std::string& name, const float* x, std::
     size_t size)
 {
     CHECK_PASS
+    ++frame_stats().uniformCalls;
     if(sizeof(float)*size > 4*1024) //TEMP - `set*Bytes` limitation
     {
         throw std::runtime_error("Too many bytes to send without buffer.");
@@ -629,6 +704,7 @@ void paz::RenderPass::uniform(const std::string& name, const float* x, std::
 
 void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices)
 {
+    PAZ_PROFILE("RenderPass::draw");
     CHECK_PASS
     if(!vertices._data->_numVertices)
     {
@@ -655,12 +731,14 @@ void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices)
     d3d_context()->IASetVertexBuffers(0, vertices._data->_buffers.size(),
         vertices._data->_buffers.data(), vertices._data->_strides.data(),
         offsets.data());
+    count_draw(type, vertices._data->_numVertices, 1);
     d3d_context()->Draw(vertices._data->_numVertices, 0);
 }
 
 void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
     const IndexBuffer& indices)
 {
+    PAZ_PROFILE("RenderPass::draw");
     CHECK_PASS
     if(!vertices._data->_numVertices || !indices._data->_numIndices)
     {
@@ -689,14 +767,16 @@ void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
         offsets.data());
     d3d_context()->IASetIndexBuffer(indices._data->_buffer,
         DXGI_FORMAT_R32_UINT, 0);
+    count_draw(type, indices._data->_numIndices, 1);
     d3d_context()->DrawIndexed(indices._data->_numIndices, 0, 0);
 }
 
 void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
     const InstanceBuffer& instances)
 {
+    PAZ_PROFILE("RenderPass::draw");
     CHECK_PASS
-    if(!vertices._data->_numVertices || !instances._data->_numInstances)
+    if(!vertices._data->_numVertices || !instances._data->numDrawn())
     {
         return;
     }
@@ -731,15 +811,18 @@ void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
     d3d_context()->IASetVertexBuffers(startSlot, instances._data->_buffers.
         size(), instances._data->_buffers.data(), instances._data->_strides.
         data(), offsets.data());
+    count_draw(type, vertices._data->_numVertices, instances._data->
+        numDrawn());
     d3d_context()->DrawInstanced(vertices._data->_numVertices, instances._data->
-        _numInstances, 0, 0);
+        numDrawn(), 0, 0);
 }
 
 void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
     const InstanceBuffer& instances, const IndexBuffer& indices)
 {
+    PAZ_PROFILE("RenderPass::draw");
     CHECK_PASS
-    if(!vertices._data->_numVertices || !instances._data->_numInstances ||
+    if(!vertices._data->_numVertices || !instances._data->numDrawn() ||
         !indices._data->_numIndices)
     {
         return;
@@ -777,8 +860,88 @@ void paz::RenderPass::draw(PrimitiveType type, const VertexBuffer& vertices,
         data(), offsets.data());
     d3d_context()->IASetIndexBuffer(indices._data->_buffer,
         DXGI_FORMAT_R32_UINT, 0);
+    count_draw(type, indices._data->_numIndices, instances._data->
+        numDrawn());
     d3d_context()->DrawIndexedInstanced(indices._data->_numIndices, instances.
-        _data->_numInstances, 0, 0, 0);
+        _data->numDrawn(), 0, 0, 0);
+}
+
+void paz::RenderPass::beginQuery(OcclusionQuery& query)
+{
+    CHECK_PASS
+    if(_query)
+    {
+        throw std::logic_error("Occlusion queries cannot be nested.");
+    }
+    query._data->poll();
+    // The latest issue may be in use by conditional rendering.
+    auto& spare = query._data->_free;
+    if(spare.size() > 1 && spare.back() == query._data->_latest)
+    {
+        std::swap(spare.front(), spare.back());
+    }
+    ID3D11Predicate* predicate;
+    if(spare.empty() || spare.back() == query._data->_latest)
+    {
+        D3D11_QUERY_DESC descriptor = {};
+        descriptor.Query = D3D11_QUERY_OCCLUSION_PREDICATE;
+        const auto hr = d3d_device()->CreatePredicate(&descriptor, &predicate);
+        if(hr)
+        {
+            throw std::runtime_error("Failed to create occlusion predicate (" +
+                format_hresult(hr) + ").");
+        }
+    }
+    else
+    {
+        predicate = spare.back();
+        spare.pop_back();
+    }
+    d3d_context()->Begin(predicate);
+    query._data->_pending.push_back(predicate);
+    query._data->_latest = predicate;
+    query._data->_active = true;
+    _query = query._data;
+}
+
+void paz::RenderPass::endQuery()
+{
+    CHECK_PASS
+    if(!_query)
+    {
+        throw std::logic_error("No occlusion query is in progress.");
+    }
+    auto* data = static_cast<OcclusionQuery::Data*>(_query.get());
+    d3d_context()->End(data->_latest);
+    data->_active = false;
+    _query.reset();
+}
+
+void paz::RenderPass::beginConditional(const OcclusionQuery& query)
+{
+    CHECK_PASS
+    if(_conditional)
+    {
+        throw std::logic_error("Conditional rendering cannot be nested.");
+    }
+    if(query._data->_active)
+    {
+        throw std::logic_error("Cannot render conditionally on an occlusion que"
+            "ry in progress.");
+    }
+    _conditional = true;
+    d3d_context()->SetPredication(query._data->_latest, FALSE);
+}
+
+void paz::RenderPass::endConditional()
+{
+    CHECK_PASS
+    if(!_conditional)
+    {
+        throw std::logic_error("Conditional rendering is not in progress.");
+    }
+    d3d_context()->SetPredication(nullptr, FALSE);
+    _conditional = false;
 }
 
 paz::Framebuffer paz::RenderPass::framebuffer() const
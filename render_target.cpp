@@ -1,6 +1,70 @@
 #include "PAZ_Graphics"
 #include "common.hpp"
 #include "internal_data.hpp"
+#include <algorithm>
+
+static constexpr std::uint64_t MaxIdleFrames = 8;
+
+namespace
+{
+    struct TransientKey
+    {
+        paz::TextureFormat format;
+        double scale;
+        int width;
+        int height;
+        paz::MinMagFilter minFilter;
+        paz::MinMagFilter magFilter;
+        paz::MipmapFilter mipFilter;
+        paz::WrapMode wrapS;
+        paz::WrapMode wrapT;
+
+        bool operator==(const TransientKey& k) const
+        {
+            return format == k.format && scale == k.scale && width == k.width &&
+                height == k.height && minFilter == k.minFilter && magFilter ==
+                k.magFilter && mipFilter == k.mipFilter && wrapS == k.wrapS &&
+                wrapT == k.wrapT;
+        }
+    };
+
+    struct TransientTarget
+    {
+        TransientKey key;
+        paz::RenderTarget target;
+        bool inUse;
+        std::uint64_t lastUsed;
+    };
+}
+
+static PAZ_CONTEXT_LOCAL std::uint64_t _frame;
+
+// Constructed after `paz::Initializer` so that pooled targets are destroyed
+// before it.
+static std::vector<TransientTarget>& transient_targets()
+{
+    static PAZ_CONTEXT_LOCAL std::vector<TransientTarget> targets;
+    return targets;
+}
+
+template<typename F>
+static paz::RenderTarget acquire_transient(const TransientKey& key, F&& create)
+{
+    paz::initialize();
+
+    auto& targets = transient_targets();
+    for(auto& n : targets)
+    {
+        if(!n.inUse && n.key == key)
+        {
+            n.inUse = true;
+            n.lastUsed = _frame;
+            return n.target;
+        }
+    }
+    targets.push_back({key, create(), true, _frame});
+    return targets.back().target;
+}
 
 paz::RenderTarget::RenderTarget(TextureFormat format, MinMagFilter minFilter,
     MinMagFilter magFilter, MipmapFilter mipFilter, WrapMode wrapS, WrapMode
@@ -31,6 +95,8 @@ paz::RenderTarget::RenderTarget(TextureFormat format, double scale, MinMagFilter
 
     _data->_width = _data->_scale*Window::ViewportWidth();
     _data->_height = _data->_scale*Window::ViewportHeight();
+    _data->_allocWidth = _data->_width;
+    _data->_allocHeight = _data->_height;
 
     _data->init();
 }
@@ -57,3 +123,85 @@ paz::RenderTarget::RenderTarget(TextureFormat format, int width, int height,
 
     _data->init();
 }
+
+bool paz::Texture::Data::updateSize(int width, int height)
+{
+    _width = _scale*width;
+    _height = _scale*height;
+    int allocWidth = _width;
+    int allocHeight = _height;
+    if(initialize().growOnlyTargets && !_exactSize)
+    {
+        allocWidth = std::max(allocWidth, _allocWidth);
+        allocHeight = std::max(allocHeight, _allocHeight);
+    }
+    if(allocWidth == _allocWidth && allocHeight == _allocHeight)
+    {
+        return false;
+    }
+    _allocWidth = allocWidth;
+    _allocHeight = allocHeight;
+    ++frame_stats().texturesResized;
+    return true;
+}
+
+void paz::RenderTarget::setMaxMipLevel(int level)
+{
+    if(_data->_mipFilter == MipmapFilter::None)
+    {
+        throw std::logic_error("Render target does not use mipmaps.");
+    }
+    _data->setMaxMipLevel(level < 0 ? -1 : level);
+}
+
+paz::RenderTarget paz::RenderTarget::AcquireTransient(TextureFormat format,
+    double scale, MinMagFilter minFilter, MinMagFilter magFilter, MipmapFilter
+    mipFilter, WrapMode wrapS, WrapMode wrapT)
+{
+    return acquire_transient({format, scale, 0, 0, minFilter, magFilter,
+        mipFilter, wrapS, wrapT}, [&]()
+    {
+        return RenderTarget(format, scale, minFilter, magFilter, mipFilter,
+            wrapS, wrapT);
+    });
+}
+
+paz::RenderTarget paz::RenderTarget::AcquireTransient(TextureFormat format, int
+    width, int height, MinMagFilter minFilter, MinMagFilter magFilter,
+    MipmapFilter mipFilter, WrapMode wrapS, WrapMode wrapT)
+{
+    return acquire_transient({format, 0., width, height, minFilter, magFilter,
+        mipFilter, wrapS, wrapT}, [&]()
+    {
+        return RenderTarget(format, width, height, minFilter, magFilter,
+            mipFilter, wrapS, wrapT);
+    });
+}
+
+void paz::RenderTarget::ReleaseTransient(const RenderTarget& target)
+{
+    for(auto& n : transient_targets())
+    {
+        if(n.target._data == target._data)
+        {
+            n.inUse = false;
+            return;
+        }
+    }
+    throw std::logic_error("Render target is not transient.");
+}
+
+void paz::release_transients()
+{
+    ++_frame;
+    auto& targets = transient_targets();
+    for(auto& n : targets)
+    {
+        n.inUse = false;
+    }
+    targets.erase(std::remove_if(targets.begin(), targets.end(), [](const
+        TransientTarget& n)
+    {
+        return _frame - n.lastUsed > MaxIdleFrames;
+    }), targets.end());
+}
@@ -10,6 +10,7 @@
 @property(readonly) CGSize viewportSize;
 @property(readonly) CGSize size;
 @property(readonly) id<MTLCommandBuffer> _Nullable commandBuffer;
+@property(readonly) id<MTLCommandQueue> _Nonnull commandQueue;
 @property float gamma;
 @property bool dither;
 - (nonnull instancetype)initWithMetalKitView:(nonnull MTKView*)view;
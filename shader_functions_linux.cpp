@@ -218,6 +218,8 @@ paz::VertexFunction::VertexFunction(const std::string& src)
 {
     initialize();
 
+    PAZ_PROFILE("VertexFunction::VertexFunction");
+
     _data = std::make_shared<Data>();
 
     try
@@ -237,6 +239,8 @@ paz::FragmentFunction::FragmentFunction(const std::string& src)
 {
     initialize();
 
+    PAZ_PROFILE("FragmentFunction::FragmentFunction");
+
     _data = std::make_shared<Data>();
 
     try
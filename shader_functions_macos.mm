@@ -64,6 +64,8 @@ paz::VertexFunction::VertexFunction(const std::string& src)
 {
     initialize();
 
+    PAZ_PROFILE("VertexFunction::VertexFunction");
+
     _data = std::make_shared<Data>();
 
     id<MTLLibrary> lib = create_library(src, true);
@@ -75,6 +77,8 @@ paz::FragmentFunction::FragmentFunction(const std::string& src)
 {
     initialize();
 
+    PAZ_PROFILE("FragmentFunction::FragmentFunction");
+
     _data = std::make_shared<Data>();
 
     id<MTLLibrary> lib = create_library(src, false);
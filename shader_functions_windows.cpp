@@ -75,6 +75,8 @@ paz::VertexFunction::VertexFunction(const std::string& src)
 {
     initialize();
 
+    PAZ_PROFILE("VertexFunction::VertexFunction");
+
     _data = std::make_shared<Data>();
     std::vector<std::tuple<std::string, DataType, int, int>> uniforms;
     const std::string hlsl = vert2hlsl(src, uniforms);
@@ -102,6 +104,8 @@ paz::FragmentFunction::FragmentFunction(const std::string& src)
 {
     initialize();
 
+    PAZ_PROFILE("FragmentFunction::FragmentFunction");
+
     _data = std::make_shared<Data>();
     std::vector<std::tuple<std::string, DataType, int, int>> uniforms;
     const std::string hlsl = frag2hlsl(src, uniforms);
@@ -64,12 +64,30 @@ struct wrap_usampler2D
     Texture2D<uint4> t;
     SamplerState s;
 };
+struct wrap_sampler2DArray
+{
+    Texture2DArray t;
+    SamplerState s;
+};
+struct wrap_isampler2DArray
+{
+    Texture2DArray<int4> t;
+    SamplerState s;
+};
+struct wrap_usampler2DArray
+{
+    Texture2DArray<uint4> t;
+    SamplerState s;
+};
 #define sampler1D wrap_sampler1D
 #define sampler2D wrap_sampler2D
 #define isampler1D wrap_isampler1D
 #define isampler2D wrap_isampler2D
 #define usampler1D wrap_usampler1D
 #define usampler2D wrap_usampler2D
+#define sampler2DArray wrap_sampler2DArray
+#define isampler2DArray wrap_isampler2DArray
+#define usampler2DArray wrap_usampler2DArray
 )===";
 
     // Define our Y-reversed sample functions.
@@ -122,6 +140,30 @@ uint4 textureLod(in wrap_usampler2D tex, in float2 uv, in float lod)
 {
     return tex.t.SampleLevel(tex.s, float2(uv.x, 1. - uv.y), lod);
 }
+float4 sample_texture(in wrap_sampler2DArray tex, in float3 uvw)
+{
+    return tex.t.Sample(tex.s, float3(uvw.x, 1. - uvw.y, uvw.z));
+}
+int4 sample_texture(in wrap_isampler2DArray tex, in float3 uvw)
+{
+    return tex.t.Sample(tex.s, float3(uvw.x, 1. - uvw.y, uvw.z));
+}
+uint4 sample_texture(in wrap_usampler2DArray tex, in float3 uvw)
+{
+    return tex.t.Sample(tex.s, float3(uvw.x, 1. - uvw.y, uvw.z));
+}
+float4 textureLod(in wrap_sampler2DArray tex, in float3 uvw, in float lod)
+{
+    return tex.t.SampleLevel(tex.s, float3(uvw.x, 1. - uvw.y, uvw.z), lod);
+}
+int4 textureLod(in wrap_isampler2DArray tex, in float3 uvw, in float lod)
+{
+    return tex.t.SampleLevel(tex.s, float3(uvw.x, 1. - uvw.y, uvw.z), lod);
+}
+uint4 textureLod(in wrap_usampler2DArray tex, in float3 uvw, in float lod)
+{
+    return tex.t.SampleLevel(tex.s, float3(uvw.x, 1. - uvw.y, uvw.z), lod);
+}
 #define texture sample_texture
 )===";
 
@@ -197,6 +239,24 @@ int2 textureSize(wrap_usampler2D tex, int lod)
     tex.t.GetDimensions(w, h);
     return int2(w, h);
 }
+int3 textureSize(wrap_sampler2DArray tex, int lod)
+{
+    uint w, h, d;
+    tex.t.GetDimensions(w, h, d);
+    return int3(w, h, d);
+}
+int3 textureSize(wrap_isampler2DArray tex, int lod)
+{
+    uint w, h, d;
+    tex.t.GetDimensions(w, h, d);
+    return int3(w, h, d);
+}
+int3 textureSize(wrap_usampler2DArray tex, int lod)
+{
+    uint w, h, d;
+    tex.t.GetDimensions(w, h, d);
+    return int3(w, h, d);
+}
 )===";
 
     // Define reinterpretation functions.
@@ -616,7 +676,7 @@ float4 mod(in float4 x, in float4 y)
             std::string type = dec.substr(0, pos);
             std::string name = dec.substr(pos + 1);
             std::string texType;
-            if(type.back() == 'D')
+            if(std::regex_match(type, std::regex(".*[sS]ampler.*")))
             {
                 if(type == "depthSampler2D")
                 {
@@ -646,6 +706,18 @@ float4 mod(in float4 x, in float4 y)
                 {
                     texType = "Texture2D<uint>";
                 }
+                else if(type == "sampler2DArray")
+                {
+                    texType = "Texture2DArray";
+                }
+                else if(type == "isampler2DArray")
+                {
+                    texType = "Texture2DArray<int>";
+                }
+                else if(type == "usampler2DArray")
+                {
+                    texType = "Texture2DArray<uint>";
+                }
                 else
                 {
                     throw std::runtime_error("Line " + std::to_string(l) + ": U"
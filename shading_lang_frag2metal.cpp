@@ -49,6 +49,12 @@ struct wrap_texture2d
     sampler s;
 };
 template<typename T>
+struct wrap_texture2d_array
+{
+    texture2d_array<T> t;
+    sampler s;
+};
+template<typename T>
 struct wrap_depth2d
 {
     depth2d<T> t;
@@ -60,6 +66,9 @@ struct wrap_depth2d
 #define isampler2D const wrap_texture2d<int>&
 #define usampler1D const wrap_texture1d<uint>&
 #define usampler2D const wrap_texture2d<uint>&
+#define sampler2DArray const wrap_texture2d_array<float>&
+#define isampler2DArray const wrap_texture2d_array<int>&
+#define usampler2DArray const wrap_texture2d_array<uint>&
 #define depthSampler2D const wrap_depth2d<float>&
 )===";
 
@@ -87,6 +96,25 @@ auto textureLod(thread const wrap_texture2d<T>& tex, thread const float2& uv,
 {
     return tex.t.sample(tex.s, float2(uv.x, 1. - uv.y), level(lod));
 }
+template<typename T>
+uint array_layer(thread const wrap_texture2d_array<T>& tex, thread float layer)
+{
+    return min(uint(max(rint(layer), 0.)), tex.t.get_array_size() - 1);
+}
+template<typename T>
+auto texture(thread const wrap_texture2d_array<T>& tex, thread const float3&
+    uvw)
+{
+    return tex.t.sample(tex.s, float2(uvw.x, 1. - uvw.y), array_layer(tex, uvw.
+        z));
+}
+template<typename T>
+auto textureLod(thread const wrap_texture2d_array<T>& tex, thread const float3&
+    uvw, thread float lod)
+{
+    return tex.t.sample(tex.s, float2(uvw.x, 1. - uvw.y), array_layer(tex, uvw.
+        z), level(lod));
+}
 float4 texture(thread const wrap_depth2d<float>& tex, thread const float2& uv)
 {
     return float4(tex.t.sample(tex.s, float2(uv.x, 1. - uv.y)), 0, 0, 1);
@@ -121,6 +149,18 @@ float2 textureQueryLod(thread const wrap_texture2d<T>& tex, thread const float2&
         lambdaPrime);
 }
 template<typename T>
+float2 textureQueryLod(thread const wrap_texture2d_array<T>& tex, thread const
+    float2& uv)
+{
+    const float2 size(tex.t.get_width(), tex.t.get_height());
+    const float2 duvdx = dfdx(uv);
+    const float2 duvdy = dfdy(uv);
+    const float rho = max(length(size*duvdx), length(size*duvdy));
+    const float lambdaPrime = log2(rho);
+    return float2(clamp(lambdaPrime, 0., float(tex.t.get_num_mip_levels())),
+        lambdaPrime);
+}
+template<typename T>
 float2 textureQueryLod(thread const wrap_depth2d<T>& tex, thread const float2&
     uv)
 {
@@ -147,6 +187,12 @@ int2 textureSize(thread const wrap_texture2d<T>& tex, thread int lod)
     return int2(tex.t.get_width(lod), tex.t.get_height(lod));
 }
 template<typename T>
+int3 textureSize(thread const wrap_texture2d_array<T>& tex, thread int lod)
+{
+    return int3(tex.t.get_width(lod), tex.t.get_height(lod), tex.t.
+        get_array_size());
+}
+template<typename T>
 int2 textureSize(thread const wrap_depth2d<T>& tex, thread int lod)
 {
     return int2(tex.t.get_width(lod), tex.t.get_height(lod));
@@ -535,7 +581,7 @@ float4 mod(thread const float4& x, thread const float4& y)
             const std::size_t pos = dec.find_last_of(' ');
             std::string type = dec.substr(0, pos);
             std::string name = dec.substr(pos + 1);
-            if(type.back() == 'D')
+            if(std::regex_match(type, std::regex(".*[sS]ampler.*")))
             {
                 if(type == "sampler1D")
                 {
@@ -561,6 +607,18 @@ float4 mod(thread const float4& x, thread const float4& y)
                 {
                     type = "texture2d<uint>";
                 }
+                else if(type == "sampler2DArray")
+                {
+                    type = "texture2d_array<float>";
+                }
+                else if(type == "isampler2DArray")
+                {
+                    type = "texture2d_array<int>";
+                }
+                else if(type == "usampler2DArray")
+                {
+                    type = "texture2d_array<uint>";
+                }
                 else if(type == "depthSampler2D")
                 {
                     type = "depth2d<float>";
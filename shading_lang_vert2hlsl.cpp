@@ -196,7 +196,7 @@ float4 mod(in float4 x, in float4 y)
                 "ned macros are not supported.");
         }
         if(std::regex_match(line, std::regex(".*\\b(depthS|[iu]?s)ampler[1-4]D"
-            "\\b.*")))
+            "(Array)?\\b.*")))
         {
             throw std::runtime_error("Texture sampling in vertex shaders is not"
                 " supported.");
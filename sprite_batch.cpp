@@ -0,0 +1,363 @@
+#include "PAZ_Graphics"
+#include "common.hpp"
+#include "internal_data.hpp"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+static const std::string VertSrc = 1 + R"===(
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec4 transform [[instance]];
+layout(location = 2) in vec4 rect [[instance]];
+layout(location = 3) in vec4 color [[instance]];
+
+uniform vec2 pageSize;
+uniform vec2 targetSize;
+
+out vec2 uv;
+out vec4 spriteColor;
+
+void main()
+{
+    uv = mix(rect.xy, rect.zw, 0.5*position + 0.5);
+    vec2 p = 0.5*transform.z*(rect.zw - rect.xy)*pageSize*position;
+    float c = cos(transform.w);
+    float s = sin(transform.w);
+    p = vec2(c*p.x - s*p.y, s*p.x + c*p.y) + transform.xy;
+    gl_Position = vec4(2.*p/targetSize - 1., 0., 1.);
+    spriteColor = color;
+}
+)===";
+
+static const std::string FragSrc = 1 + R"===(
+uniform sampler2D atlas;
+
+in vec2 uv;
+in vec4 spriteColor;
+
+layout(location = 0) out vec4 color;
+
+void main()
+{
+    color = spriteColor*texture(atlas, uv);
+}
+)===";
+
+namespace
+{
+    struct Segment
+    {
+        int x;
+        int y;
+        int width;
+    };
+
+    struct Page
+    {
+        std::vector<Segment> skyline;
+        int width = 0;
+        int height = 0;
+    };
+}
+
+// Returns the lowest height at which a `w` by `h` rectangle starting at segment
+// `i` fits under the top of the page, or -1 if it does not.
+static int fit(const std::vector<Segment>& skyline, std::size_t i, int w, int h,
+    int pageSize)
+{
+    if(skyline[i].x + w > pageSize)
+    {
+        return -1;
+    }
+    int y = 0;
+    for(int remaining = w; remaining > 0; remaining -= skyline[i++].width)
+    {
+        y = std::max(y, skyline[i].y);
+        if(y + h > pageSize)
+        {
+            return -1;
+        }
+    }
+    return y;
+}
+
+// Skyline bottom-left: each rectangle goes where its top edge is lowest,
+// leftmost on ties.
+static bool place(Page& page, int w, int h, int pageSize, int& x, int& y)
+{
+    std::size_t best = page.skyline.size();
+    int bestTop = pageSize + 1;
+    for(std::size_t i = 0; i < page.skyline.size(); ++i)
+    {
+        const int top = fit(page.skyline, i, w, h, pageSize);
+        if(top >= 0 && top + h < bestTop)
+        {
+            best = i;
+            bestTop = top + h;
+            y = top;
+        }
+    }
+    if(best == page.skyline.size())
+    {
+        return false;
+    }
+    x = page.skyline[best].x;
+
+    // Raise the skyline over the new rectangle and trim what it covers.
+    page.skyline.insert(page.skyline.begin() + best, {x, y + h, w});
+    for(std::size_t i = best + 1; i < page.skyline.size();)
+    {
+        Segment& s = page.skyline[i];
+        const int overlap = x + w - s.x;
+        if(overlap <= 0)
+        {
+            break;
+        }
+        if(overlap < s.width)
+        {
+            s.x += overlap;
+            s.width -= overlap;
+            break;
+        }
+        page.skyline.erase(page.skyline.begin() + i);
+    }
+    for(std::size_t i = 1; i < page.skyline.size();)
+    {
+        if(page.skyline[i - 1].y == page.skyline[i].y)
+        {
+            page.skyline[i - 1].width += page.skyline[i].width;
+            page.skyline.erase(page.skyline.begin() + i);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+    page.width = std::max(page.width, x + w);
+    page.height = std::max(page.height, y + h);
+    return true;
+}
+
+paz::SpriteBatch::SpriteBatch() {}
+
+paz::SpriteBatch::SpriteBatch(const Framebuffer& fbo, const std::vector<Image>&
+    images, int pageSize)
+{
+    if(pageSize < 1)
+    {
+        throw std::invalid_argument("Atlas page size must be positive.");
+    }
+    for(const auto& n : images)
+    {
+        if(n.format() != ImageFormat::RGBA8UNorm)
+        {
+            throw std::invalid_argument("Sprite images must be RGBA8UNorm.");
+        }
+        if(n.width() < 1 || n.height() < 1)
+        {
+            throw std::invalid_argument("Sprite images must not be empty.");
+        }
+        if(n.width() > pageSize || n.height() > pageSize)
+        {
+            throw std::invalid_argument("Sprite image is larger than an atlas "
+                "page.");
+        }
+    }
+
+    // Packing tall images first leaves a flatter skyline.
+    std::vector<std::size_t> order(images.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t
+        b)
+    {
+        return images[a].height() > images[b].height() || (images[a].height()
+            == images[b].height() && images[a].width() > images[b].width());
+    });
+    std::vector<Page> pages;
+    std::vector<std::array<int, 2>> offsets(images.size());
+    std::vector<int> spritePages(images.size());
+    for(auto n : order)
+    {
+        const int w = images[n].width();
+        const int h = images[n].height();
+        std::size_t p = 0;
+        for(; p < pages.size(); ++p)
+        {
+            if(place(pages[p], w, h, pageSize, offsets[n][0], offsets[n][1]))
+            {
+                break;
+            }
+        }
+        if(p == pages.size())
+        {
+            pages.emplace_back();
+            pages.back().skyline.push_back({0, 0, pageSize});
+            place(pages.back(), w, h, pageSize, offsets[n][0], offsets[n][1]);
+        }
+        spritePages[n] = p;
+    }
+
+    _data = std::make_shared<Data>();
+    _data->_fbo = fbo;
+    _data->_vert = VertexFunction(VertSrc);
+    _data->_frag = FragmentFunction(FragSrc);
+    _data->_spritePages = std::move(spritePages);
+    _data->_spriteRects.resize(images.size());
+    std::vector<std::vector<unsigned char>> pixels(pages.size());
+    for(std::size_t i = 0; i < pages.size(); ++i)
+    {
+        pixels[i].resize(4*pages[i].width*pages[i].height);
+    }
+    for(std::size_t i = 0; i < images.size(); ++i)
+    {
+        const Page& page = pages[_data->_spritePages[i]];
+        const int x = offsets[i][0];
+        const int y = offsets[i][1];
+        const int w = images[i].width();
+        const int h = images[i].height();
+        for(int j = 0; j < h; ++j)
+        {
+            std::memcpy(pixels[_data->_spritePages[i]].data() + 4*(page.width*
+                (y + j) + x), images[i].bytes().data() + 4*w*j, 4*w);
+        }
+        _data->_spriteRects[i] = {static_cast<float>(x)/page.width, static_cast<
+            float>(y)/page.height, static_cast<float>(x + w)/page.width,
+            static_cast<float>(y + h)/page.height};
+    }
+    for(std::size_t i = 0; i < pages.size(); ++i)
+    {
+        _data->_pages.emplace_back(TextureFormat::RGBA8UNorm, pages[i].width,
+            pages[i].height, pixels[i].data());
+    }
+}
+
+paz::SpriteBatch::SpriteBatch(const std::vector<Image>& images, int pageSize) :
+    SpriteBatch(final_framebuffer(), images, pageSize) {}
+
+void paz::SpriteBatch::add(std::size_t sprite, float x, float y, float scale,
+    float angle, const std::array<float, 4>& color, BlendMode blendMode)
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Sprite batch has not been initialized.");
+    }
+    if(sprite >= _data->_spriteRects.size())
+    {
+        throw std::out_of_range("Sprite " + std::to_string(sprite) + " is out "
+            "of range.");
+    }
+    auto& b = _data->_buckets[{blendMode, _data->_spritePages[sprite]}];
+    b._transforms.insert(b._transforms.end(), {x, y, scale, angle});
+    b._rects.insert(b._rects.end(), _data->_spriteRects[sprite].begin(),
+        _data->_spriteRects[sprite].end());
+    b._colors.insert(b._colors.end(), color.begin(), color.end());
+    ++_data->_size;
+}
+
+void paz::SpriteBatch::draw(LoadAction colorLoadAction)
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Sprite batch has not been initialized.");
+    }
+    PAZ_PROFILE("SpriteBatch::draw");
+    if(!_data->_size && colorLoadAction == LoadAction::Load)
+    {
+        return;
+    }
+
+    // Every bucket is uploaded before any pass begins. Instance buffers grow
+    // geometrically and are refilled every draw.
+    for(auto& n : _data->_buckets)
+    {
+        Data::Bucket& b = n.second;
+        const std::size_t count = b._colors.size()/4;
+        if(!count)
+        {
+            continue;
+        }
+        reserve_instances(b._instances, count, 3);
+        b._instances.streamAttribute(0, b._transforms);
+        b._instances.streamAttribute(1, b._rects);
+        b._instances.streamAttribute(2, b._colors);
+    }
+
+    // One pass per blend mode, since blending is fixed when a pass is built.
+    const auto get_pass = [&](BlendMode mode) -> RenderPass&
+    {
+        auto it = _data->_passes.find(mode);
+        if(it == _data->_passes.end())
+        {
+            it = _data->_passes.emplace(mode, RenderPass(_data->_fbo, _data->
+                _vert, _data->_frag, {mode})).first;
+            it->second.setName("SpriteBatch");
+        }
+        return it->second;
+    };
+    const float targetWidth = _data->_fbo.width();
+    const float targetHeight = _data->_fbo.height();
+    RenderPass* pass = nullptr;
+    BlendMode passMode = BlendMode::Disable;
+    LoadAction loadAction = colorLoadAction;
+    for(const auto& n : _data->_buckets)
+    {
+        const Data::Bucket& b = n.second;
+        if(b._colors.empty())
+        {
+            continue;
+        }
+        if(!pass || passMode != n.first.first)
+        {
+            if(pass)
+            {
+                pass->end();
+            }
+            pass = &get_pass(n.first.first);
+            passMode = n.first.first;
+            pass->begin({loadAction});
+            loadAction = LoadAction::Load;
+            pass->uniform("targetSize", targetWidth, targetHeight);
+        }
+        const Texture& page = _data->_pages[n.first.second];
+        pass->read("atlas", page);
+        pass->uniform("pageSize", static_cast<float>(page.width()), static_cast<
+            float>(page.height()));
+        pass->draw(PrimitiveType::TriangleStrip, quad_vertices(), b.
+            _instances);
+    }
+    if(pass)
+    {
+        pass->end();
+    }
+    else
+    {
+        RenderPass& clearPass = get_pass(BlendMode::SrcAlpha_InvSrcAlpha);
+        clearPass.begin({colorLoadAction});
+        clearPass.end();
+    }
+    clear();
+}
+
+void paz::SpriteBatch::clear()
+{
+    if(_data)
+    {
+        for(auto& n : _data->_buckets)
+        {
+            n.second._transforms.clear();
+            n.second._rects.clear();
+            n.second._colors.clear();
+        }
+        _data->_size = 0;
+    }
+}
+
+std::size_t paz::SpriteBatch::size() const
+{
+    return _data ? _data->_size : 0;
+}
+
+std::size_t paz::SpriteBatch::numPages() const
+{
+    return _data ? _data->_pages.size() : 0;
+}
@@ -1,8 +1,17 @@
 #include "PAZ_Graphics"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <iomanip>
 #include <cstdint>
+#include <chrono>
+#include <thread>
+#ifdef PAZ_HEADLESS
+#include <cstring>
+#endif
 
 static constexpr double Pi = 3.14159265358979323846264338328; // M_PI
 
@@ -174,6 +183,66 @@ void main()
 }
 )===";
 
+static const std::string InstanceVertSrc = 1 + R"===(
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec4 offset [[instance]];
+void main()
+{
+    gl_Position = vec4(position + offset.xy, 0., 1.);
+}
+)===";
+
+static const std::string FillFragSrc = 1 + R"===(
+uniform vec4 fill;
+layout(location = 0) out vec4 color;
+void main()
+{
+    color = fill;
+}
+)===";
+
+static const std::string CopyVertSrc = 1 + R"===(
+layout(location = 0) in vec2 position;
+out vec2 uv;
+void main()
+{
+    uv = 0.5*position + 0.5;
+    gl_Position = vec4(position, 0., 1.);
+}
+)===";
+
+static const std::string CopyFragSrc = 1 + R"===(
+in vec2 uv;
+uniform sampler2D source;
+layout(location = 0) out vec4 color;
+void main()
+{
+    color = texture(source, uv);
+}
+)===";
+
+static const std::string CheckerFragSrc = 1 + R"===(
+in vec2 uv;
+uniform float size;
+layout(location = 0) out vec4 color;
+void main()
+{
+    float c = mod(floor(size*uv.x) + floor(size*uv.y), 2.);
+    color = vec4(c, c, c, 1.);
+}
+)===";
+
+static const std::string LodFragSrc = 1 + R"===(
+in vec2 uv;
+uniform sampler2D source;
+uniform float lod;
+layout(location = 0) out vec4 color;
+void main()
+{
+    color = textureLod(source, uv, lod);
+}
+)===";
+
 static const std::string SceneFragSrc = 1 + R"===(
 in vec4 lightProjPos;
 in vec4 lightSpcNor;
@@ -325,6 +394,261 @@ int main()
         surface = paz::Texture(img, paz::MinMagFilter::Linear, paz::
             MinMagFilter::Linear, paz::MipmapFilter::Anisotropic, paz::
             WrapMode::Repeat, paz::WrapMode::Repeat);
+
+        // Re-upload the same texels through the asynchronous path.
+        surface.uploadAsync(img);
+
+        // Rewrite the first row of squares in place from padded rows. The
+        // padding value never occurs in the image.
+        const std::size_t pitch = img.width() + 16;
+        std::vector<unsigned char> padded(pitch*Scale, 0x55);
+        for(std::size_t i = 0; i < Scale; ++i)
+        {
+            std::copy(img.bytes().begin() + img.width()*i, img.bytes().begin() +
+                img.width()*(i + 1), padded.begin() + pitch*i);
+        }
+        surface.sub(0, 0, img.width(), Scale, padded.data(), pitch);
+        if(!std::equal(img.bytes().begin(), img.bytes().begin() + img.width()*
+            Scale, surface.readAsync(0, 0, img.width(), Scale).get().bytes().
+            begin()))
+        {
+            throw std::runtime_error("Padded texture update is wrong.");
+        }
+    }
+    CATCH
+
+    try
+    {
+        // Odd dimensions, so rows are not aligned.
+        paz::Image img(paz::ImageFormat::RGBA8UNorm, 5, 3);
+        for(std::size_t i = 0; i < img.bytes().size(); ++i)
+        {
+            img.bytes()[i] = 7*i;
+        }
+        paz::Texture tex(paz::TextureFormat::RGBA8UNorm, 5, 3, std::vector<
+            unsigned char>(img.bytes().size()).data());
+        for(int i = 0; i < 40; ++i)
+        {
+            tex.uploadAsync(img);
+        }
+        if(tex.readAsync(0, 0, 5, 3).get().bytes() != img.bytes())
+        {
+            throw std::runtime_error("Asynchronous upload is wrong.");
+        }
+
+        // Outrun the readback pool, then drop some requests unread.
+        std::vector<paz::ReadbackRequest> reads;
+        for(int i = 0; i < 40; ++i)
+        {
+            reads.push_back(tex.readAsync(0, i%3, 5, 1));
+        }
+        reads.erase(reads.begin() + 30, reads.end());
+        for(int i = 0; i < 40; ++i)
+        {
+            reads.push_back(tex.readAsync(0, i%3, 5, 1));
+        }
+        for(std::size_t i = 0; i < reads.size(); ++i)
+        {
+            const int y = (i < 30 ? i : i - 30)%3;
+            if(!std::equal(img.bytes().begin() + 20*y, img.bytes().begin() +
+                20*(y + 1), reads[i].get().bytes().begin()))
+            {
+                throw std::runtime_error("Pooled readback is wrong.");
+            }
+        }
+
+        // Fill the staging memory on another thread.
+        paz::TextureUpload upload = tex.mapUpload();
+        std::thread filler([&]()
+        {
+            for(int i = 0; i < upload.height(); ++i)
+            {
+                for(std::size_t j = 0; j < upload.bytesPerRow(); ++j)
+                {
+                    upload.row(i)[j] = 3*(img.bytes().size() - upload.
+                        bytesPerRow()*i - j);
+                }
+            }
+        });
+        filler.join();
+        EXPECT_EXCEPTION(surface.commit(upload))
+        tex.commit(upload);
+        EXPECT_EXCEPTION(tex.commit(upload))
+        const paz::Image committed = tex.readAsync(0, 0, 5, 3).get();
+        for(std::size_t i = 0; i < img.bytes().size(); ++i)
+        {
+            if(committed.bytes()[i] != static_cast<unsigned char>(3*(img.
+                bytes().size() - i)))
+            {
+                throw std::runtime_error("Committed upload is wrong.");
+            }
+        }
+        if(!upload.empty())
+        {
+            throw std::runtime_error("Committed upload was not emptied.");
+        }
+        EXPECT_EXCEPTION(tex.mapUpload().row(3))
+    }
+    CATCH
+
+    try
+    {
+        paz::Image img(paz::ImageFormat::R8UNorm, Scale*Size, Scale*Size);
+        for(std::size_t i = 0; i < img.bytes().size(); ++i)
+        {
+            img.bytes()[i] = i%img.width();
+        }
+        const auto blocks = paz::compress(img, paz::TextureFormat::BC4RUNorm);
+        const paz::Texture compressed(paz::TextureFormat::BC4RUNorm, img.
+            width(), img.height(), blocks.data());
+    }
+    CATCH
+
+    EXPECT_EXCEPTION(paz::compress(paz::Image(paz::ImageFormat::R8UNorm, 6, 4),
+        paz::TextureFormat::BC4RUNorm))
+
+    paz::TextureArray layers;
+    try
+    {
+        layers = paz::TextureArray(paz::TextureFormat::R8UNorm, Size, Size, 2,
+            paz::MinMagFilter::Nearest, paz::MinMagFilter::Nearest, paz::
+            MipmapFilter::Linear);
+        const std::vector<unsigned char> white(Size*Size, 255);
+        layers.sub(1, white.data());
+    }
+    CATCH
+
+    EXPECT_EXCEPTION(layers.sub(2, nullptr))
+
+    try
+    {
+        // Adopt a buffer twice as wide and upload its left half through a view.
+        std::vector<unsigned char> texels(2*Size*Size, 255);
+        const paz::Image wide(paz::ImageFormat::R8UNorm, 2*Size, Size, std::
+            move(texels));
+        const paz::ImageView left(wide.format(), Size, Size, wide.bytes().
+            data(), wide.width());
+        const paz::Texture tex(left);
+        layers.sub(0, left);
+    }
+    CATCH
+
+    EXPECT_EXCEPTION(paz::Image(paz::ImageFormat::R8UNorm, Size, Size, std::
+        vector<unsigned char>(Size)))
+    EXPECT_EXCEPTION(layers.sub(0, paz::ImageView(paz::ImageFormat::R8UNorm,
+        Size, Size, nullptr, Size - 1)))
+
+    try
+    {
+        const auto a = paz::RenderTarget::AcquireTransient(paz::TextureFormat::
+            RGBA16Float, 0.5);
+        paz::RenderTarget::ReleaseTransient(a);
+        const auto b = paz::RenderTarget::AcquireTransient(paz::TextureFormat::
+            RGBA16Float, 0.5);
+        if(b.width() != a.width() || b.height() != a.height())
+        {
+            throw std::runtime_error("Transient render target size mismatch.");
+        }
+    }
+    CATCH
+
+    EXPECT_EXCEPTION(paz::RenderTarget::ReleaseTransient(paz::RenderTarget(paz::
+        TextureFormat::R8UNorm, Size, Size)))
+
+    paz::RenderGraph graph;
+    try
+    {
+        const paz::VertexFunction shadowVert(ShadowVertSrc);
+        const paz::FragmentFunction shadowFrag(ShadowFragSrc);
+        const auto depth = graph.addTarget(paz::TextureFormat::Depth32Float,
+            ShadowRes, ShadowRes);
+        const auto unused = graph.addTarget(paz::TextureFormat::Depth32Float,
+            ShadowRes, ShadowRes);
+        graph.addPass(shadowVert, shadowFrag, {}, {unused}, [](paz::RenderPass&)
+        {
+            throw std::runtime_error("Render graph pass was not culled.");
+        });
+        graph.addPass(shadowVert, shadowFrag, {}, {depth}, [&](paz::RenderPass&
+            pass)
+        {
+            pass.depth(paz::DepthTestMode::Less);
+            pass.uniform("lightView", lightView);
+            pass.uniform("lightProjection", lightProjection);
+            pass.draw(paz::PrimitiveType::TriangleStrip, groundVerts);
+        }, {}, paz::LoadAction::Clear);
+        graph.keep(depth);
+        graph.execute();
+        if(graph.target(depth).width() != ShadowRes)
+        {
+            throw std::runtime_error("Render graph target has wrong size.");
+        }
+    }
+    CATCH
+
+    EXPECT_EXCEPTION(graph.target(1))
+
+    try
+    {
+        // Passes are added in reverse. `source` is last read by the pass that
+        // writes `middle`, before `aliased` is first written, so the two share
+        // storage and `aliased` starts with the fill left in it.
+        const paz::VertexFunction copyVert(CopyVertSrc);
+        const paz::FragmentFunction copyFrag(CopyFragSrc);
+        const paz::FragmentFunction fillFrag(FillFragSrc);
+        paz::VertexBuffer quadVerts;
+        quadVerts.addAttribute(2, std::array<float, 8>{1, -1, 1, 1, -1, -1, -1,
+            1});
+        const auto copy = [&](paz::RenderPass& pass)
+        {
+            pass.draw(paz::PrimitiveType::TriangleStrip, quadVerts);
+        };
+        paz::RenderGraph aliasGraph;
+        const auto source = aliasGraph.addTarget(paz::TextureFormat::
+            RGBA8UNorm, Size, Size);
+        const auto middle = aliasGraph.addTarget(paz::TextureFormat::
+            RGBA8UNorm, Size/2, Size/2);
+        const auto aliased = aliasGraph.addTarget(paz::TextureFormat::
+            RGBA8UNorm, Size, Size);
+        const auto result = aliasGraph.addTarget(paz::TextureFormat::
+            RGBA8UNorm, Size, Size);
+        std::vector<int> order;
+        aliasGraph.addPass(copyVert, copyFrag, {{"source", aliased}}, {result},
+            [&](paz::RenderPass& pass)
+        {
+            order.push_back(3);
+            copy(pass);
+        });
+        aliasGraph.addPass(copyVert, copyFrag, {{"source", middle}}, {aliased},
+            [&](paz::RenderPass&)
+        {
+            order.push_back(2);
+        });
+        aliasGraph.addPass(copyVert, copyFrag, {{"source", source}}, {middle},
+            [&](paz::RenderPass& pass)
+        {
+            order.push_back(1);
+            copy(pass);
+        });
+        aliasGraph.addPass(copyVert, fillFrag, {}, {source}, [&](paz::
+            RenderPass& pass)
+        {
+            order.push_back(0);
+            pass.uniform("fill", 1.f, 0.f, 0.f, 1.f);
+            copy(pass);
+        });
+        aliasGraph.keep(result);
+        aliasGraph.execute();
+        paz::Window::EndFrame();
+        if(order != std::vector<int>{0, 1, 2, 3})
+        {
+            throw std::runtime_error("Render graph passes ran out of order.");
+        }
+        const paz::Image img = aliasGraph.target(result).readAsync(0, 0, Size,
+            Size).get();
+        if(img.bytes()[0] != 255 || img.bytes()[1] || img.bytes()[2])
+        {
+            throw std::runtime_error("Render graph targets were not aliased.");
+        }
     }
     CATCH
 
@@ -387,6 +711,1051 @@ int main()
             throw std::runtime_error("RMS error is too high (" + std::to_string(
                 static_cast<int>(std::round(rms))) + ").");
         }
+
+        paz::Image reused(paz::ImageFormat::RGBA8UNorm_sRGB, img.width(), img.
+            height());
+        const unsigned char* storage = reused.bytes().data();
+        paz::Window::ReadPixels(reused);
+        if(reused.bytes().data() != storage || reused.bytes() != img.bytes())
+        {
+            throw std::runtime_error("Reading pixels into an image is wrong.");
+        }
+
+        auto req = paz::Window::ReadPixelsAsync();
+        const paz::Image asyncImg = req.get();
+        if(!req.ready() || asyncImg.width() != img.width() || asyncImg.height()
+            != img.height())
+        {
+            throw std::runtime_error("Asynchronous readback has wrong size.");
+        }
+        for(const auto& n : SamplePoints)
+        {
+            const int delta = asyncImg.bytes()[4*(ImgRes*n[0] + n[1])] - img.
+                bytes()[4*(ImgRes*n[0] + n[1])];
+            if(std::abs(delta) > 1)
+            {
+                throw std::runtime_error("Asynchronous readback does not match."
+                    );
+            }
+        }
+    }
+    CATCH
+
+    try
+    {
+        paz::Window::StartCapture("capture.raw", paz::CaptureFormat::RawRgba);
+        paz::Window::EndFrame();
+        const paz::Image img = paz::Window::ReadPixels();
+        paz::Window::StopCapture();
+        const auto stats = paz::Window::CaptureStatistics();
+        if(stats.framesWritten != 1 || stats.framesDropped)
+        {
+            throw std::runtime_error("Wrong number of frames captured.");
+        }
+        std::ifstream in("capture.raw", std::ios::binary);
+        std::vector<unsigned char> captured((std::istreambuf_iterator<char>(
+            in)), std::istreambuf_iterator<char>());
+        in.close();
+        std::remove("capture.raw");
+        const std::size_t rowBytes = 4*img.width();
+        if(captured.size() != rowBytes*img.height())
+        {
+            throw std::runtime_error("Captured frame has wrong size.");
+        }
+        for(int i = 0; i < img.height(); ++i)
+        {
+            if(!std::equal(captured.begin() + rowBytes*i, captured.begin() +
+                rowBytes*(i + 1), img.bytes().begin() + rowBytes*(img.height()
+                - 1 - i)))
+            {
+                throw std::runtime_error("Captured frame does not match.");
+            }
+        }
+    }
+    CATCH
+
+    EXPECT_EXCEPTION(paz::Window::StartCapture("capture.raw", paz::
+        CaptureFormat::Y4m, 0))
+
+    try
+    {
+        paz::ResourceLoader loader(2);
+        loader.setUploadBudget(1., 1);
+        const auto tex = loader.loadTexture([]()
+        {
+            return paz::Image(paz::ImageFormat::RGBA8UNorm, 4, 4);
+        });
+        const auto indices = loader.loadIndexBuffer([]()
+        {
+            return std::vector<unsigned int>{0, 1, 2};
+        });
+        while(loader.stats().numAwaitingUpload < 2)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        paz::Window::EndFrame();
+        if(tex.ready() == indices.ready())
+        {
+            throw std::runtime_error("Upload budget was not respected.");
+        }
+        const auto verts = loader.loadVertexBuffer([]()
+        {
+            paz::VertexData data;
+            data.addAttribute(2, std::array<float, 6>{0, 0, 1, 0, 0, 1});
+            return data;
+        });
+        const auto failed = loader.loadVertexBuffer([]() -> paz::VertexData
+        {
+            throw std::runtime_error("Decoding failed.");
+        });
+        loader.finish();
+        const auto stats = loader.stats();
+        if(stats.numLoaded != 3 || stats.numDecoding || stats.numAwaitingUpload
+            || stats.bytesAwaitingUpload)
+        {
+            throw std::runtime_error("Loader statistics are wrong.");
+        }
+        if(tex.get().width() != 4 || indices.get().size() != 3 || verts.get().
+            size() != 3)
+        {
+            throw std::runtime_error("Loaded resources are wrong.");
+        }
+        bool threw = false;
+        try
+        {
+            failed.get();
+        }
+        catch(const std::runtime_error&)
+        {
+            threw = true;
+        }
+        if(!threw)
+        {
+            throw std::runtime_error("Decoding error was not propagated.");
+        }
+    }
+    CATCH
+
+    try
+    {
+        // The worker is busy with the first request when the loader goes away.
+        std::vector<paz::LoadRequest<paz::IndexBuffer>> requests;
+        std::atomic<bool> started(false);
+        {
+            paz::ResourceLoader loader(1);
+            requests.push_back(loader.loadIndexBuffer([&]()
+            {
+                started = true;
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                return std::vector<unsigned int>{0, 1, 2};
+            }));
+            for(int i = 0; i < 3; ++i)
+            {
+                requests.push_back(loader.loadIndexBuffer([]()
+                {
+                    return std::vector<unsigned int>{0};
+                }));
+            }
+            while(!started)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        if(!requests[0].ready() || requests[0].get().size() != 3)
+        {
+            throw std::runtime_error("Decoded request was not uploaded.");
+        }
+        for(std::size_t i = 1; i < requests.size(); ++i)
+        {
+            if(!requests[i].ready())
+            {
+                throw std::runtime_error("Queued request was left waiting.");
+            }
+            EXPECT_EXCEPTION(requests[i].get())
+        }
+    }
+    CATCH
+
+    try
+    {
+        paz::Window::EnableGpuTiming();
+        scenePass.setName("scene");
+        std::vector<paz::GpuPassTime> times;
+        for(int i = 0; i < 20 && times.empty(); ++i)
+        {
+            scenePass.begin({paz::LoadAction::Clear}, paz::LoadAction::Clear);
+            scenePass.end();
+            paz::Window::EndFrame();
+            times = paz::Window::GpuPassTimes();
+        }
+        paz::Window::DisableGpuTiming();
+        if(times.size() != 1 || times[0].name != "scene" || times[0].start ||
+            times[0].duration < 0.)
+        {
+            throw std::runtime_error("GPU pass timings are wrong.");
+        }
+    }
+    CATCH
+
+    try
+    {
+        // Heavy frames, none of them read, let the GPU fall behind and fill
+        // the ring of pending frames. Once it catches up, reported frames must
+        // never go backwards.
+        const paz::VertexFunction copyVert(CopyVertSrc);
+        const paz::FragmentFunction fillFrag(FillFragSrc);
+        paz::RenderTarget large(paz::TextureFormat::RGBA8UNorm, 1024, 1024);
+        paz::Framebuffer largeFbo;
+        largeFbo.attach(large);
+        paz::RenderPass fillPass(largeFbo, copyVert, fillFrag);
+        paz::VertexBuffer quadVerts;
+        quadVerts.addAttribute(2, std::array<float, 8>{1, -1, 1, 1, -1, -1, -1,
+            1});
+        paz::Window::EnableGpuTiming();
+        int reported = -1;
+        const auto check = [&]()
+        {
+            // Frames timed by earlier tests may still be reported first.
+            const auto times = paz::Window::GpuPassTimes();
+            if(times.empty() || times[0].name.compare(0, 6, "frame "))
+            {
+                return;
+            }
+            const int frame = std::stoi(times[0].name.substr(6));
+            if(times.size() != 1 || frame < reported)
+            {
+                throw std::runtime_error("GPU pass timings are out of order.");
+            }
+            reported = frame;
+        };
+        constexpr int NumFrames = 40;
+        for(int i = 0; i < NumFrames; ++i)
+        {
+            fillPass.setName("frame " + std::to_string(i));
+            fillPass.begin({paz::LoadAction::Clear});
+            fillPass.uniform("fill", 0.f, 0.f, 0.f, 1.f);
+            for(int j = 0; j < 20; ++j)
+            {
+                fillPass.draw(paz::PrimitiveType::TriangleStrip, quadVerts);
+            }
+            fillPass.end();
+            paz::Window::EndFrame();
+        }
+        paz::Window::DisableGpuTiming();
+        for(int i = 0; i < 100; ++i)
+        {
+            paz::Window::EndFrame();
+            check();
+        }
+        if(reported < 0)
+        {
+            throw std::runtime_error("GPU pass timings were not reported.");
+        }
+    }
+    CATCH
+
+    try
+    {
+        paz::Profiler::Enable();
+        {
+            const paz::ProfileScope scope("test \"scope\"");
+            scenePass.begin();
+            scenePass.end();
+            paz::Window::EndFrame();
+        }
+        paz::Profiler::Disable();
+        paz::Profiler::WriteTrace("trace.json");
+        paz::Profiler::Clear();
+        std::ifstream in("trace.json");
+        const std::string trace((std::istreambuf_iterator<char>(in)), std::
+            istreambuf_iterator<char>());
+        in.close();
+        std::remove("trace.json");
+        for(const auto& n : {"\"traceEvents\"", "\"RenderPass::begin\"",
+            "\"RenderPass::end\"", "\"Window::EndFrame\"", "\"test \\\"scope"
+            "\\\"\""})
+        {
+            if(trace.find(n) == std::string::npos)
+            {
+                throw std::runtime_error("Trace is missing " + std::string(n) +
+                    ".");
+            }
+        }
+    }
+    CATCH
+
+    try
+    {
+        // Rings of exited threads are dropped once written, so each trace
+        // holds only the latest round of short-lived threads.
+        paz::Profiler::Enable();
+        for(int i = 0; i < 3; ++i)
+        {
+            std::vector<std::thread> threads;
+            for(int j = 0; j < 4; ++j)
+            {
+                threads.emplace_back([]()
+                {
+                    const paz::ProfileScope scope("worker");
+                });
+            }
+            for(auto& n : threads)
+            {
+                n.join();
+            }
+            paz::Profiler::WriteTrace("trace.json");
+            std::ifstream in("trace.json");
+            const std::string trace((std::istreambuf_iterator<char>(in)), std::
+                istreambuf_iterator<char>());
+            in.close();
+            std::remove("trace.json");
+            std::size_t count = 0;
+            for(auto pos = trace.find("\"worker\""); pos != std::string::npos;
+                pos = trace.find("\"worker\"", pos + 1))
+            {
+                ++count;
+            }
+            if(count != threads.size())
+            {
+                throw std::runtime_error("Profiler kept rings of exited threads."
+                    );
+            }
+        }
+        paz::Profiler::Disable();
+        paz::Profiler::Clear();
+    }
+    CATCH
+
+    try
+    {
+        paz::Window::EndFrame();
+        {
+            const std::array<unsigned int, 3> idx = {0, 1, 2};
+            const paz::IndexBuffer indices(idx);
+        }
+        scenePass.begin();
+        scenePass.read("surface", surface);
+        scenePass.draw(paz::PrimitiveType::TriangleStrip, groundVerts);
+        scenePass.draw(paz::PrimitiveType::Triangles, cubeVerts);
+        scenePass.end();
+        paz::Window::EndFrame();
+        const auto stats = paz::Window::FrameStatistics();
+        if(stats.draws != 2 || stats.instances != 2 || stats.primitives != 2 +
+            CubePos.size()/12 || stats.programBinds != 1 || stats.textureBinds
+            != 1 || stats.vertexArrayBinds != 2 || stats.bytesUploaded != 12 ||
+            stats.buffersCreated != 1 || stats.buffersDestroyed != 1)
+        {
+            throw std::runtime_error("Frame statistics are wrong.");
+        }
+    }
+    CATCH
+
+    try
+    {
+        if(paz::Window::NeedsRedraw())
+        {
+            throw std::runtime_error("Redraw needed without any changes.");
+        }
+        const auto start = std::chrono::steady_clock::now();
+        std::thread requester([]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            paz::Window::RequestRedraw();
+        });
+        paz::Window::WaitEvents(10.);
+        requester.join();
+        if(!paz::Window::NeedsRedraw() || std::chrono::steady_clock::now() -
+            start > std::chrono::seconds(5))
+        {
+            throw std::runtime_error("Redraw request did not wake event loop.");
+        }
+        paz::Window::EndFrame();
+        if(paz::Window::NeedsRedraw())
+        {
+            throw std::runtime_error("Redraw request was not cleared.");
+        }
+
+        // Another context consuming its request must not clear this one's.
+        std::string error;
+        std::thread consumer([&]()
+        {
+            try
+            {
+                paz::Window::NeedsRedraw();
+                paz::Window::EndFrame();
+                paz::Window::RequestRedraw();
+                if(!paz::Window::NeedsRedraw())
+                {
+                    error = "Redraw request was not seen by its own context.";
+                }
+            }
+            catch(const std::exception& e)
+            {
+                error = e.what();
+            }
+        });
+        consumer.join();
+        if(!error.empty())
+        {
+            throw std::runtime_error(error);
+        }
+        if(!paz::Window::NeedsRedraw())
+        {
+            throw std::runtime_error("Redraw request was consumed by another "
+                "context.");
+        }
+        paz::Window::EndFrame();
+    }
+    CATCH
+
+    try
+    {
+        paz::Window::SetMaxFramesInFlight(1);
+        paz::Window::SetFrameRateLimit(50.);
+        paz::Window::EndFrame();
+        const auto start = std::chrono::steady_clock::now();
+        for(int i = 0; i < 5; ++i)
+        {
+            scenePass.begin();
+            scenePass.end();
+            paz::Window::EndFrame();
+        }
+        const double elapsed = std::chrono::duration<double>(std::chrono::
+            steady_clock::now() - start).count();
+        paz::Window::SetFrameRateLimit(0.);
+        paz::Window::SetMaxFramesInFlight(0);
+        if(elapsed < 0.099 || paz::Window::FrameTime() < 0.0199)
+        {
+            throw std::runtime_error("Frame rate limit was not applied.");
+        }
+    }
+    CATCH
+
+    try
+    {
+        paz::OcclusionQuery query;
+        for(int i = 0; i < 20 && (i < 2 || !query.ready()); ++i)
+        {
+            scenePass.begin({paz::LoadAction::Clear}, paz::LoadAction::Clear);
+            scenePass.read("surface", surface);
+            scenePass.beginConditional(query);
+            scenePass.beginQuery(query);
+            scenePass.draw(paz::PrimitiveType::TriangleStrip, groundVerts);
+            scenePass.endQuery();
+            scenePass.endConditional();
+            scenePass.end();
+            paz::Window::EndFrame();
+        }
+        if(!query.ready() || !query.visible())
+        {
+            throw std::runtime_error("Occlusion query result is wrong.");
+        }
+        scenePass.begin();
+        EXPECT_EXCEPTION(scenePass.endQuery())
+        EXPECT_EXCEPTION(scenePass.endConditional())
+        scenePass.beginQuery(query);
+        EXPECT_EXCEPTION(scenePass.beginQuery(query))
+        EXPECT_EXCEPTION(scenePass.beginConditional(query))
+        EXPECT_EXCEPTION(scenePass.end())
+        scenePass.endQuery();
+        scenePass.end();
+        paz::Window::EndFrame();
+
+        // No fragment passes a depth test that never passes.
+        paz::OcclusionQuery hidden;
+        for(int i = 0; i < 20 && (i < 2 || !hidden.ready()); ++i)
+        {
+            scenePass.begin({paz::LoadAction::Clear}, paz::LoadAction::Clear);
+            scenePass.depth(paz::DepthTestMode::Never);
+            scenePass.read("surface", surface);
+            scenePass.beginQuery(hidden);
+            scenePass.draw(paz::PrimitiveType::TriangleStrip, groundVerts);
+            scenePass.endQuery();
+            scenePass.end();
+            paz::Window::EndFrame();
+        }
+        if(!hidden.ready() || hidden.visible())
+        {
+            throw std::runtime_error("Hidden proxy was reported visible.");
+        }
+
+        // A draw skipped by conditional rendering leaves the cleared frame.
+        scenePass.begin({paz::LoadAction::Clear}, paz::LoadAction::Clear);
+        scenePass.end();
+        paz::Window::EndFrame();
+        const paz::Image cleared = paz::Window::ReadPixels();
+        scenePass.begin({paz::LoadAction::Clear}, paz::LoadAction::Clear);
+        scenePass.read("surface", surface);
+        scenePass.beginConditional(hidden);
+        scenePass.draw(paz::PrimitiveType::TriangleStrip, groundVerts);
+        scenePass.endConditional();
+        scenePass.end();
+        paz::Window::EndFrame();
+        if(paz::Window::ReadPixels().bytes() != cleared.bytes())
+        {
+            throw std::runtime_error("Conditional draw changed pixels.");
+        }
+
+        // The pass keeps a query in progress alive.
+        scenePass.begin();
+        {
+            paz::OcclusionQuery temporary;
+            scenePass.beginQuery(temporary);
+        }
+        scenePass.draw(paz::PrimitiveType::TriangleStrip, groundVerts);
+        scenePass.endQuery();
+        scenePass.end();
+        paz::Window::EndFrame();
+    }
+    CATCH
+
+    try
+    {
+        // Ahead, behind, beside, beyond the far plane and straddling the left
+        // plane, repeated to cover both vectorized and scalar tests.
+        const auto viewProjection = paz::perspective(YFov, 1., ZNear, ZFar);
+        const float side = -5.f*std::tan(0.5*YFov);
+        std::vector<float> x, y, z, r;
+        for(int i = 0; i < 3; ++i)
+        {
+            x.insert(x.end(), {0.f, 0.f, 50.f, 0.f, side - 0.5f});
+            y.insert(y.end(), {0.f, 0.f, 0.f, 0.f, 0.f});
+            z.insert(z.end(), {-5.f, 5.f, -5.f, -ZFar - 2.f, -5.f});
+            r.insert(r.end(), {1.f, 1.f, 1.f, 1.f, 1.f});
+        }
+        const std::vector<unsigned int> expected = {0, 4, 5, 9, 10, 14};
+        paz::BoundingSpheres spheres;
+        spheres.x = x.data();
+        spheres.y = y.data();
+        spheres.z = z.data();
+        spheres.radius = r.data();
+        spheres.size = x.size();
+        if(paz::cull(viewProjection, spheres) != expected)
+        {
+            throw std::runtime_error("Sphere culling is wrong.");
+        }
+        std::vector<float> minX(x.size()), minY(x.size()), minZ(x.size()),
+            maxX(x.size()), maxY(x.size()), maxZ(x.size());
+        for(std::size_t i = 0; i < x.size(); ++i)
+        {
+            minX[i] = x[i] - r[i];
+            minY[i] = y[i] - r[i];
+            minZ[i] = z[i] - r[i];
+            maxX[i] = x[i] + r[i];
+            maxY[i] = y[i] + r[i];
+            maxZ[i] = z[i] + r[i];
+        }
+        paz::BoundingBoxes boxes;
+        boxes.minX = minX.data();
+        boxes.minY = minY.data();
+        boxes.minZ = minZ.data();
+        boxes.maxX = maxX.data();
+        boxes.maxY = maxY.data();
+        boxes.maxZ = maxZ.data();
+        boxes.size = x.size();
+        if(paz::cull(viewProjection, boxes) != expected)
+        {
+            throw std::runtime_error("Box culling is wrong.");
+        }
+
+        paz::Window::EndFrame();
+        paz::InstanceBuffer instances(x.size());
+        instances.addAttribute(4, paz::DataType::Float);
+        std::vector<float> offsets(4*x.size());
+        instances.gatherAttribute(0, offsets.data(), expected);
+        EXPECT_EXCEPTION(instances.gatherAttribute(0, offsets.data(), {0, 15}))
+        EXPECT_EXCEPTION(instances.gatherAttribute(1, offsets.data(), expected))
+        paz::Window::EndFrame();
+        if(paz::Window::FrameStatistics().bytesUploaded != 16*expected.size())
+        {
+            throw std::runtime_error("Gathered instances were not uploaded.");
+        }
+
+        // A full upload draws every instance again.
+        const paz::VertexFunction instanceVert(InstanceVertSrc);
+        const paz::FragmentFunction fillFrag(FillFragSrc);
+        paz::RenderPass instancePass(instanceVert, fillFrag);
+        paz::VertexBuffer quadVerts;
+        quadVerts.addAttribute(2, std::array<float, 8>{1, -1, 1, 1, -1, -1, -1,
+            1});
+        const auto drawn = [&]()
+        {
+            instancePass.begin();
+            instancePass.uniform("fill", 1.f, 1.f, 1.f, 1.f);
+            instancePass.draw(paz::PrimitiveType::TriangleStrip, quadVerts,
+                instances);
+            instancePass.end();
+            paz::Window::EndFrame();
+            return paz::Window::FrameStatistics().instances;
+        };
+        if(drawn() != expected.size())
+        {
+            throw std::runtime_error("Wrong number of gathered instances drawn."
+                );
+        }
+        instances.subAttribute(0, offsets);
+        if(drawn() != x.size())
+        {
+            throw std::runtime_error("Gathered instance count was not reset.");
+        }
+        instances.gatherAttribute(0, offsets.data(), {});
+        if(drawn())
+        {
+            throw std::runtime_error("Instances drawn after an empty gather.");
+        }
+        instances.subAttribute(0, offsets);
+        if(drawn() != x.size())
+        {
+            throw std::runtime_error("Gathered instance count was not reset.");
+        }
+        instances.streamAttribute(0, offsets.data(), 8);
+        if(drawn() != 2)
+        {
+            throw std::runtime_error("Wrong number of streamed instances drawn."
+                );
+        }
+        EXPECT_EXCEPTION(instances.streamAttribute(0, offsets.data(), 6))
+        EXPECT_EXCEPTION(instances.streamAttribute(0, std::vector<float>(4*x.
+            size() + 4)))
+    }
+    CATCH
+
+    try
+    {
+        // Mipmaps of a target are generated when a later pass reads it, and
+        // again after it is redrawn.
+        const paz::VertexFunction copyVert(CopyVertSrc);
+        const paz::FragmentFunction checkerFrag(CheckerFragSrc);
+        const paz::FragmentFunction lodFrag(LodFragSrc);
+        paz::RenderTarget mipmapped(paz::TextureFormat::RGBA8UNorm, Size, Size,
+            paz::MinMagFilter::Nearest, paz::MinMagFilter::Nearest, paz::
+            MipmapFilter::Nearest);
+        paz::Framebuffer mipmappedFbo;
+        mipmappedFbo.attach(mipmapped);
+        paz::RenderPass checkerPass(mipmappedFbo, copyVert, checkerFrag);
+        paz::RenderTarget lowest(paz::TextureFormat::RGBA8UNorm, 1, 1);
+        paz::Framebuffer lowestFbo;
+        lowestFbo.attach(lowest);
+        paz::RenderPass lodPass(lowestFbo, copyVert, lodFrag);
+        paz::VertexBuffer quadVerts;
+        quadVerts.addAttribute(2, std::array<float, 8>{1, -1, 1, 1, -1, -1, -1,
+            1});
+        const auto lowestMip = [&](float checkers)
+        {
+            checkerPass.begin();
+            checkerPass.uniform("size", checkers);
+            checkerPass.draw(paz::PrimitiveType::TriangleStrip, quadVerts);
+            checkerPass.end();
+            lodPass.begin();
+            lodPass.read("source", mipmapped);
+            lodPass.uniform("lod", std::log2(static_cast<float>(Size)));
+            lodPass.draw(paz::PrimitiveType::TriangleStrip, quadVerts);
+            lodPass.end();
+            paz::Window::EndFrame();
+            return static_cast<int>(lowest.readAsync(0, 0, 1, 1).get().bytes()[
+                0]);
+        };
+        if(std::abs(lowestMip(Size) - 128) > 2)
+        {
+            throw std::runtime_error("Lowest mip level is not the average.");
+        }
+        if(lowestMip(1) > 2)
+        {
+            throw std::runtime_error("Mipmaps were not regenerated.");
+        }
+
+        // The same holds for a texture updated one row at a time.
+        paz::Texture updated(paz::TextureFormat::RGBA8UNorm, Size, Size, std::
+            vector<unsigned char>(4*Size*Size).data(), paz::MinMagFilter::
+            Nearest, paz::MinMagFilter::Nearest, paz::MipmapFilter::Nearest);
+        const std::vector<unsigned char> white(4*Size, 255);
+        for(int i = 0; i < Size/2; ++i)
+        {
+            updated.sub(0, i, Size, 1, white.data());
+        }
+        lodPass.begin();
+        lodPass.read("source", updated);
+        lodPass.uniform("lod", std::log2(static_cast<float>(Size)));
+        lodPass.draw(paz::PrimitiveType::TriangleStrip, quadVerts);
+        lodPass.end();
+        paz::Window::EndFrame();
+        if(std::abs(lowest.readAsync(0, 0, 1, 1).get().bytes()[0] - 128) > 2)
+        {
+            throw std::runtime_error("Mipmaps of an updated texture are wrong."
+                );
+        }
+    }
+    CATCH
+
+    try
+    {
+        // Rows differ by more than the error bound, so blocks or block rows
+        // uploaded upside down are caught.
+        const paz::VertexFunction copyVert(CopyVertSrc);
+        const paz::FragmentFunction copyFrag(CopyFragSrc);
+        paz::RenderTarget copy(paz::TextureFormat::RGBA8UNorm, Size, Size);
+        paz::Framebuffer copyFbo;
+        copyFbo.attach(copy);
+        paz::RenderPass copyPass(copyFbo, copyVert, copyFrag);
+        paz::VertexBuffer quadVerts;
+        quadVerts.addAttribute(2, std::array<float, 8>{1, -1, 1, 1, -1, -1, -1,
+            1});
+        const std::array<std::pair<paz::TextureFormat, int>, 5> formats = {{
+            {paz::TextureFormat::BC1RGBAUNorm, 3}, {paz::TextureFormat::
+            BC3RGBAUNorm, 4}, {paz::TextureFormat::BC4RUNorm, 1}, {paz::
+            TextureFormat::BC5RGUNorm, 2}, {paz::TextureFormat::BC7RGBAUNorm,
+            4}}};
+        for(const auto& n : formats)
+        {
+            const int numChannels = n.first == paz::TextureFormat::BC4RUNorm ?
+                1 : (n.first == paz::TextureFormat::BC5RGUNorm ? 2 : 4);
+            paz::Image img(numChannels == 1 ? paz::ImageFormat::R8UNorm :
+                (numChannels == 2 ? paz::ImageFormat::RG8UNorm : paz::
+                ImageFormat::RGBA8UNorm), Size, Size);
+            for(int i = 0; i < Size; ++i)
+            {
+                for(int j = 0; j < Size*numChannels; ++j)
+                {
+                    img.bytes()[Size*numChannels*i + j] = j%numChannels == 1 ?
+                        247 - 16*i : 16*i + 8;
+                }
+            }
+            const auto blocks = paz::compress(img, n.first);
+            const paz::Texture tex(n.first, Size, Size, blocks.data());
+            copyPass.begin();
+            copyPass.read("source", tex);
+            copyPass.draw(paz::PrimitiveType::TriangleStrip, quadVerts);
+            copyPass.end();
+            paz::Window::EndFrame();
+            const paz::Image res = copy.readAsync(0, 0, Size, Size).get();
+            for(int i = 0; i < Size*Size; ++i)
+            {
+                for(int j = 0; j < n.second; ++j)
+                {
+                    if(std::abs(res.bytes()[4*i + j] - img.bytes()[numChannels*
+                        i + j]) > 12)
+                    {
+                        throw std::runtime_error("Block-compressed texture doe"
+                            "s not match its source.");
+                    }
+                }
+            }
+        }
+    }
+    CATCH
+
+    try
+    {
+        const auto matches = [](const float* a, const float* b, std::size_t n)
+        {
+            for(std::size_t i = 0; i < n; ++i)
+            {
+                if(std::abs(a[i] - b[i]) > Eps)
+                {
+                    return false;
+                }
+            }
+            return true;
+        };
+        const std::array<float, 16> identity = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0,
+            1, 0, 0, 0, 0, 1};
+
+        // A quarter turn about z takes x to y.
+        const float h = std::sqrt(0.5f);
+        const auto rot = paz::rotation({0.f, 0.f, h, h});
+        const std::array<float, 16> quarterTurn = {0, 1, 0, 0, -1, 0, 0, 0, 0,
+            0, 1, 0, 0, 0, 0, 1};
+        if(!matches(rot.data(), quarterTurn.data(), 16))
+        {
+            throw std::runtime_error("Quaternion rotation is wrong.");
+        }
+        const auto model = paz::multiply(paz::transform({1.f, 2.f, 3.f}, {rot[
+            0], rot[1], rot[2], rot[4], rot[5], rot[6], rot[8], rot[9], rot[
+            10]}), paz::perspective(YFov, 1.5, ZNear, ZFar));
+        if(!matches(paz::multiply(paz::inverse(model), model).data(),
+            identity.data(), 16) || !matches(paz::multiply(identity, model).
+            data(), model.data(), 16))
+        {
+            throw std::runtime_error("Matrix inverse or product is wrong.");
+        }
+        const auto view = paz::look_at({1.f, 2.f, 3.f}, {1.f, 2.f, -1.f}, {0.f,
+            1.f, 0.f});
+        const auto translation = paz::transform({-1.f, -2.f, -3.f}, {1, 0, 0, 0,
+            1, 0, 0, 0, 1});
+        if(!matches(view.data(), translation.data(), 16))
+        {
+            throw std::runtime_error("Look-at matrix is wrong.");
+        }
+        EXPECT_EXCEPTION(paz::inverse({}))
+
+        // Both vectorized and scalar paths must match the single transforms.
+        constexpr std::size_t n = 6;
+        std::array<float, n> x, y, z, qx, qy, qz, qw, scale;
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            const float angle = 0.7*i;
+            x[i] = i;
+            y[i] = -2.*i;
+            z[i] = 0.5*i;
+            qx[i] = std::sin(0.5*angle)*0.6;
+            qy[i] = 0.f;
+            qz[i] = std::sin(0.5*angle)*0.8;
+            qw[i] = std::cos(0.5*angle);
+            scale[i] = 1. + i;
+        }
+        paz::InstanceTransforms transforms;
+        transforms.x = x.data();
+        transforms.y = y.data();
+        transforms.z = z.data();
+        transforms.qx = qx.data();
+        transforms.qy = qy.data();
+        transforms.qz = qz.data();
+        transforms.qw = qw.data();
+        transforms.scale = scale.data();
+        transforms.size = n;
+        std::array<std::array<float, 4*n>, 4> columns;
+        paz::model_matrices(transforms, {columns[0].data(), columns[1].data(),
+            columns[2].data(), columns[3].data()});
+        std::array<std::array<float, 16>, n> models;
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            const auto r = paz::rotation({qx[i], qy[i], qz[i], qw[i]});
+            models[i] = paz::transform({x[i], y[i], z[i]}, {scale[i]*r[0],
+                scale[i]*r[1], scale[i]*r[2], scale[i]*r[4], scale[i]*r[5],
+                scale[i]*r[6], scale[i]*r[8], scale[i]*r[9], scale[i]*r[10]});
+            for(int j = 0; j < 4; ++j)
+            {
+                if(!matches(columns[j].data() + 4*i, models[i].data() + 4*j, 4))
+                {
+                    throw std::runtime_error("Model matrices are wrong.");
+                }
+            }
+        }
+        paz::multiply(view, models.data(), n, {columns[0].data(), columns[1].
+            data(), columns[2].data(), columns[3].data()});
+        for(std::size_t i = 0; i < n; ++i)
+        {
+            const auto expected = paz::multiply(view, models[i]);
+            for(int j = 0; j < 4; ++j)
+            {
+                if(!matches(columns[j].data() + 4*i, expected.data() + 4*j, 4))
+                {
+                    throw std::runtime_error("Batched products are wrong.");
+                }
+            }
+        }
+    }
+    CATCH
+
+    try
+    {
+        // Two 2x2 glyphs, one lit and one blank.
+        const std::array<unsigned char, 8> glyphData = {255, 255, 0, 0, 255,
+            255, 0, 0};
+        const paz::Texture font(paz::TextureFormat::R8UNorm, 4, 2, glyphData.
+            data());
+        EXPECT_EXCEPTION(paz::TextBatch(font, "abc"))
+        paz::TextBatch text(font, "ab", 4);
+        text.add("aB?\nba", 1, 2);
+        text.add("a", 0, 0, {1.f, 0.f, 0.f, 1.f});
+        if(text.size() != 5)
+        {
+            throw std::runtime_error("Wrong number of glyphs in text batch.");
+        }
+        paz::Window::EndFrame();
+        text.draw(paz::LoadAction::Clear);
+        paz::Window::EndFrame();
+        const auto stats = paz::Window::FrameStatistics();
+        if(text.size() || stats.draws != 1 || stats.instances != 5)
+        {
+            throw std::runtime_error("Text batch was not drawn in one call.");
+        }
+
+        // Rows of lit pixels are 8 pixels high and 12 apart, from the top.
+        const paz::Image img = paz::Window::ReadPixels();
+        const auto pixel = [&](int x, int y)
+        {
+            const unsigned char* p = img.bytes().data() + 4*(img.width()*(img.
+                height() - 1 - y) + x);
+            return std::array<int, 3>{p[0], p[1], p[2]};
+        };
+        if(pixel(4, 4) != std::array<int, 3>{255, 0, 0} || pixel(20, 16) !=
+            std::array<int, 3>{255, 255, 255} || pixel(28, 16) != std::array<
+            int, 3>{0, 0, 0} || pixel(28, 28) != std::array<int, 3>{255, 255,
+            255})
+        {
+            throw std::runtime_error("Text batch glyphs are misplaced.");
+        }
+    }
+    CATCH
+
+    try
+    {
+        const auto solid = [](int width, int height, const std::array<unsigned
+            char, 4>& c)
+        {
+            paz::Image img(paz::ImageFormat::RGBA8UNorm, width, height);
+            for(int i = 0; i < width*height; ++i)
+            {
+                std::copy(c.begin(), c.end(), img.bytes().begin() + 4*i);
+            }
+            return img;
+        };
+        const std::vector<paz::Image> images = {solid(2, 2, {255, 0, 0, 255}),
+            solid(3, 1, {0, 255, 0, 255}), solid(1, 4, {0, 0, 255, 255}), solid(
+            4, 4, {255, 255, 255, 255})};
+        EXPECT_EXCEPTION(paz::SpriteBatch(images, 3))
+        EXPECT_EXCEPTION(paz::SpriteBatch({paz::Image(paz::ImageFormat::
+            R8UNorm, 1, 1)}))
+
+        // The white square fills a page on its own.
+        paz::SpriteBatch sprites(images, 4);
+        if(sprites.numPages() != 2)
+        {
+            throw std::runtime_error("Sprites were not packed into two atlas pa"
+                "ges.");
+        }
+        EXPECT_EXCEPTION(sprites.add(images.size(), 0.f, 0.f))
+        sprites.add(0, 10.f, 10.f, 4.f);
+        sprites.add(2, 30.f, 10.f, 2.f, 0.f, {1.f, 1.f, 1.f, 1.f}, paz::
+            BlendMode::One_One);
+        sprites.add(3, 50.f, 10.f, 2.f);
+        sprites.add(1, 10.f, 30.f, 4.f, 0.f, {0.5f, 0.5f, 0.5f, 1.f});
+        if(sprites.size() != 4)
+        {
+            throw std::runtime_error("Wrong number of sprites in sprite batch.")
+                ;
+        }
+        paz::Window::EndFrame();
+        sprites.draw(paz::LoadAction::Clear);
+        paz::Window::EndFrame();
+        const auto stats = paz::Window::FrameStatistics();
+        if(sprites.size() || stats.draws != 3 || stats.instances != 4)
+        {
+            throw std::runtime_error("Sprites were not drawn in one call per pa"
+                "ge and blend mode.");
+        }
+
+        const paz::Image img = paz::Window::ReadPixels();
+        const auto pixel = [&](int x, int y)
+        {
+            const unsigned char* p = img.bytes().data() + 4*(img.width()*y + x);
+            return std::array<int, 3>{p[0], p[1], p[2]};
+        };
+        if(pixel(10, 10) != std::array<int, 3>{255, 0, 0} || pixel(30, 13) !=
+            std::array<int, 3>{0, 0, 255} || pixel(32, 10) != std::array<int,
+            3>{0, 0, 0} || pixel(53, 13) != std::array<int, 3>{255, 255, 255} ||
+            pixel(15, 30)[1] <= 0 || pixel(15, 30)[1] >= 255 || pixel(10, 33)
+            != std::array<int, 3>{0, 0, 0})
+        {
+            throw std::runtime_error("Sprites are misplaced.");
+        }
+    }
+    CATCH
+
+    try
+    {
+        paz::RenderTarget scaled(paz::TextureFormat::RGBA8UNorm, 0.5);
+        const auto resized = [&]()
+        {
+            scenePass.begin();
+            scenePass.end();
+            paz::Window::EndFrame();
+            return paz::Window::FrameStatistics().texturesResized;
+        };
+        resized();
+
+        // Resizes within a frame reallocate each target once.
+        paz::Window::Resize(ImgRes + 20, ImgRes + 20, true);
+        const auto once = resized();
+        paz::Window::Resize(ImgRes + 40, ImgRes, true);
+        paz::Window::Resize(ImgRes, ImgRes + 40, true);
+        paz::Window::Resize(ImgRes + 60, ImgRes + 60, true);
+        if(!once || resized() != once)
+        {
+            throw std::runtime_error("Resizes within a frame were not coalesce"
+                "d.");
+        }
+        if(scaled.width() != (ImgRes + 60)/2 || scaled.allocatedWidth() !=
+            scaled.width())
+        {
+            throw std::runtime_error("Scaled target has wrong size.");
+        }
+
+        // Grow-only targets keep their allocation when the window shrinks.
+        paz::Window::EnableGrowOnlyTargets();
+        paz::Window::Resize(ImgRes, ImgRes, true);
+        const auto shrunk = resized();
+        paz::Window::DisableGrowOnlyTargets();
+        if(shrunk >= once || scaled.width() != ImgRes/2 || scaled.height() !=
+            ImgRes/2 || scaled.allocatedWidth() != (ImgRes + 60)/2 || scaled.
+            allocatedHeight() != (ImgRes + 60)/2)
+        {
+            throw std::runtime_error("Grow-only target was reallocated to shri"
+                "nk.");
+        }
+    }
+    CATCH
+
+    EXPECT_EXCEPTION(paz::Window::WaitEvents(-1.))
+    EXPECT_EXCEPTION(paz::Window::SetMaxFramesInFlight(-1))
+    EXPECT_EXCEPTION(paz::Window::SetFrameRateLimit(-1.))
+    EXPECT_EXCEPTION(paz::Window::SetBackgroundFrameRate(-1.))
+
+#ifdef PAZ_HEADLESS
+    try
+    {
+        // Render the shadow map again with one independent context per thread.
+        const auto centerDepth = [](const paz::Texture& t)
+        {
+            const paz::Image img = t.readAsync(ShadowRes/2, ShadowRes/2, 1, 1).
+                get();
+            float d;
+            std::memcpy(&d, img.bytes().data(), sizeof(float));
+            return d;
+        };
+        const float expected = centerDepth(shadowMap);
+        std::array<float, 2> depths = {};
+        std::array<std::string, 2> errors;
+        std::vector<std::thread> threads;
+        for(std::size_t i = 0; i < depths.size(); ++i)
+        {
+            threads.emplace_back([&, i]()
+            {
+                try
+                {
+                    paz::VertexBuffer ground;
+                    ground.addAttribute(4, GroundPos);
+                    ground.addAttribute(4, GroundNor);
+                    ground.addAttribute(2, GroundUv);
+                    paz::VertexBuffer cube;
+                    cube.addAttribute(4, CubePos);
+                    cube.addAttribute(4, CubeNor);
+                    cube.addAttribute(2, CubeUv);
+                    depths[i] = centerDepth(compute_shadow_map(ground, cube));
+                }
+                catch(const std::exception& e)
+                {
+                    errors[i] = e.what();
+                }
+            });
+        }
+        for(auto& n : threads)
+        {
+            n.join();
+        }
+        for(std::size_t i = 0; i < depths.size(); ++i)
+        {
+            if(!errors[i].empty())
+            {
+                throw std::runtime_error(errors[i]);
+            }
+            if(std::abs(depths[i] - expected) > Eps)
+            {
+                throw std::runtime_error("Threaded render does not match.");
+            }
+        }
     }
     CATCH
+#endif
 }
@@ -0,0 +1,163 @@
+#include "PAZ_Graphics"
+#include "common.hpp"
+#include "internal_data.hpp"
+#include <algorithm>
+#include <cctype>
+
+static constexpr float LineSpacing = 1.5f;
+
+static const std::string VertSrc = 1 + R"===(
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec4 cell [[instance]];
+layout(location = 2) in vec4 color [[instance]];
+
+uniform vec2 cellSize;
+uniform float lineSpacing;
+uniform float numGlyphs;
+
+out vec2 uv;
+out vec4 glyphColor;
+
+void main()
+{
+    uv = 0.5*position + 0.5;
+    gl_Position = vec4((cell.x + uv.x)*cellSize.x - 1., 1. - (lineSpacing*
+        cell.y + 1. - uv.y)*cellSize.y, 0., 1.);
+    uv.x = (uv.x + cell.z)/numGlyphs;
+    glyphColor = color;
+}
+)===";
+
+static const std::string FragSrc = 1 + R"===(
+uniform sampler2D font;
+
+in vec2 uv;
+in vec4 glyphColor;
+
+layout(location = 0) out vec4 color;
+
+void main()
+{
+    float c = texture(font, uv).x;
+    color = vec4(c*glyphColor.rgb, c*glyphColor.a);
+}
+)===";
+
+paz::TextBatch::TextBatch() {}
+
+paz::TextBatch::TextBatch(const Framebuffer& fbo, const Texture& font, const
+    std::string& glyphs, int scale)
+{
+    if(glyphs.empty() || font.width()%glyphs.size())
+    {
+        throw std::invalid_argument("Font width must be a multiple of the numb"
+            "er of glyphs.");
+    }
+    if(scale < 1)
+    {
+        throw std::invalid_argument("Text scale must be positive.");
+    }
+    _data = std::make_shared<Data>();
+    _data->_pass = RenderPass(fbo, VertexFunction(VertSrc), FragmentFunction(
+        FragSrc), {BlendMode::One_InvSrcAlpha});
+    _data->_pass.setName("TextBatch");
+    _data->_font = font;
+    _data->_glyphIdx.fill(-1);
+    for(std::size_t i = 0; i < glyphs.size(); ++i)
+    {
+        _data->_glyphIdx[static_cast<unsigned char>(glyphs[i])] = i;
+    }
+    for(int i = 0; i < 256; ++i)
+    {
+        if(_data->_glyphIdx[i] < 0 && std::isalpha(i))
+        {
+            _data->_glyphIdx[i] = _data->_glyphIdx[std::islower(i) ? std::
+                toupper(i) : std::tolower(i)];
+        }
+    }
+    _data->_numGlyphs = glyphs.size();
+    _data->_scale = scale;
+}
+
+paz::TextBatch::TextBatch(const Texture& font, const std::string& glyphs, int
+    scale) : TextBatch(final_framebuffer(), font, glyphs, scale) {}
+
+void paz::TextBatch::add(const std::string& str, int row, int col, const std::
+    array<float, 4>& color)
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Text batch has not been initialized.");
+    }
+    int r = row;
+    int c = col;
+    for(const auto& n : str)
+    {
+        if(n == '\n')
+        {
+            ++r;
+            c = col;
+            continue;
+        }
+        const int idx = _data->_glyphIdx[static_cast<unsigned char>(n)];
+        if(idx >= 0)
+        {
+            _data->_cells.insert(_data->_cells.end(), {static_cast<float>(c),
+                static_cast<float>(r), static_cast<float>(idx), 0.f});
+            _data->_colors.insert(_data->_colors.end(), color.begin(), color.
+                end());
+        }
+        ++c;
+    }
+}
+
+void paz::TextBatch::draw(LoadAction colorLoadAction)
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Text batch has not been initialized.");
+    }
+    PAZ_PROFILE("TextBatch::draw");
+    const std::size_t n = size();
+    if(!n && colorLoadAction == LoadAction::Load)
+    {
+        return;
+    }
+
+    if(n)
+    {
+        reserve_instances(_data->_instances, n, 2);
+        _data->_instances.streamAttribute(0, _data->_cells);
+        _data->_instances.streamAttribute(1, _data->_colors);
+    }
+
+    const Framebuffer fbo = _data->_pass.framebuffer();
+    const float glyphWidth = _data->_font.width()/_data->_numGlyphs;
+    _data->_pass.begin({colorLoadAction});
+    _data->_pass.read("font", _data->_font);
+    _data->_pass.uniform("cellSize", 2.f*_data->_scale*glyphWidth/fbo.width(),
+        2.f*_data->_scale*_data->_font.height()/fbo.height());
+    _data->_pass.uniform("lineSpacing", LineSpacing);
+    _data->_pass.uniform("numGlyphs", static_cast<float>(_data->_numGlyphs));
+    if(n)
+    {
+        _data->_pass.draw(PrimitiveType::TriangleStrip, quad_vertices(),
+            _data->_instances);
+    }
+    _data->_pass.end();
+    clear();
+}
+
+void paz::TextBatch::clear()
+{
+    if(_data)
+    {
+        _data->_cells.clear();
+        _data->_colors.clear();
+    }
+}
+
+std::size_t paz::TextBatch::size() const
+{
+    return _data ? _data->_cells.size()/4 : 0;
+}
@@ -0,0 +1,61 @@
+#include "PAZ_Graphics"
+#include "common.hpp"
+#include "internal_data.hpp"
+#include <algorithm>
+
+paz::TextureUpload::TextureUpload() {}
+
+unsigned char* paz::TextureUpload::row(int i) const
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Texture upload is empty.");
+    }
+    if(i < 0 || i >= _data->_height)
+    {
+        throw std::out_of_range("Row " + std::to_string(i) + " is out of range."
+            );
+    }
+    return _data->_firstRow + _data->_rowStride*i;
+}
+
+std::size_t paz::TextureUpload::bytesPerRow() const
+{
+    return _data ? _data->_bytesPerRow : 0;
+}
+
+int paz::TextureUpload::height() const
+{
+    return _data ? _data->_height : 0;
+}
+
+bool paz::TextureUpload::empty() const
+{
+    return !_data;
+}
+
+void paz::Texture::uploadAsync(const void* data, std::size_t rowPitch)
+{
+    TextureUpload upload = mapUpload();
+    const std::size_t bytesPerRow = upload.bytesPerRow();
+    rowPitch = check_row_pitch(rowPitch, bytesPerRow, bytesPerRow/_data->
+        _width);
+    for(int i = 0; i < upload.height(); ++i)
+    {
+        const unsigned char* src = static_cast<const unsigned char*>(data) +
+            rowPitch*i;
+        std::copy(src, src + bytesPerRow, upload.row(i));
+    }
+    commit(upload);
+}
+
+void paz::Texture::uploadAsync(const ImageView& image)
+{
+    if(!_data || image.width() != _data->_width || image.height() != _data->
+        _height || static_cast<TextureFormat>(image.format()) != _data->_format)
+    {
+        throw std::runtime_error("Image format and dimensions must match textur"
+            "e.");
+    }
+    uploadAsync(image.data(), image.rowPitch());
+}
@@ -7,9 +7,36 @@
 #include "internal_data.hpp"
 #include "common.hpp"
 #include "gl_core_4_1.h"
+#include <algorithm>
 
 #define CASE(a, b) case paz::WrapMode::a: return GL_##b;
 
+struct UnpackBuffer
+{
+    GLuint _id = 0;
+    std::size_t _size = 0;
+    GLsync _fence = nullptr;
+    bool _mapped = false;
+};
+
+static constexpr std::size_t MaxUnpackBuffers = 32;
+
+static PAZ_CONTEXT_LOCAL std::vector<UnpackBuffer> _unpackBuffers;
+static PAZ_CONTEXT_LOCAL std::size_t _nextUnpackBuffer;
+
+struct PackBuffer
+{
+    GLuint _id = 0;
+    std::size_t _size = 0;
+    void* _owner = nullptr;
+};
+
+static constexpr std::size_t MaxPackBuffers = 32;
+
+static PAZ_CONTEXT_LOCAL std::vector<PackBuffer> _packBuffers;
+static PAZ_CONTEXT_LOCAL std::size_t _nextPackBuffer;
+static PAZ_CONTEXT_LOCAL GLuint _readFbo;
+
 static GLint wrap_mode(paz::WrapMode m)
 {
     switch(m)
@@ -23,6 +50,96 @@ static GLint wrap_mode(paz::WrapMode m)
     throw std::logic_error("Invalid texture wrapping mode requested.");
 }
 
+static void set_sampler_params(GLenum target, paz::MinMagFilter minFilter, paz::
+    MinMagFilter magFilter, paz::MipmapFilter mipFilter, paz::WrapMode wrapS,
+    paz::WrapMode wrapT)
+{
+    if(mipFilter == paz::MipmapFilter::Anisotropic)
+    {
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameterf(target, GL_TEXTURE_MAX_ANISOTROPY_EXT, paz::Window::
+            MaxAnisotropy());
+    }
+    else
+    {
+        const auto filters = paz::min_mag_filter(minFilter, magFilter,
+            mipFilter);
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, filters.first);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, filters.second);
+    }
+    glTexParameteri(target, GL_TEXTURE_WRAP_S, wrap_mode(wrapS));
+    glTexParameteri(target, GL_TEXTURE_WRAP_T, wrap_mode(wrapT));
+}
+
+static bool is_signaled(GLsync fence)
+{
+    GLint status;
+    glGetSynciv(fence, GL_SYNC_STATUS, 1, nullptr, &status);
+    return status == GL_SIGNALED;
+}
+
+static std::size_t acquire_unpack_buffer(std::size_t size)
+{
+    // Reuse a buffer whose previous transfer has completed, if possible.
+    for(std::size_t i = 0; i < _unpackBuffers.size(); ++i)
+    {
+        auto& n = _unpackBuffers[i];
+        if(!n._mapped && n._size >= size && (!n._fence || is_signaled(n.
+            _fence)))
+        {
+            if(n._fence)
+            {
+                glDeleteSync(n._fence);
+                n._fence = nullptr;
+            }
+            return i;
+        }
+    }
+
+    // Grow the pool, or wait for the oldest unmapped transfer if it is full.
+    std::size_t idx;
+    if(_unpackBuffers.size() < MaxUnpackBuffers)
+    {
+        idx = _unpackBuffers.size();
+        _unpackBuffers.emplace_back();
+        glGenBuffers(1, &_unpackBuffers.back()._id);
+    }
+    else
+    {
+        std::size_t i = 0;
+        while(i < MaxUnpackBuffers && _unpackBuffers[_nextUnpackBuffer].
+            _mapped)
+        {
+            _nextUnpackBuffer = (_nextUnpackBuffer + 1)%MaxUnpackBuffers;
+            ++i;
+        }
+        if(i == MaxUnpackBuffers)
+        {
+            throw std::runtime_error("Too many texture uploads are mapped.");
+        }
+        idx = _nextUnpackBuffer;
+        _nextUnpackBuffer = (_nextUnpackBuffer + 1)%MaxUnpackBuffers;
+        auto& buf = _unpackBuffers[idx];
+        if(buf._fence)
+        {
+            glClientWaitSync(buf._fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                GL_TIMEOUT_IGNORED);
+            glDeleteSync(buf._fence);
+            buf._fence = nullptr;
+        }
+    }
+    auto& buf = _unpackBuffers[idx];
+    if(buf._size < size)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buf._id);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        buf._size = size;
+    }
+    return idx;
+}
+
 paz::Texture::Data::~Data()
 {
     if(_isRenderTarget)
@@ -77,8 +194,9 @@ paz::Texture::Texture(TextureFormat format, int width, int height, const void*
     _data->init(data);
 }
 
-paz::Texture::Texture(const Image& image, MinMagFilter minFilter, MinMagFilter
-    magFilter, MipmapFilter mipFilter, WrapMode wrapS, WrapMode wrapT)
+paz::Texture::Texture(const ImageView& image, MinMagFilter minFilter,
+    MinMagFilter magFilter, MipmapFilter mipFilter, WrapMode wrapS, WrapMode
+    wrapT)
 {
     initialize();
 
@@ -91,14 +209,316 @@ paz::Texture::Texture(const Image& image, MinMagFilter minFilter, MinMagFilter
     _data->_mipFilter = mipFilter;
     _data->_wrapS = wrapS;
     _data->_wrapT = wrapT;
-    _data->init(image.bytes().data());
+    const std::size_t rowPitch = check_row_pitch(image.rowPitch(),
+        bytes_per_pixel(_data->_format)*image.width(), bytes_per_pixel(_data->
+        _format));
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, rowPitch/bytes_per_pixel(_data->
+        _format));
+    _data->init(image.data());
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 }
 
 paz::Texture::Texture(RenderTarget&& target) : _data(std::move(target._data)) {}
 
+paz::TextureUpload paz::Texture::mapUpload()
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Texture has not been initialized.");
+    }
+    if(is_compressed(_data->_format))
+    {
+        throw std::logic_error("Block-compressed textures cannot be updated.");
+    }
+
+    const std::size_t bytesPerRow = bytes_per_pixel(_data->_format)*_data->
+        _width;
+    const std::size_t size = bytesPerRow*_data->_height;
+    const std::size_t idx = acquire_unpack_buffer(size);
+    auto& buf = _unpackBuffers[idx];
+
+    // The buffer is idle, so mapping it does not need to synchronize. The
+    // pointer stays valid on any thread until the buffer is unmapped.
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buf._id);
+    void* ptr = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+        GL_MAP_WRITE_BIT|GL_MAP_INVALIDATE_RANGE_BIT|
+        GL_MAP_UNSYNCHRONIZED_BIT);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if(!ptr)
+    {
+        throw std::runtime_error("Failed to map pixel unpack buffer.");
+    }
+    buf._mapped = true;
+
+    TextureUpload upload;
+    upload._data = std::make_shared<TextureUpload::Data>();
+    upload._data->_buffer = idx;
+    upload._data->_texture = _data;
+    upload._data->_width = _data->_width;
+    upload._data->_height = _data->_height;
+    upload._data->_bytesPerRow = bytesPerRow;
+    upload._data->_firstRow = static_cast<unsigned char*>(ptr);
+    upload._data->_rowStride = bytesPerRow;
+    return upload;
+}
+
+void paz::Texture::commit(TextureUpload& upload)
+{
+    if(!_data || !upload._data || upload._data->_texture != _data)
+    {
+        throw std::logic_error("Upload was not mapped from this texture.");
+    }
+    if(upload._data->_width != _data->_width || upload._data->_height !=
+        _data->_height)
+    {
+        throw std::runtime_error("Texture was resized after upload was mapped."
+            );
+    }
+    auto& buf = _unpackBuffers[upload._data->_buffer];
+    const std::size_t size = upload._data->_bytesPerRow*_data->_height;
+    upload._data->_done = true;
+    upload._data.reset();
+    buf._mapped = false;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buf._id);
+    if(!glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER))
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        throw std::runtime_error("Pixel unpack buffer was corrupted.");
+    }
+
+    // Queue the transfer from the buffer without waiting for it.
+    frame_stats().bytesUploaded += size;
+    glBindTexture(GL_TEXTURE_2D, _data->_id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _data->_width, _data->_height,
+        gl_format(_data->_format), gl_type(_data->_format), nullptr);
+    buf._fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    _data->_mipmapsDirty = _data->_mipFilter != MipmapFilter::None;
+}
+
+paz::TextureUpload::Data::~Data()
+{
+    if(!_done)
+    {
+        auto& buf = _unpackBuffers[_buffer];
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buf._id);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        buf._mapped = false;
+    }
+}
+
+void paz::Texture::sub(int x, int y, int width, int height, const void* data,
+    std::size_t rowPitch)
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Texture has not been initialized.");
+    }
+    if(is_compressed(_data->_format))
+    {
+        throw std::logic_error("Block-compressed textures cannot be updated.");
+    }
+    if(x < 0 || y < 0 || width < 0 || height < 0 || x + width > _data->_width ||
+        y + height > _data->_height)
+    {
+        throw std::out_of_range("Region is out of texture bounds.");
+    }
+    const std::size_t bytesPerRow = bytes_per_pixel(_data->_format)*width;
+    rowPitch = check_row_pitch(rowPitch, bytesPerRow, bytes_per_pixel(_data->
+        _format));
+    if(!width || !height)
+    {
+        return;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, _data->_id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, rowPitch/bytes_per_pixel(_data->
+        _format));
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, gl_format(_data->
+        _format), gl_type(_data->_format), data);
+    frame_stats().bytesUploaded += bytesPerRow*height;
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    // Mipmaps are regenerated once, when the texture is next read.
+    _data->_mipmapsDirty = _data->_mipFilter != MipmapFilter::None;
+}
+
+void paz::Texture::sub(int x, int y, const ImageView& image)
+{
+    if(!_data || static_cast<TextureFormat>(image.format()) != _data->_format)
+    {
+        throw std::runtime_error("Image format must match texture.");
+    }
+    sub(x, y, image.width(), image.height(), image.data(), image.rowPitch());
+}
+
+paz::ReadbackRequest paz::Texture::readAsync(int x, int y, int width, int
+    height) const
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Texture has not been initialized.");
+    }
+    const ImageFormat format = readback_format(_data->_format);
+    if(x < 0 || y < 0 || width < 0 || height < 0 || x + width > _data->_width ||
+        y + height > _data->_height)
+    {
+        throw std::out_of_range("Region is out of texture bounds.");
+    }
+
+    ReadbackRequest req;
+    req._data = std::make_shared<ReadbackRequest::Data>();
+    req._data->_result = Image(format, width, height);
+    if(!width || !height)
+    {
+        req._data->_done = true;
+        return req;
+    }
+    _data->queueRead(*req._data, x, y, width, height, req._data->_result.
+        bytes().size());
+
+    return req;
+}
+
+void paz::Texture::Data::queueRead(ReadbackRequest::Data& req, int x, int y,
+    int width, int height, std::size_t size) const
+{
+    req.acquire(size);
+
+    // Queue the copy into the pack buffer without waiting for it.
+    if(!_readFbo)
+    {
+        glGenFramebuffers(1, &_readFbo);
+    }
+    const bool isDepth = _format == TextureFormat::Depth16UNorm || _format ==
+        TextureFormat::Depth32Float;
+    const GLenum attachment = isDepth ? GL_DEPTH_ATTACHMENT :
+        GL_COLOR_ATTACHMENT0;
+    glGetError();
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, _readFbo);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, attachment, GL_TEXTURE_2D, _id,
+        0);
+    glReadBuffer(isDepth ? GL_NONE : GL_COLOR_ATTACHMENT0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, _packBuffers[req._buffer]._id);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(x, y, width, height, gl_format(_format), gl_type(_format),
+        nullptr);
+    req._fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, attachment, GL_TEXTURE_2D, 0,
+        0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    const GLenum error = glGetError();
+    if(error != GL_NO_ERROR)
+    {
+        throw std::runtime_error("Error reading texture: " + gl_error(error) +
+            ".");
+    }
+}
+
+paz::ReadbackRequest::Data::~Data()
+{
+    if(_fence)
+    {
+        glDeleteSync(static_cast<GLsync>(_fence));
+    }
+    if(_buffer < _packBuffers.size() && _packBuffers[_buffer]._owner == this)
+    {
+        _packBuffers[_buffer]._owner = nullptr;
+    }
+}
+
+void paz::ReadbackRequest::Data::acquire(std::size_t size)
+{
+    // Prefer an idle buffer that is already large enough.
+    _buffer = _packBuffers.size();
+    for(std::size_t i = 0; i < _packBuffers.size(); ++i)
+    {
+        if(!_packBuffers[i]._owner)
+        {
+            _buffer = i;
+            if(_packBuffers[i]._size >= size)
+            {
+                break;
+            }
+        }
+    }
+
+    // Grow the pool, or complete the next request in turn if it is full.
+    if(_buffer == _packBuffers.size())
+    {
+        if(_packBuffers.size() < MaxPackBuffers)
+        {
+            _packBuffers.emplace_back();
+            glGenBuffers(1, &_packBuffers.back()._id);
+        }
+        else
+        {
+            _buffer = _nextPackBuffer;
+            _nextPackBuffer = (_nextPackBuffer + 1)%MaxPackBuffers;
+            static_cast<Data*>(_packBuffers[_buffer]._owner)->complete();
+        }
+    }
+    auto& buf = _packBuffers[_buffer];
+    if(buf._size < size)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buf._id);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        buf._size = size;
+    }
+    buf._owner = this;
+}
+
+bool paz::ReadbackRequest::Data::poll()
+{
+    const GLenum status = glClientWaitSync(static_cast<GLsync>(_fence),
+        GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
+
+const void* paz::ReadbackRequest::Data::map()
+{
+    glClientWaitSync(static_cast<GLsync>(_fence), GL_SYNC_FLUSH_COMMANDS_BIT,
+        GL_TIMEOUT_IGNORED);
+    glDeleteSync(static_cast<GLsync>(_fence));
+    _fence = nullptr;
+
+    const auto& buf = _packBuffers[_buffer];
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buf._id);
+    const void* ptr = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, buf._size,
+        GL_MAP_READ_BIT);
+    if(!ptr)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        throw std::runtime_error("Failed to map pixel pack buffer.");
+    }
+    return ptr;
+}
+
+void paz::ReadbackRequest::Data::unmap()
+{
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    _packBuffers[_buffer]._owner = nullptr;
+}
+
+void paz::ReadbackRequest::Data::finish()
+{
+    const auto* ptr = static_cast<const unsigned char*>(map());
+    std::copy(ptr, ptr + _result.bytes().size(), _result.bytes().begin());
+    unmap();
+}
+
 void paz::Texture::Data::init(const void* data)
 {
-    // Textures not for rendering are static (for now).
+    PAZ_PROFILE("Texture::Texture");
+
+    // Textures not for rendering must be created with data.
     if(!_isRenderTarget && !data)
     {
         throw std::logic_error("Cannot initialize static texture without data."
@@ -113,40 +533,77 @@ void paz::Texture::Data::init(const void* data)
             "ing.");
     }
 
+    if(is_compressed(_format))
+    {
+        if(_isRenderTarget)
+        {
+            throw std::logic_error("Cannot render to block-compressed texture."
+                );
+        }
+        if(_mipFilter != MipmapFilter::None)
+        {
+            throw std::runtime_error("Block-compressed textures do not support "
+                "mipmapping.");
+        }
+        if(_width%4 || _height%4)
+        {
+            throw std::invalid_argument("Block-compressed textures must have d"
+                "imensions that are multiples of four.");
+        }
+
+        // Only RGTC (BC4 and BC5) is core in OpenGL 4.1.
+        if((_format == TextureFormat::BC1RGBAUNorm || _format == TextureFormat::
+            BC3RGBAUNorm) && ogl_ext_EXT_texture_compression_s3tc !=
+            ogl_LOAD_SUCCEEDED)
+        {
+            throw std::runtime_error("S3TC texture compression is not supporte"
+                "d.");
+        }
+        if(_format == TextureFormat::BC7RGBAUNorm &&
+            ogl_ext_ARB_texture_compression_bptc != ogl_LOAD_SUCCEEDED)
+        {
+            throw std::runtime_error("BPTC texture compression is not supporte"
+                "d.");
+        }
+    }
+
     glGenTextures(1, &_id);
     glBindTexture(GL_TEXTURE_2D, _id);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexImage2D(GL_TEXTURE_2D, 0, gl_internal_format(_format), _width, _height,
-        0, gl_format(_format), gl_type(_format), data);
-    if(_mipFilter == MipmapFilter::Anisotropic)
-    {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-            GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, Window::
-            MaxAnisotropy());
+    if(data)
+    {
+        frame_stats().bytesUploaded += is_compressed(_format) ?
+            compressed_size(_format, _width, _height) : bytes_per_pixel(_format)*
+            _width*_height;
+    }
+    if(is_compressed(_format))
+    {
+        glCompressedTexImage2D(GL_TEXTURE_2D, 0, gl_internal_format(_format),
+            _width, _height, 0, compressed_size(_format, _width, _height),
+            data);
     }
     else
     {
-        const auto filters = min_mag_filter(_minFilter, _magFilter, _mipFilter);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filters.first);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filters.second);
+        glTexImage2D(GL_TEXTURE_2D, 0, gl_internal_format(_format), _width,
+            _height, 0, gl_format(_format), gl_type(_format), data);
+    }
+    set_sampler_params(GL_TEXTURE_2D, _minFilter, _magFilter, _mipFilter,
+        _wrapS, _wrapT);
+    if(_maxMipLevel >= 0)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, _maxMipLevel);
     }
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap_mode(_wrapS));
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap_mode(_wrapT));
 
     ensureMipmaps();
 }
 
 void paz::Texture::Data::resize(int width, int height)
 {
-    if(_scale)
+    if(_scale && updateSize(width, height))
     {
-        _width = _scale*width;
-        _height = _scale*height;
         glBindTexture(GL_TEXTURE_2D, _id);
-        glTexImage2D(GL_TEXTURE_2D, 0, gl_internal_format(_format), _width,
-            _height, 0, gl_format(_format), gl_type(_format), nullptr);
+        glTexImage2D(GL_TEXTURE_2D, 0, gl_internal_format(_format), _allocWidth,
+            _allocHeight, 0, gl_format(_format), gl_type(_format), nullptr);
         ensureMipmaps();
     }
 }
@@ -158,6 +615,16 @@ void paz::Texture::Data::ensureMipmaps()
         glBindTexture(GL_TEXTURE_2D, _id);
         glGenerateMipmap(GL_TEXTURE_2D);
     }
+    _mipmapsDirty = false;
+}
+
+void paz::Texture::Data::setMaxMipLevel(int level)
+{
+    _maxMipLevel = level;
+    glBindTexture(GL_TEXTURE_2D, _id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, _maxMipLevel < 0 ?
+        1000 : _maxMipLevel);
+    _mipmapsDirty = true;
 }
 
 int paz::Texture::width() const
@@ -170,4 +637,133 @@ int paz::Texture::height() const
     return _data ? _data->_height : 0;
 }
 
+int paz::Texture::allocatedWidth() const
+{
+    return _data ? std::max(_data->_width, _data->_allocWidth) : 0;
+}
+
+int paz::Texture::allocatedHeight() const
+{
+    return _data ? std::max(_data->_height, _data->_allocHeight) : 0;
+}
+
+paz::TextureArray::Data::~Data()
+{
+    if(_id)
+    {
+        glDeleteTextures(1, &_id);
+    }
+}
+
+paz::TextureArray::TextureArray()
+{
+    initialize();
+}
+
+paz::TextureArray::TextureArray(TextureFormat format, int width, int height, int
+    layers, MinMagFilter minFilter, MinMagFilter magFilter, MipmapFilter
+    mipFilter, WrapMode wrapS, WrapMode wrapT)
+{
+    initialize();
+
+    PAZ_PROFILE("TextureArray::TextureArray");
+
+    if(layers < 1)
+    {
+        throw std::invalid_argument("Texture array must have at least one layer"
+            ".");
+    }
+    if(is_compressed(format))
+    {
+        throw std::logic_error("Texture arrays do not support block-compressed "
+            "formats.");
+    }
+    if((format == TextureFormat::Depth16UNorm || format == TextureFormat::
+        Depth32Float) && mipFilter != MipmapFilter::None)
+    {
+        throw std::runtime_error("Depth/stencil textures do not support mipmapp"
+            "ing.");
+    }
+
+    _data = std::make_shared<Data>();
+    _data->_width = width;
+    _data->_height = height;
+    _data->_layers = layers;
+    _data->_format = format;
+    _data->_mipFilter = mipFilter;
+
+    glGenTextures(1, &_data->_id);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, _data->_id);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, gl_internal_format(format), width,
+        height, layers, 0, gl_format(format), gl_type(format), nullptr);
+    set_sampler_params(GL_TEXTURE_2D_ARRAY, minFilter, magFilter, mipFilter,
+        wrapS, wrapT);
+    _data->_mipmapsDirty = mipFilter != MipmapFilter::None;
+}
+
+void paz::TextureArray::sub(int layer, const void* data, std::size_t
+    rowPitch)
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Texture array has not been initialized.");
+    }
+    if(layer < 0 || layer >= _data->_layers)
+    {
+        throw std::out_of_range("Layer is out of bounds.");
+    }
+
+    rowPitch = check_row_pitch(rowPitch, bytes_per_pixel(_data->_format)*
+        _data->_width, bytes_per_pixel(_data->_format));
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, _data->_id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, rowPitch/bytes_per_pixel(_data->
+        _format));
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, _data->_width, _data->
+        _height, 1, gl_format(_data->_format), gl_type(_data->_format), data);
+    frame_stats().bytesUploaded += bytes_per_pixel(_data->_format)*_data->
+        _width*_data->_height;
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    // Mipmaps are regenerated the next time the array is read.
+    _data->_mipmapsDirty = _data->_mipFilter != MipmapFilter::None;
+}
+
+void paz::TextureArray::sub(int layer, const ImageView& image)
+{
+    if(!_data || image.width() != _data->_width || image.height() != _data->
+        _height || static_cast<TextureFormat>(image.format()) != _data->_format)
+    {
+        throw std::runtime_error("Image format and dimensions must match textur"
+            "e array.");
+    }
+    sub(layer, image.data(), image.rowPitch());
+}
+
+void paz::TextureArray::Data::ensureMipmaps()
+{
+    if(_mipFilter != MipmapFilter::None)
+    {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, _id);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    }
+    _mipmapsDirty = false;
+}
+
+int paz::TextureArray::width() const
+{
+    return _data ? _data->_width : 0;
+}
+
+int paz::TextureArray::height() const
+{
+    return _data ? _data->_height : 0;
+}
+
+int paz::TextureArray::layers() const
+{
+    return _data ? _data->_layers : 0;
+}
+
 #endif
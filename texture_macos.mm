@@ -9,6 +9,7 @@
 #include "internal_data.hpp"
 #include "common.hpp"
 #import <MetalKit/MetalKit.h>
+#include <algorithm>
 
 #define RENDERER static_cast<Renderer*>([static_cast<ViewController*>( \
     [[static_cast<AppDelegate*>([NSApp delegate]) window] \
@@ -18,6 +19,29 @@
 
 #define CASE(a, b) case paz::WrapMode::a: return MTLSamplerAddressMode##b;
 
+struct StagingBuffer
+{
+    id<MTLBuffer> _buffer = nil;
+    id<MTLCommandBuffer> _lastUse = nil;
+    bool _mapped = false;
+};
+
+static constexpr std::size_t MaxStagingBuffers = 32;
+
+// Staging buffers and the command buffers that last used them.
+static std::vector<StagingBuffer> _stagingBuffers;
+
+struct ReadbackBuffer
+{
+    id<MTLBuffer> _buffer = nil;
+    void* _owner = nullptr;
+};
+
+static constexpr std::size_t MaxReadbackBuffers = 32;
+
+static std::vector<ReadbackBuffer> _readbackBuffers;
+static std::size_t _nextReadbackBuffer;
+
 static MTLSamplerMinMagFilter min_mag_filter(paz::MinMagFilter f)
 {
     switch(f)
@@ -75,6 +99,63 @@ static id<MTLSamplerState> create_sampler(paz::MinMagFilter minFilter, paz::
     return sampler;
 }
 
+// Sets `idx` to the buffer's place in the pool, or to `MaxStagingBuffers` if
+// the pool is full and busy, in which case the buffer is used once.
+static id<MTLBuffer> acquire_staging_buffer(std::size_t size, std::size_t& idx)
+{
+    // Reuse a buffer whose previous transfer has completed, preferring one that
+    // is already large enough.
+    idx = MaxStagingBuffers;
+    for(std::size_t i = 0; i < _stagingBuffers.size(); ++i)
+    {
+        const auto& n = _stagingBuffers[i];
+        if(n._mapped || (n._lastUse && [n._lastUse status] <
+            MTLCommandBufferStatusCompleted))
+        {
+            continue;
+        }
+        idx = i;
+        if([n._buffer length] >= size)
+        {
+            break;
+        }
+    }
+    if(idx == MaxStagingBuffers && _stagingBuffers.size() < MaxStagingBuffers)
+    {
+        idx = _stagingBuffers.size();
+        _stagingBuffers.emplace_back();
+    }
+    if(idx == MaxStagingBuffers)
+    {
+        return [DEVICE newBufferWithLength:size options:
+            MTLResourceStorageModeShared|MTLResourceCPUCacheModeWriteCombined];
+    }
+
+    auto& buf = _stagingBuffers[idx];
+    if(!buf._buffer || [buf._buffer length] < size)
+    {
+        [buf._buffer release];
+        buf._buffer = [DEVICE newBufferWithLength:size options:
+            MTLResourceStorageModeShared|MTLResourceCPUCacheModeWriteCombined];
+    }
+    return buf._buffer;
+}
+
+// Call after encoding the blit that reads `buf`. Command buffers retain the
+// resources they use, so a buffer used once can be released right away.
+static void release_staging_buffer(std::size_t idx, id<MTLBuffer> buf)
+{
+    if(idx == MaxStagingBuffers)
+    {
+        [buf release];
+        return;
+    }
+    auto& n = _stagingBuffers[idx];
+    [n._lastUse release];
+    n._lastUse = [[RENDERER commandBuffer] retain];
+    n._mapped = false;
+}
+
 paz::Texture::Data::~Data()
 {
     if(_isRenderTarget)
@@ -130,27 +211,24 @@ paz::Texture::Texture(TextureFormat format, int width, int height, const void*
     _data->_mipFilter = mipFilter;
     _data->_wrapS = wrapS;
     _data->_wrapT = wrapT;
-    if(height < 2)
+    if(!data || height < 2)
     {
         _data->init(data);
     }
+    else if(is_compressed(format))
+    {
+        _data->init(flip_blocks(format, data, width, height).get());
+    }
     else
     {
         const std::size_t bytesPerRow = paz::bytes_per_pixel(format)*width;
-        std::vector<unsigned char> flipped(bytesPerRow*height);
-        for(int i = 0; i < height; ++i)
-        {
-            std::copy(reinterpret_cast<const unsigned char*>(data) +
-                bytesPerRow*i, reinterpret_cast<const unsigned char*>(data) +
-                bytesPerRow*(i + 1), flipped.begin() + bytesPerRow*(height - i -
-                1));
-        }
-        _data->init(flipped.data());
+        _data->init(flip_rows(data, bytesPerRow, bytesPerRow, height).get());
     }
 }
 
-paz::Texture::Texture(const Image& image, MinMagFilter minFilter, MinMagFilter
-    magFilter, MipmapFilter mipFilter, WrapMode wrapS, WrapMode wrapT)
+paz::Texture::Texture(const ImageView& image, MinMagFilter minFilter,
+    MinMagFilter magFilter, MipmapFilter mipFilter, WrapMode wrapS, WrapMode
+    wrapT)
 {
     initialize();
 
@@ -163,14 +241,327 @@ paz::Texture::Texture(const Image& image, MinMagFilter minFilter, MinMagFilter
     _data->_mipFilter = mipFilter;
     _data->_wrapS = wrapS;
     _data->_wrapT = wrapT;
-    _data->init(flip_image(image).bytes().data());
+    const std::size_t bytesPerRow = bytes_per_pixel(_data->_format)*image.
+        width();
+    _data->init(flip_rows(image.data(), check_row_pitch(image.rowPitch(),
+        bytesPerRow, bytes_per_pixel(_data->_format)), bytesPerRow, image.
+        height()).get());
 }
 
 paz::Texture::Texture(RenderTarget&& target) : _data(std::move(target._data)) {}
 
+paz::TextureUpload paz::Texture::mapUpload()
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Texture has not been initialized.");
+    }
+    if(is_compressed(_data->_format))
+    {
+        throw std::logic_error("Block-compressed textures cannot be updated.");
+    }
+
+    const std::size_t bytesPerRow = bytes_per_pixel(_data->_format)*_data->
+        _width;
+    std::size_t idx;
+    id<MTLBuffer> staging = acquire_staging_buffer(bytesPerRow*_data->_height,
+        idx);
+    if(idx < MaxStagingBuffers)
+    {
+        _stagingBuffers[idx]._mapped = true;
+    }
+
+    TextureUpload upload;
+    upload._data = std::make_shared<TextureUpload::Data>();
+    upload._data->_buffer = staging;
+    upload._data->_index = idx;
+    upload._data->_texture = _data;
+    upload._data->_width = _data->_width;
+    upload._data->_height = _data->_height;
+    upload._data->_bytesPerRow = bytesPerRow;
+
+    // Rows are flipped by addressing them from the end of the buffer.
+    upload._data->_firstRow = static_cast<unsigned char*>([staging contents]) +
+        bytesPerRow*(_data->_height - 1);
+    upload._data->_rowStride = -static_cast<std::ptrdiff_t>(bytesPerRow);
+    return upload;
+}
+
+void paz::Texture::commit(TextureUpload& upload)
+{
+    if(!_data || !upload._data || upload._data->_texture != _data)
+    {
+        throw std::logic_error("Upload was not mapped from this texture.");
+    }
+    if(upload._data->_width != _data->_width || upload._data->_height !=
+        _data->_height)
+    {
+        throw std::runtime_error("Texture was resized after upload was mapped."
+            );
+    }
+
+    [RENDERER ensureCommandBuffer];
+
+    id<MTLBuffer> staging = static_cast<id<MTLBuffer>>(upload._data->_buffer);
+    const std::size_t idx = upload._data->_index;
+    const std::size_t bytesPerRow = upload._data->_bytesPerRow;
+    const std::size_t size = bytesPerRow*_data->_height;
+    upload._data->_done = true;
+    upload._data.reset();
+
+    id<MTLBlitCommandEncoder> blitEncoder = [[RENDERER commandBuffer]
+        blitCommandEncoder];
+    [blitEncoder copyFromBuffer:staging sourceOffset:0 sourceBytesPerRow:
+        bytesPerRow sourceBytesPerImage:size sourceSize:MTLSizeMake(_data->
+        _width, _data->_height, 1) toTexture:static_cast<id<MTLTexture>>(_data->
+        _texture) destinationSlice:0 destinationLevel:0 destinationOrigin:
+        MTLOriginMake(0, 0, 0)];
+    [blitEncoder endEncoding];
+    release_staging_buffer(idx, staging);
+    frame_stats().bytesUploaded += size;
+
+    _data->ensureMipmaps();
+}
+
+paz::TextureUpload::Data::~Data()
+{
+    if(!_done)
+    {
+        if(_index == MaxStagingBuffers)
+        {
+            [static_cast<id<MTLBuffer>>(_buffer) release];
+        }
+        else
+        {
+            _stagingBuffers[_index]._mapped = false;
+        }
+    }
+}
+
+void paz::Texture::sub(int x, int y, int width, int height, const void* data,
+    std::size_t rowPitch)
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Texture has not been initialized.");
+    }
+    if(is_compressed(_data->_format))
+    {
+        throw std::logic_error("Block-compressed textures cannot be updated.");
+    }
+    if(x < 0 || y < 0 || width < 0 || height < 0 || x + width > _data->_width ||
+        y + height > _data->_height)
+    {
+        throw std::out_of_range("Region is out of texture bounds.");
+    }
+    const std::size_t bytesPerRow = bytes_per_pixel(_data->_format)*width;
+    rowPitch = check_row_pitch(rowPitch, bytesPerRow, bytes_per_pixel(_data->
+        _format));
+    if(!width || !height)
+    {
+        return;
+    }
+
+    [RENDERER ensureCommandBuffer];
+
+    // Stage through a buffer so the copy is ordered with encoded commands.
+    const std::size_t size = bytesPerRow*height;
+    std::size_t idx;
+    id<MTLBuffer> staging = acquire_staging_buffer(size, idx);
+    unsigned char* dst = static_cast<unsigned char*>([staging contents]);
+    for(int i = 0; i < height; ++i)
+    {
+        std::copy(reinterpret_cast<const unsigned char*>(data) + rowPitch*i,
+            reinterpret_cast<const unsigned char*>(data) + rowPitch*i +
+            bytesPerRow, dst + bytesPerRow*(height - i - 1));
+    }
+
+    id<MTLBlitCommandEncoder> blitEncoder = [[RENDERER commandBuffer]
+        blitCommandEncoder];
+    [blitEncoder copyFromBuffer:staging sourceOffset:0 sourceBytesPerRow:
+        bytesPerRow sourceBytesPerImage:size sourceSize:MTLSizeMake(width,
+        height, 1) toTexture:static_cast<id<MTLTexture>>(_data->_texture)
+        destinationSlice:0 destinationLevel:0 destinationOrigin:MTLOriginMake(x,
+        _data->_height - y - height, 0)];
+    [blitEncoder endEncoding];
+    release_staging_buffer(idx, staging);
+    frame_stats().bytesUploaded += size;
+
+    _data->ensureMipmaps();
+}
+
+void paz::Texture::sub(int x, int y, const ImageView& image)
+{
+    if(!_data || static_cast<TextureFormat>(image.format()) != _data->_format)
+    {
+        throw std::runtime_error("Image format must match texture.");
+    }
+    sub(x, y, image.width(), image.height(), image.data(), image.rowPitch());
+}
+
+paz::ReadbackRequest paz::Texture::readAsync(int x, int y, int width, int
+    height) const
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Texture has not been initialized.");
+    }
+    const ImageFormat format = readback_format(_data->_format);
+    if(x < 0 || y < 0 || width < 0 || height < 0 || x + width > _data->_width ||
+        y + height > _data->_height)
+    {
+        throw std::out_of_range("Region is out of texture bounds.");
+    }
+
+    ReadbackRequest req;
+    req._data = std::make_shared<ReadbackRequest::Data>();
+    req._data->_result = Image(format, width, height);
+    if(!width || !height)
+    {
+        req._data->_done = true;
+        return req;
+    }
+
+    // Between frames the GPU is idle, so the copy can be submitted at once.
+    const bool betweenFrames = ![RENDERER commandBuffer];
+    id<MTLCommandBuffer> commandBuffer = betweenFrames ? [[RENDERER
+        commandQueue] commandBuffer] : [RENDERER commandBuffer];
+
+    const std::size_t bytesPerRow = bytes_per_pixel(_data->_format)*width;
+    req._data->acquire(bytesPerRow*height);
+    id<MTLBuffer> buf = static_cast<id<MTLBuffer>>(req._data->_buffer);
+    req._data->_commandBuffer = [commandBuffer retain];
+
+    // Grow-only targets keep their contents in the bottom rows.
+    const int allocHeight = std::max(_data->_height, _data->_allocHeight);
+    id<MTLBlitCommandEncoder> blitEncoder = [commandBuffer blitCommandEncoder];
+    [blitEncoder copyFromTexture:static_cast<id<MTLTexture>>(_data->_texture)
+        sourceSlice:0 sourceLevel:0 sourceOrigin:MTLOriginMake(x, allocHeight -
+        y - height, 0) sourceSize:MTLSizeMake(width, height, 1) toBuffer:buf
+        destinationOffset:0 destinationBytesPerRow:bytesPerRow
+        destinationBytesPerImage:bytesPerRow*height];
+    [blitEncoder endEncoding];
+    if(betweenFrames)
+    {
+        [commandBuffer commit];
+    }
+
+    return req;
+}
+
+paz::ReadbackRequest::Data::~Data()
+{
+    if(_index == MaxReadbackBuffers)
+    {
+        [static_cast<id<MTLBuffer>>(_buffer) release];
+    }
+    else if(_index < _readbackBuffers.size() && _readbackBuffers[_index].
+        _owner == this)
+    {
+        _readbackBuffers[_index]._owner = nullptr;
+    }
+    if(_commandBuffer)
+    {
+        [static_cast<id<MTLCommandBuffer>>(_commandBuffer) release];
+    }
+}
+
+// Sets `_index` to `MaxReadbackBuffers` if the pool is full and the next
+// request in turn cannot complete yet, in which case the buffer is used once.
+void paz::ReadbackRequest::Data::acquire(std::size_t size)
+{
+    // Prefer an idle buffer that is already large enough.
+    _index = MaxReadbackBuffers;
+    for(std::size_t i = 0; i < _readbackBuffers.size(); ++i)
+    {
+        if(!_readbackBuffers[i]._owner)
+        {
+            _index = i;
+            if([_readbackBuffers[i]._buffer length] >= size)
+            {
+                break;
+            }
+        }
+    }
+
+    // Grow the pool, or complete the next request in turn if it is full.
+    // Requests made during the current frame cannot complete before it ends.
+    if(_index == MaxReadbackBuffers)
+    {
+        if(_readbackBuffers.size() < MaxReadbackBuffers)
+        {
+            _index = _readbackBuffers.size();
+            _readbackBuffers.emplace_back();
+        }
+        else
+        {
+            Data* owner = static_cast<Data*>(_readbackBuffers[
+                _nextReadbackBuffer]._owner);
+            if([static_cast<id<MTLCommandBuffer>>(owner->_commandBuffer)
+                status] < MTLCommandBufferStatusCommitted)
+            {
+                _buffer = [DEVICE newBufferWithLength:size options:
+                    MTLResourceStorageModeShared];
+                return;
+            }
+            _index = _nextReadbackBuffer;
+            _nextReadbackBuffer = (_nextReadbackBuffer + 1)%MaxReadbackBuffers;
+            owner->complete();
+        }
+    }
+    auto& buf = _readbackBuffers[_index];
+    if(!buf._buffer || [buf._buffer length] < size)
+    {
+        [buf._buffer release];
+        buf._buffer = [DEVICE newBufferWithLength:size options:
+            MTLResourceStorageModeShared];
+    }
+    buf._owner = this;
+    _buffer = buf._buffer;
+}
+
+bool paz::ReadbackRequest::Data::poll()
+{
+    return [static_cast<id<MTLCommandBuffer>>(_commandBuffer) status] >=
+        MTLCommandBufferStatusCompleted;
+}
+
+void paz::ReadbackRequest::Data::finish()
+{
+    id<MTLCommandBuffer> commandBuffer = static_cast<id<MTLCommandBuffer>>(
+        _commandBuffer);
+    if([commandBuffer status] < MTLCommandBufferStatusCommitted)
+    {
+        throw std::logic_error("Cannot complete readback before ending frame.");
+    }
+    [commandBuffer waitUntilCompleted];
+
+    // Flip rows while copying out of the buffer.
+    const std::size_t bytesPerRow = _result.bytes().size()/_result.height();
+    const unsigned char* src = static_cast<const unsigned char*>([static_cast<
+        id<MTLBuffer>>(_buffer) contents]);
+    for(int i = 0; i < _result.height(); ++i)
+    {
+        std::copy(src + bytesPerRow*(_result.height() - i - 1), src +
+            bytesPerRow*(_result.height() - i), _result.bytes().begin() +
+            bytesPerRow*i);
+    }
+    if(_index == MaxReadbackBuffers)
+    {
+        [static_cast<id<MTLBuffer>>(_buffer) release];
+    }
+    else
+    {
+        _readbackBuffers[_index]._owner = nullptr;
+    }
+    _buffer = nullptr;
+}
+
 void paz::Texture::Data::init(const void* data)
 {
-    // Textures not for rendering are static (for now).
+    PAZ_PROFILE("Texture::Texture");
+
+    // Textures not for rendering must be created with data.
     if(!_isRenderTarget && !data)
     {
         throw std::logic_error("Cannot initialize static texture without data."
@@ -185,9 +576,34 @@ void paz::Texture::Data::init(const void* data)
             "ing.");
     }
 
+    if(is_compressed(_format))
+    {
+        if(_isRenderTarget)
+        {
+            throw std::logic_error("Cannot render to block-compressed texture."
+                );
+        }
+        if(_mipFilter != MipmapFilter::None)
+        {
+            throw std::runtime_error("Block-compressed textures do not support "
+                "mipmapping.");
+        }
+        if(_width%4 || _height%4)
+        {
+            throw std::invalid_argument("Block-compressed textures must have d"
+                "imensions that are multiples of four.");
+        }
+    }
+
     MTLTextureDescriptor* textureDescriptor = [MTLTextureDescriptor
-        texture2DDescriptorWithPixelFormat:pixel_format(_format) width:_width
-        height:_height mipmapped:(_mipFilter == MipmapFilter::None ? NO : YES)];
+        texture2DDescriptorWithPixelFormat:pixel_format(_format) width:std::
+        max(_width, _allocWidth) height:std::max(_height, _allocHeight)
+        mipmapped:(_mipFilter == MipmapFilter::None ? NO : YES)];
+    if(_maxMipLevel >= 0 && static_cast<NSUInteger>(_maxMipLevel) <
+        [textureDescriptor mipmapLevelCount])
+    {
+        [textureDescriptor setMipmapLevelCount:_maxMipLevel + 1];
+    }
     [textureDescriptor setUsage:(_isRenderTarget ? MTLTextureUsageRenderTarget|
         MTLTextureUsageShaderRead : MTLTextureUsageShaderRead)];
     if(_format == TextureFormat::Depth16UNorm || _format == TextureFormat::
@@ -198,9 +614,13 @@ void paz::Texture::Data::init(const void* data)
     _texture = [DEVICE newTextureWithDescriptor:textureDescriptor];
     if(data)
     {
+        const NSUInteger bytesPerRow = is_compressed(_format) ? compressed_size(
+            _format, _width, 4) : _width*bytes_per_pixel(_format);
         [static_cast<id<MTLTexture>>(_texture) replaceRegion:MTLRegionMake2D(0,
-            0, _width, _height) mipmapLevel:0 withBytes:data bytesPerRow:_width*
-            bytes_per_pixel(_format)];
+            0, _width, _height) mipmapLevel:0 withBytes:data bytesPerRow:
+            bytesPerRow];
+        frame_stats().bytesUploaded += is_compressed(_format) ?
+            compressed_size(_format, _width, _height) : bytesPerRow*_height;
     }
     if(!_sampler)
     {
@@ -213,14 +633,12 @@ void paz::Texture::Data::init(const void* data)
 
 void paz::Texture::Data::resize(int width, int height)
 {
-    if(_scale)
+    if(_scale && updateSize(width, height))
     {
         if(_texture)
         {
             [static_cast<id<MTLTexture>>(_texture) release];
         }
-        _width = _scale*width;
-        _height = _scale*height;
         init();
     }
 }
@@ -236,6 +654,17 @@ void paz::Texture::Data::ensureMipmaps()
             _texture)];
         [blitEncoder endEncoding];
     }
+    _mipmapsDirty = false;
+}
+
+void paz::Texture::Data::setMaxMipLevel(int level)
+{
+    _maxMipLevel = level;
+    if(_texture)
+    {
+        [static_cast<id<MTLTexture>>(_texture) release];
+    }
+    init();
 }
 
 int paz::Texture::width() const
@@ -248,4 +677,163 @@ int paz::Texture::height() const
     return _data ? _data->_height : 0;
 }
 
+int paz::Texture::allocatedWidth() const
+{
+    return _data ? std::max(_data->_width, _data->_allocWidth) : 0;
+}
+
+int paz::Texture::allocatedHeight() const
+{
+    return _data ? std::max(_data->_height, _data->_allocHeight) : 0;
+}
+
+paz::TextureArray::Data::~Data()
+{
+    if(_texture)
+    {
+        [static_cast<id<MTLTexture>>(_texture) release];
+    }
+    if(_sampler)
+    {
+        [static_cast<id<MTLSamplerState>>(_sampler) release];
+    }
+}
+
+paz::TextureArray::TextureArray()
+{
+    initialize();
+}
+
+paz::TextureArray::TextureArray(TextureFormat format, int width, int height, int
+    layers, MinMagFilter minFilter, MinMagFilter magFilter, MipmapFilter
+    mipFilter, WrapMode wrapS, WrapMode wrapT)
+{
+    initialize();
+
+    PAZ_PROFILE("TextureArray::TextureArray");
+
+    if(layers < 1)
+    {
+        throw std::invalid_argument("Texture array must have at least one layer"
+            ".");
+    }
+    if(is_compressed(format))
+    {
+        throw std::logic_error("Texture arrays do not support block-compressed "
+            "formats.");
+    }
+    if((format == TextureFormat::Depth16UNorm || format == TextureFormat::
+        Depth32Float) && mipFilter != MipmapFilter::None)
+    {
+        throw std::runtime_error("Depth/stencil textures do not support mipmapp"
+            "ing.");
+    }
+
+    _data = std::make_shared<Data>();
+    _data->_width = width;
+    _data->_height = height;
+    _data->_layers = layers;
+    _data->_format = format;
+    _data->_mipFilter = mipFilter;
+
+    MTLTextureDescriptor* textureDescriptor = [MTLTextureDescriptor
+        texture2DDescriptorWithPixelFormat:pixel_format(format) width:width
+        height:height mipmapped:(mipFilter == MipmapFilter::None ? NO : YES)];
+    [textureDescriptor setTextureType:MTLTextureType2DArray];
+    [textureDescriptor setArrayLength:layers];
+    [textureDescriptor setUsage:MTLTextureUsageShaderRead];
+    if(format == TextureFormat::Depth16UNorm || format == TextureFormat::
+        Depth32Float)
+    {
+        [textureDescriptor setStorageMode:MTLStorageModePrivate];
+    }
+    _data->_texture = [DEVICE newTextureWithDescriptor:textureDescriptor];
+    _data->_sampler = create_sampler(minFilter, magFilter, mipFilter, wrapS,
+        wrapT);
+}
+
+void paz::TextureArray::sub(int layer, const void* data, std::size_t
+    rowPitch)
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Texture array has not been initialized.");
+    }
+    if(layer < 0 || layer >= _data->_layers)
+    {
+        throw std::out_of_range("Layer is out of bounds.");
+    }
+
+    [RENDERER ensureCommandBuffer];
+
+    const std::size_t bytesPerRow = bytes_per_pixel(_data->_format)*_data->
+        _width;
+    rowPitch = check_row_pitch(rowPitch, bytesPerRow, bytes_per_pixel(_data->
+        _format));
+    const std::size_t size = bytesPerRow*_data->_height;
+    std::size_t idx;
+    id<MTLBuffer> staging = acquire_staging_buffer(size, idx);
+    unsigned char* dst = static_cast<unsigned char*>([staging contents]);
+    for(int i = 0; i < _data->_height; ++i)
+    {
+        std::copy(reinterpret_cast<const unsigned char*>(data) + rowPitch*i,
+            reinterpret_cast<const unsigned char*>(data) + rowPitch*i +
+            bytesPerRow, dst + bytesPerRow*(_data->_height - i - 1));
+    }
+
+    id<MTLBlitCommandEncoder> blitEncoder = [[RENDERER commandBuffer]
+        blitCommandEncoder];
+    [blitEncoder copyFromBuffer:staging sourceOffset:0 sourceBytesPerRow:
+        bytesPerRow sourceBytesPerImage:size sourceSize:MTLSizeMake(_data->
+        _width, _data->_height, 1) toTexture:static_cast<id<MTLTexture>>(_data->
+        _texture) destinationSlice:layer destinationLevel:0 destinationOrigin:
+        MTLOriginMake(0, 0, 0)];
+    [blitEncoder endEncoding];
+    release_staging_buffer(idx, staging);
+    frame_stats().bytesUploaded += size;
+
+    // Blits cannot be encoded during a pass, so mipmaps are not deferred.
+    _data->ensureMipmaps();
+}
+
+void paz::TextureArray::sub(int layer, const ImageView& image)
+{
+    if(!_data || image.width() != _data->_width || image.height() != _data->
+        _height || static_cast<TextureFormat>(image.format()) != _data->_format)
+    {
+        throw std::runtime_error("Image format and dimensions must match textur"
+            "e array.");
+    }
+    sub(layer, image.data(), image.rowPitch());
+}
+
+void paz::TextureArray::Data::ensureMipmaps()
+{
+    if(_mipFilter != MipmapFilter::None)
+    {
+        [RENDERER ensureCommandBuffer];
+        id<MTLBlitCommandEncoder> blitEncoder = [[RENDERER commandBuffer]
+            blitCommandEncoder];
+        [blitEncoder generateMipmapsForTexture:static_cast<id<MTLTexture>>(
+            _texture)];
+        [blitEncoder endEncoding];
+    }
+    _mipmapsDirty = false;
+}
+
+int paz::TextureArray::width() const
+{
+    return _data ? _data->_width : 0;
+}
+
+int paz::TextureArray::height() const
+{
+    return _data ? _data->_height : 0;
+}
+
+int paz::TextureArray::layers() const
+{
+    return _data ? _data->_layers : 0;
+}
+
 #endif
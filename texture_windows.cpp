@@ -6,11 +6,40 @@
 #include "util_windows.hpp"
 #include "internal_data.hpp"
 #include "common.hpp"
+#include <algorithm>
 
 #define CASE0(a, b) case paz::TextureFormat::a: return DXGI_FORMAT_##b;
 #define CASE1(a, b) case paz::WrapMode::a: return D3D11_TEXTURE_ADDRESS_##b;
 #define CASE2(f, n, b) case paz::TextureFormat::f: return n*b/8;
 
+struct StagingTexture
+{
+    ID3D11Texture2D* _texture = nullptr;
+    paz::TextureFormat _format;
+    int _width = 0;
+    int _height = 0;
+    bool _mapped = false;
+};
+
+static constexpr std::size_t MaxStagingTextures = 32;
+
+static std::vector<StagingTexture> _stagingTextures;
+
+struct ReadbackTexture
+{
+    ID3D11Texture2D* _texture = nullptr;
+    ID3D11Query* _query = nullptr;
+    paz::TextureFormat _format;
+    int _width = 0;
+    int _height = 0;
+    void* _owner = nullptr;
+};
+
+static constexpr std::size_t MaxReadbackTextures = 32;
+
+static std::vector<ReadbackTexture> _readbackTextures;
+static std::size_t _nextReadbackTexture;
+
 static DXGI_FORMAT tex_format(paz::TextureFormat format)
 {
     switch(format)
@@ -59,6 +88,12 @@ static DXGI_FORMAT tex_format(paz::TextureFormat format)
         CASE0(Depth32Float, R32_TYPELESS)
 
         CASE0(BGRA8UNorm, B8G8R8A8_UNORM)
+
+        CASE0(BC1RGBAUNorm, BC1_UNORM)
+        CASE0(BC3RGBAUNorm, BC3_UNORM)
+        CASE0(BC4RUNorm, BC4_UNORM)
+        CASE0(BC5RGUNorm, BC5_UNORM)
+        CASE0(BC7RGBAUNorm, BC7_UNORM)
     }
 
     throw std::runtime_error("Invalid texture format requested.");
@@ -209,6 +244,14 @@ static int bytes_per_pixel(paz::TextureFormat format)
         CASE2(Depth32Float, 1, 32)
 
         CASE2(BGRA8UNorm, 4, 8)
+
+        // Block-compressed formats have no per-pixel layout.
+        case paz::TextureFormat::BC1RGBAUNorm:
+        case paz::TextureFormat::BC3RGBAUNorm:
+        case paz::TextureFormat::BC4RUNorm:
+        case paz::TextureFormat::BC5RGUNorm:
+        case paz::TextureFormat::BC7RGBAUNorm:
+            break;
     }
 
     throw std::runtime_error("Invalid texture format requested.");
@@ -244,6 +287,83 @@ static ID3D11SamplerState* create_sampler(paz::MinMagFilter minFilter, paz::
     return sampler;
 }
 
+static StagingTexture& map_staging_texture(paz::TextureFormat format, int width,
+    int height, D3D11_MAPPED_SUBRESOURCE& mappedSr)
+{
+    // Reuse a texture whose previous transfer has completed, if possible.
+    for(auto& n : _stagingTextures)
+    {
+        if(!n._mapped && n._format == format && n._width == width && n.
+            _height == height && !paz::d3d_context()->Map(n._texture, 0,
+            D3D11_MAP_WRITE, D3D11_MAP_FLAG_DO_NOT_WAIT, &mappedSr))
+        {
+            n._mapped = true;
+            return n;
+        }
+    }
+
+    // Evict the oldest unmapped texture if the pool is full. Pending copies
+    // hold their own references.
+    if(_stagingTextures.size() >= MaxStagingTextures)
+    {
+        auto it = std::find_if(_stagingTextures.begin(), _stagingTextures.end(),
+            [](const StagingTexture& n)
+        {
+            return !n._mapped;
+        });
+        if(it == _stagingTextures.end())
+        {
+            throw std::runtime_error("Too many texture uploads are mapped.");
+        }
+        it->_texture->Release();
+        _stagingTextures.erase(it);
+    }
+
+    D3D11_TEXTURE2D_DESC descriptor = {};
+    descriptor.Width = width;
+    descriptor.Height = height;
+    descriptor.MipLevels = 1;
+    descriptor.ArraySize = 1;
+    descriptor.Format = tex_format(format);
+    descriptor.SampleDesc.Count = 1;
+    descriptor.Usage = D3D11_USAGE_STAGING;
+    descriptor.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    StagingTexture staging;
+    staging._format = format;
+    staging._width = width;
+    staging._height = height;
+    auto hr = paz::d3d_device()->CreateTexture2D(&descriptor, nullptr,
+        &staging._texture);
+    if(hr)
+    {
+        throw std::runtime_error("Failed to create staging texture (" + paz::
+            format_hresult(hr) + ").");
+    }
+    hr = paz::d3d_context()->Map(staging._texture, 0, D3D11_MAP_WRITE, 0,
+        &mappedSr);
+    if(hr)
+    {
+        staging._texture->Release();
+        throw std::runtime_error("Failed to map staging texture (" + paz::
+            format_hresult(hr) + ").");
+    }
+    staging._mapped = true;
+    _stagingTextures.push_back(staging);
+    return _stagingTextures.back();
+}
+
+static void unmap_staging_texture(ID3D11Texture2D* texture)
+{
+    paz::d3d_context()->Unmap(texture, 0);
+    for(auto& n : _stagingTextures)
+    {
+        if(n._texture == texture)
+        {
+            n._mapped = false;
+        }
+    }
+}
+
 paz::Texture::Data::~Data()
 {
     if(_isRenderTarget)
@@ -311,27 +431,24 @@ paz::Texture::Texture(TextureFormat format, int width, int height, const void*
     _data->_mipFilter = mipFilter;
     _data->_wrapS = wrapS;
     _data->_wrapT = wrapT;
-    if(height < 2)
+    if(!data || height < 2)
     {
         _data->init(data);
     }
+    else if(is_compressed(format))
+    {
+        _data->init(flip_blocks(format, data, width, height).get());
+    }
     else
     {
         const std::size_t bytesPerRow = bytes_per_pixel(format)*width;
-        std::vector<unsigned char> flipped(bytesPerRow*height);
-        for(int i = 0; i < height; ++i)
-        {
-            std::copy(reinterpret_cast<const unsigned char*>(data) +
-                bytesPerRow*i, reinterpret_cast<const unsigned char*>(data) +
-                bytesPerRow*(i + 1), flipped.begin() + bytesPerRow*(height - i -
-                1));
-        }
-        _data->init(flipped.data());
+        _data->init(flip_rows(data, bytesPerRow, bytesPerRow, height).get());
     }
 }
 
-paz::Texture::Texture(const Image& image, MinMagFilter minFilter, MinMagFilter
-    magFilter, MipmapFilter mipFilter, WrapMode wrapS, WrapMode wrapT)
+paz::Texture::Texture(const ImageView& image, MinMagFilter minFilter,
+    MinMagFilter magFilter, MipmapFilter mipFilter, WrapMode wrapS, WrapMode
+    wrapT)
 {
     initialize();
 
@@ -344,14 +461,310 @@ paz::Texture::Texture(const Image& image, MinMagFilter minFilter, MinMagFilter
     _data->_mipFilter = mipFilter;
     _data->_wrapS = wrapS;
     _data->_wrapT = wrapT;
-    _data->init(flip_image(image).bytes().data());
+    const std::size_t bytesPerRow = bytes_per_pixel(_data->_format)*image.
+        width();
+    _data->init(flip_rows(image.data(), check_row_pitch(image.rowPitch(),
+        bytesPerRow, bytes_per_pixel(_data->_format)), bytesPerRow, image.
+        height()).get());
 }
 
 paz::Texture::Texture(RenderTarget&& target) : _data(std::move(target._data)) {}
 
+paz::TextureUpload paz::Texture::mapUpload()
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Texture has not been initialized.");
+    }
+    if(is_compressed(_data->_format))
+    {
+        throw std::logic_error("Block-compressed textures cannot be updated.");
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mappedSr;
+    const StagingTexture& staging = map_staging_texture(_data->_format, _data->
+        _width, _data->_height, mappedSr);
+
+    TextureUpload upload;
+    upload._data = std::make_shared<TextureUpload::Data>();
+    upload._data->_staging = staging._texture;
+    upload._data->_texture = _data;
+    upload._data->_width = _data->_width;
+    upload._data->_height = _data->_height;
+    upload._data->_bytesPerRow = bytes_per_pixel(_data->_format)*_data->_width;
+
+    // Rows are flipped by addressing them from the end of the mapping.
+    upload._data->_firstRow = static_cast<unsigned char*>(mappedSr.pData) +
+        mappedSr.RowPitch*(_data->_height - 1);
+    upload._data->_rowStride = -static_cast<std::ptrdiff_t>(mappedSr.RowPitch);
+    return upload;
+}
+
+void paz::Texture::commit(TextureUpload& upload)
+{
+    if(!_data || !upload._data || upload._data->_texture != _data)
+    {
+        throw std::logic_error("Upload was not mapped from this texture.");
+    }
+    if(upload._data->_width != _data->_width || upload._data->_height !=
+        _data->_height)
+    {
+        throw std::runtime_error("Texture was resized after upload was mapped."
+            );
+    }
+    ID3D11Texture2D* staging = upload._data->_staging;
+    const std::size_t size = upload._data->_bytesPerRow*_data->_height;
+    upload._data->_done = true;
+    upload._data.reset();
+    unmap_staging_texture(staging);
+
+    d3d_context()->CopySubresourceRegion(_data->_texture, 0, 0, 0, 0, staging,
+        0, nullptr);
+    frame_stats().bytesUploaded += size;
+
+    _data->_mipmapsDirty = _data->_mipFilter != MipmapFilter::None;
+}
+
+paz::TextureUpload::Data::~Data()
+{
+    if(!_done)
+    {
+        unmap_staging_texture(_staging);
+    }
+}
+
+void paz::Texture::sub(int x, int y, int width, int height, const void* data,
+    std::size_t rowPitch)
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Texture has not been initialized.");
+    }
+    if(is_compressed(_data->_format))
+    {
+        throw std::logic_error("Block-compressed textures cannot be updated.");
+    }
+    if(x < 0 || y < 0 || width < 0 || height < 0 || x + width > _data->_width ||
+        y + height > _data->_height)
+    {
+        throw std::out_of_range("Region is out of texture bounds.");
+    }
+    const std::size_t bytesPerRow = bytes_per_pixel(_data->_format)*width;
+    rowPitch = check_row_pitch(rowPitch, bytesPerRow, bytes_per_pixel(_data->
+        _format));
+    if(!width || !height)
+    {
+        return;
+    }
+
+    const auto flipped = flip_rows(data, rowPitch, bytesPerRow, height);
+
+    D3D11_BOX box = {};
+    box.left = x;
+    box.top = _data->_height - y - height;
+    box.front = 0;
+    box.right = x + width;
+    box.bottom = _data->_height - y;
+    box.back = 1;
+    d3d_context()->UpdateSubresource(_data->_texture, 0, &box, flipped.get(),
+        bytesPerRow, 0);
+    frame_stats().bytesUploaded += bytesPerRow*height;
+
+    _data->_mipmapsDirty = _data->_mipFilter != MipmapFilter::None;
+}
+
+void paz::Texture::sub(int x, int y, const ImageView& image)
+{
+    if(!_data || static_cast<TextureFormat>(image.format()) != _data->_format)
+    {
+        throw std::runtime_error("Image format must match texture.");
+    }
+    sub(x, y, image.width(), image.height(), image.data(), image.rowPitch());
+}
+
+paz::ReadbackRequest paz::Texture::readAsync(int x, int y, int width, int
+    height) const
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Texture has not been initialized.");
+    }
+    const ImageFormat format = readback_format(_data->_format);
+    if(x < 0 || y < 0 || width < 0 || height < 0 || x + width > _data->_width ||
+        y + height > _data->_height)
+    {
+        throw std::out_of_range("Region is out of texture bounds.");
+    }
+
+    ReadbackRequest req;
+    req._data = std::make_shared<ReadbackRequest::Data>();
+    req._data->_result = Image(format, width, height);
+    if(!width || !height)
+    {
+        req._data->_done = true;
+        return req;
+    }
+
+    // Depth/stencil resources can only be copied whole.
+    const bool isDepth = _data->_format == TextureFormat::Depth16UNorm ||
+        _data->_format == TextureFormat::Depth32Float;
+    const int allocWidth = std::max(_data->_width, _data->_allocWidth);
+    const int allocHeight = std::max(_data->_height, _data->_allocHeight);
+    D3D11_BOX box = {};
+    box.left = x;
+    box.right = x + width;
+    box.top = allocHeight - y - height;
+    box.bottom = allocHeight - y;
+    box.front = 0;
+    box.back = 1;
+
+    req._data->acquire(_data->_format, isDepth ? allocWidth : width, isDepth ?
+        allocHeight : height);
+    const ReadbackTexture& staging = _readbackTextures[req._data->_staging];
+
+    // Queue the copy and mark its completion without waiting for it.
+    if(isDepth)
+    {
+        req._data->_srcX = box.left;
+        req._data->_srcY = box.top;
+        d3d_context()->CopyResource(staging._texture, _data->_texture);
+    }
+    else
+    {
+        d3d_context()->CopySubresourceRegion(staging._texture, 0, 0, 0, 0,
+            _data->_texture, 0, &box);
+    }
+    d3d_context()->End(staging._query);
+
+    return req;
+}
+
+paz::ReadbackRequest::Data::~Data()
+{
+    if(_staging < _readbackTextures.size() && _readbackTextures[_staging].
+        _owner == this)
+    {
+        _readbackTextures[_staging]._owner = nullptr;
+    }
+}
+
+void paz::ReadbackRequest::Data::acquire(TextureFormat format, int width, int
+    height)
+{
+    // Prefer an idle texture that matches, since copying a whole depth texture
+    // requires identical dimensions.
+    _staging = _readbackTextures.size();
+    for(std::size_t i = 0; i < _readbackTextures.size(); ++i)
+    {
+        const auto& n = _readbackTextures[i];
+        if(!n._owner)
+        {
+            _staging = i;
+            if(n._format == format && n._width == width && n._height ==
+                height)
+            {
+                break;
+            }
+        }
+    }
+
+    // Grow the pool, or complete the next request in turn if it is full.
+    if(_staging == _readbackTextures.size())
+    {
+        if(_readbackTextures.size() < MaxReadbackTextures)
+        {
+            _readbackTextures.emplace_back();
+            D3D11_QUERY_DESC queryDescriptor = {};
+            queryDescriptor.Query = D3D11_QUERY_EVENT;
+            const auto hr = d3d_device()->CreateQuery(&queryDescriptor,
+                &_readbackTextures.back()._query);
+            if(hr)
+            {
+                _readbackTextures.pop_back();
+                throw std::runtime_error("Failed to create query (" +
+                    format_hresult(hr) + ").");
+            }
+        }
+        else
+        {
+            _staging = _nextReadbackTexture;
+            _nextReadbackTexture = (_nextReadbackTexture + 1)%
+                MaxReadbackTextures;
+            static_cast<Data*>(_readbackTextures[_staging]._owner)->complete();
+        }
+    }
+
+    auto& staging = _readbackTextures[_staging];
+    if(!staging._texture || staging._format != format || staging._width !=
+        width || staging._height != height)
+    {
+        if(staging._texture)
+        {
+            staging._texture->Release();
+            staging._texture = nullptr;
+        }
+        D3D11_TEXTURE2D_DESC descriptor = {};
+        descriptor.Width = width;
+        descriptor.Height = height;
+        descriptor.MipLevels = 1;
+        descriptor.ArraySize = 1;
+        descriptor.Format = tex_format(format);
+        descriptor.SampleDesc.Count = 1;
+        descriptor.Usage = D3D11_USAGE_STAGING;
+        descriptor.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        const auto hr = d3d_device()->CreateTexture2D(&descriptor, nullptr,
+            &staging._texture);
+        if(hr)
+        {
+            throw std::runtime_error("Failed to create staging texture (" +
+                format_hresult(hr) + ").");
+        }
+        staging._format = format;
+        staging._width = width;
+        staging._height = height;
+    }
+    staging._owner = this;
+}
+
+bool paz::ReadbackRequest::Data::poll()
+{
+    return d3d_context()->GetData(_readbackTextures[_staging]._query, nullptr,
+        0, 0) == S_OK;
+}
+
+void paz::ReadbackRequest::Data::finish()
+{
+    // Mapping waits for the copy to complete.
+    auto& staging = _readbackTextures[_staging];
+    D3D11_MAPPED_SUBRESOURCE mappedSr;
+    const auto hr = d3d_context()->Map(staging._texture, 0, D3D11_MAP_READ, 0,
+        &mappedSr);
+    if(hr)
+    {
+        throw std::runtime_error("Failed to map staging texture (" +
+            format_hresult(hr) + ").");
+    }
+
+    // Flip rows while copying out of the staging texture.
+    const std::size_t bytesPerRow = _result.bytes().size()/_result.height();
+    const std::size_t bytesPerPixel = bytesPerRow/_result.width();
+    const unsigned char* src = reinterpret_cast<const unsigned char*>(mappedSr.
+        pData) + mappedSr.RowPitch*_srcY + bytesPerPixel*_srcX;
+    for(int i = 0; i < _result.height(); ++i)
+    {
+        std::copy(src + mappedSr.RowPitch*(_result.height() - i - 1), src +
+            mappedSr.RowPitch*(_result.height() - i - 1) + bytesPerRow,
+            _result.bytes().begin() + bytesPerRow*i);
+    }
+    d3d_context()->Unmap(staging._texture, 0);
+    staging._owner = nullptr;
+}
+
 void paz::Texture::Data::init(const void* data)
 {
-    // Textures not for rendering are static (for now).
+    PAZ_PROFILE("Texture::Texture");
+
+    // Textures not for rendering must be created with data.
     if(!_isRenderTarget && !data)
     {
         throw std::logic_error("Cannot initialize static texture without data."
@@ -366,15 +779,40 @@ void paz::Texture::Data::init(const void* data)
             "ing.");
     }
 
+    if(is_compressed(_format))
+    {
+        if(_isRenderTarget)
+        {
+            throw std::logic_error("Cannot render to block-compressed texture."
+                );
+        }
+        if(_mipFilter != MipmapFilter::None)
+        {
+            throw std::runtime_error("Block-compressed textures do not support "
+                "mipmapping.");
+        }
+        if(_width%4 || _height%4)
+        {
+            throw std::invalid_argument("Block-compressed textures must have d"
+                "imensions that are multiples of four.");
+        }
+    }
+
     D3D11_TEXTURE2D_DESC descriptor = {};
-    descriptor.Width = _width;
-    descriptor.Height = _height;
-    descriptor.MipLevels = _mipFilter == MipmapFilter::None;
+    descriptor.Width = std::max(_width, _allocWidth);
+    descriptor.Height = std::max(_height, _allocHeight);
+    if(_mipFilter == MipmapFilter::None)
+    {
+        descriptor.MipLevels = 1;
+    }
+    else
+    {
+        descriptor.MipLevels = _maxMipLevel < 0 ? 0 : _maxMipLevel + 1;
+    }
     descriptor.ArraySize = 1;
     descriptor.Format = tex_format(_format);
     descriptor.SampleDesc.Count = 1;
-    descriptor.Usage = _isRenderTarget || _mipFilter != MipmapFilter::None ?
-        D3D11_USAGE_DEFAULT : D3D11_USAGE_IMMUTABLE;
+    descriptor.Usage = D3D11_USAGE_DEFAULT;
     descriptor.BindFlags = D3D11_BIND_SHADER_RESOURCE;
     if(_isRenderTarget && (_format == TextureFormat::Depth16UNorm || _format ==
         TextureFormat::Depth32Float))
@@ -391,7 +829,11 @@ void paz::Texture::Data::init(const void* data)
     {
         D3D11_SUBRESOURCE_DATA srData = {};
         srData.pSysMem = data;
-        srData.SysMemPitch = _width*bytes_per_pixel(_format);
+        srData.SysMemPitch = is_compressed(_format) ? compressed_size(_format,
+            _width, 4) : _width*bytes_per_pixel(_format);
+        frame_stats().bytesUploaded += is_compressed(_format) ?
+            compressed_size(_format, _width, _height) : bytes_per_pixel(_format)*
+            _width*_height;
         if(_mipFilter == MipmapFilter::None)
         {
             const auto hr = d3d_device()->CreateTexture2D(&descriptor, &srData,
@@ -514,32 +956,42 @@ void paz::Texture::Data::init(const void* data)
 
 void paz::Texture::Data::resize(int width, int height)
 {
-    if(_scale)
+    if(_scale && updateSize(width, height))
     {
-        if(_texture)
-        {
-            _texture->Release();
-            _texture = nullptr;
-        }
-        if(_resourceView)
-        {
-            _resourceView->Release();
-            _resourceView = nullptr;
-        }
-        if(_rtView)
-        {
-            _rtView->Release();
-            _rtView = nullptr;
-        }
-        if(_dsView)
-        {
-            _dsView->Release();
-            _dsView = nullptr;
-        }
-        _width = _scale*width;
-        _height = _scale*height;
-        init();
+        recreate();
+    }
+}
+
+void paz::Texture::Data::setMaxMipLevel(int level)
+{
+    _maxMipLevel = level;
+    recreate();
+}
+
+// Views are bound to a resource, so they are replaced along with it.
+void paz::Texture::Data::recreate()
+{
+    if(_texture)
+    {
+        _texture->Release();
+        _texture = nullptr;
+    }
+    if(_resourceView)
+    {
+        _resourceView->Release();
+        _resourceView = nullptr;
     }
+    if(_rtView)
+    {
+        _rtView->Release();
+        _rtView = nullptr;
+    }
+    if(_dsView)
+    {
+        _dsView->Release();
+        _dsView = nullptr;
+    }
+    init();
 }
 
 void paz::Texture::Data::ensureMipmaps()
@@ -548,6 +1000,7 @@ void paz::Texture::Data::ensureMipmaps()
     {
         d3d_context()->GenerateMips(_resourceView);
     }
+    _mipmapsDirty = false;
 }
 
 int paz::Texture::width() const
@@ -560,4 +1013,179 @@ int paz::Texture::height() const
     return _data ? _data->_height : 0;
 }
 
+int paz::Texture::allocatedWidth() const
+{
+    return _data ? std::max(_data->_width, _data->_allocWidth) : 0;
+}
+
+int paz::Texture::allocatedHeight() const
+{
+    return _data ? std::max(_data->_height, _data->_allocHeight) : 0;
+}
+
+paz::TextureArray::Data::~Data()
+{
+    if(_texture)
+    {
+        _texture->Release();
+    }
+    if(_sampler)
+    {
+        _sampler->Release();
+    }
+    if(_resourceView)
+    {
+        _resourceView->Release();
+    }
+}
+
+paz::TextureArray::TextureArray()
+{
+    initialize();
+}
+
+paz::TextureArray::TextureArray(TextureFormat format, int width, int height, int
+    layers, MinMagFilter minFilter, MinMagFilter magFilter, MipmapFilter
+    mipFilter, WrapMode wrapS, WrapMode wrapT)
+{
+    initialize();
+
+    PAZ_PROFILE("TextureArray::TextureArray");
+
+    if(layers < 1)
+    {
+        throw std::invalid_argument("Texture array must have at least one layer"
+            ".");
+    }
+    if(is_compressed(format))
+    {
+        throw std::logic_error("Texture arrays do not support block-compressed "
+            "formats.");
+    }
+    if((format == TextureFormat::Depth16UNorm || format == TextureFormat::
+        Depth32Float) && mipFilter != MipmapFilter::None)
+    {
+        throw std::runtime_error("Depth/stencil textures do not support mipmapp"
+            "ing.");
+    }
+
+    _data = std::make_shared<Data>();
+    _data->_width = width;
+    _data->_height = height;
+    _data->_layers = layers;
+    _data->_format = format;
+    _data->_mipFilter = mipFilter;
+
+    D3D11_TEXTURE2D_DESC descriptor = {};
+    descriptor.Width = width;
+    descriptor.Height = height;
+    descriptor.MipLevels = mipFilter == MipmapFilter::None ? 1 : 0;
+    descriptor.ArraySize = layers;
+    descriptor.Format = tex_format(format);
+    descriptor.SampleDesc.Count = 1;
+    descriptor.Usage = D3D11_USAGE_DEFAULT;
+    descriptor.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    if(mipFilter != MipmapFilter::None)
+    {
+        descriptor.BindFlags |= D3D11_BIND_RENDER_TARGET;
+        descriptor.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+    }
+    auto hr = d3d_device()->CreateTexture2D(&descriptor, nullptr, &_data->
+        _texture);
+    if(hr)
+    {
+        throw std::runtime_error("Failed to create texture array (" +
+            format_hresult(hr) + ").");
+    }
+    _data->_sampler = create_sampler(minFilter, magFilter, mipFilter, wrapS,
+        wrapT);
+    D3D11_SHADER_RESOURCE_VIEW_DESC rvDescriptor = {};
+    if(format == TextureFormat::Depth16UNorm)
+    {
+        rvDescriptor.Format = DXGI_FORMAT_R16_UNORM;
+    }
+    else if(format == TextureFormat::Depth32Float)
+    {
+        rvDescriptor.Format = DXGI_FORMAT_R32_FLOAT;
+    }
+    else
+    {
+        rvDescriptor.Format = tex_format(format);
+    }
+    rvDescriptor.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+    rvDescriptor.Texture2DArray.MipLevels = mipFilter == MipmapFilter::None ? 1 :
+        -1;
+    rvDescriptor.Texture2DArray.ArraySize = layers;
+    hr = d3d_device()->CreateShaderResourceView(_data->_texture, &rvDescriptor,
+        &_data->_resourceView);
+    if(hr)
+    {
+        throw std::runtime_error("Failed to create resource view (" +
+            format_hresult(hr) + ").");
+    }
+    _data->_mipmapsDirty = mipFilter != MipmapFilter::None;
+}
+
+void paz::TextureArray::sub(int layer, const void* data, std::size_t
+    rowPitch)
+{
+    if(!_data)
+    {
+        throw std::runtime_error("Texture array has not been initialized.");
+    }
+    if(layer < 0 || layer >= _data->_layers)
+    {
+        throw std::out_of_range("Layer is out of bounds.");
+    }
+
+    const std::size_t bytesPerRow = bytes_per_pixel(_data->_format)*_data->
+        _width;
+    const auto flipped = flip_rows(data, check_row_pitch(rowPitch, bytesPerRow,
+        bytes_per_pixel(_data->_format)), bytesPerRow, _data->_height);
+
+    D3D11_TEXTURE2D_DESC descriptor;
+    _data->_texture->GetDesc(&descriptor);
+    d3d_context()->UpdateSubresource(_data->_texture, D3D11CalcSubresource(0,
+        layer, descriptor.MipLevels), nullptr, flipped.get(), bytesPerRow, 0);
+    frame_stats().bytesUploaded += bytesPerRow*_data->_height;
+
+    // Mipmaps are regenerated the next time the array is read.
+    _data->_mipmapsDirty = _data->_mipFilter != MipmapFilter::None;
+}
+
+void paz::TextureArray::sub(int layer, const ImageView& image)
+{
+    if(!_data || image.width() != _data->_width || image.height() != _data->
+        _height || static_cast<TextureFormat>(image.format()) != _data->_format)
+    {
+        throw std::runtime_error("Image format and dimensions must match textur"
+            "e array.");
+    }
+    sub(layer, image.data(), image.rowPitch());
+}
+
+void paz::TextureArray::Data::ensureMipmaps()
+{
+    if(_mipFilter != MipmapFilter::None)
+    {
+        d3d_context()->GenerateMips(_resourceView);
+    }
+    _mipmapsDirty = false;
+}
+
+int paz::TextureArray::width() const
+{
+    return _data ? _data->_width : 0;
+}
+
+int paz::TextureArray::height() const
+{
+    return _data ? _data->_height : 0;
+}
+
+int paz::TextureArray::layers() const
+{
+    return _data ? _data->_layers : 0;
+}
+
 #endif
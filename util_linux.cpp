@@ -8,6 +8,7 @@
 
 #define CASE_STRING(x) case x: return #x;
 #define CASE(a, b) case TextureFormat::a: return GL_##b;
+#define CASE1(f, n, b) case TextureFormat::f: return n*b/8;
 
 std::pair<GLint, GLint> paz::min_mag_filter(MinMagFilter minFilter, MinMagFilter
     magFilter, MipmapFilter mipmapFilter)
@@ -128,6 +129,12 @@ GLint paz::gl_internal_format(TextureFormat format)
         CASE(Depth32Float, DEPTH_COMPONENT32F)
 
         CASE(BGRA8UNorm, RGBA8)
+
+        CASE(BC1RGBAUNorm, COMPRESSED_RGBA_S3TC_DXT1_EXT)
+        CASE(BC3RGBAUNorm, COMPRESSED_RGBA_S3TC_DXT5_EXT)
+        CASE(BC4RUNorm, COMPRESSED_RED_RGTC1)
+        CASE(BC5RGUNorm, COMPRESSED_RG_RGTC2)
+        CASE(BC7RGBAUNorm, COMPRESSED_RGBA_BPTC_UNORM)
     }
 
     throw std::runtime_error("Invalid texture format requested.");
@@ -181,6 +188,14 @@ GLenum paz::gl_format(TextureFormat format)
         CASE(Depth32Float, DEPTH_COMPONENT)
 
         CASE(BGRA8UNorm, BGRA)
+
+        // Block-compressed formats have no per-pixel layout.
+        case TextureFormat::BC1RGBAUNorm:
+        case TextureFormat::BC3RGBAUNorm:
+        case TextureFormat::BC4RUNorm:
+        case TextureFormat::BC5RGUNorm:
+        case TextureFormat::BC7RGBAUNorm:
+            break;
     }
 
     throw std::runtime_error("Invalid texture format requested.");
@@ -234,6 +249,75 @@ GLenum paz::gl_type(TextureFormat format)
         CASE(Depth32Float, FLOAT)
 
         CASE(BGRA8UNorm, UNSIGNED_BYTE)
+
+        // Block-compressed formats have no per-pixel layout.
+        case TextureFormat::BC1RGBAUNorm:
+        case TextureFormat::BC3RGBAUNorm:
+        case TextureFormat::BC4RUNorm:
+        case TextureFormat::BC5RGUNorm:
+        case TextureFormat::BC7RGBAUNorm:
+            break;
+    }
+
+    throw std::runtime_error("Invalid texture format requested.");
+}
+
+int paz::bytes_per_pixel(TextureFormat format)
+{
+    switch(format)
+    {
+        CASE1(R8UInt, 1, 8)
+        CASE1(R8SInt, 1, 8)
+        CASE1(R8UNorm, 1, 8)
+        CASE1(R8SNorm, 1, 8)
+        CASE1(R16UInt, 1, 16)
+        CASE1(R16SInt, 1, 16)
+        CASE1(R16UNorm, 1, 16)
+        CASE1(R16SNorm, 1, 16)
+        CASE1(R16Float, 1, 16)
+        CASE1(R32UInt, 1, 32)
+        CASE1(R32SInt, 1, 32)
+        CASE1(R32Float, 1, 32)
+
+        CASE1(RG8UInt, 2, 8)
+        CASE1(RG8SInt, 2, 8)
+        CASE1(RG8UNorm, 2, 8)
+        CASE1(RG8SNorm, 2, 8)
+        CASE1(RG16UInt, 2, 16)
+        CASE1(RG16SInt, 2, 16)
+        CASE1(RG16UNorm, 2, 16)
+        CASE1(RG16SNorm, 2, 16)
+        CASE1(RG16Float, 2, 16)
+        CASE1(RG32UInt, 2, 32)
+        CASE1(RG32SInt, 2, 32)
+        CASE1(RG32Float, 2, 32)
+
+        CASE1(RGBA8UInt, 4, 8)
+        CASE1(RGBA8SInt, 4, 8)
+        CASE1(RGBA8UNorm, 4, 8)
+        CASE1(RGBA8UNorm_sRGB, 4, 8)
+        CASE1(RGBA8SNorm, 4, 8)
+        CASE1(RGBA16UInt, 4, 16)
+        CASE1(RGBA16SInt, 4, 16)
+        CASE1(RGBA16UNorm, 4, 16)
+        CASE1(RGBA16SNorm, 4, 16)
+        CASE1(RGBA16Float, 4, 16)
+        CASE1(RGBA32UInt, 4, 32)
+        CASE1(RGBA32SInt, 4, 32)
+        CASE1(RGBA32Float, 4, 32)
+
+        CASE1(Depth16UNorm, 1, 16)
+        CASE1(Depth32Float, 1, 32)
+
+        CASE1(BGRA8UNorm, 4, 8)
+
+        // Block-compressed formats have no per-pixel layout.
+        case TextureFormat::BC1RGBAUNorm:
+        case TextureFormat::BC3RGBAUNorm:
+        case TextureFormat::BC4RUNorm:
+        case TextureFormat::BC5RGUNorm:
+        case TextureFormat::BC7RGBAUNorm:
+            break;
     }
 
     throw std::runtime_error("Invalid texture format requested.");
@@ -17,6 +17,7 @@ namespace paz
     int gl_internal_format(TextureFormat format);
     unsigned int gl_format(TextureFormat format);
     unsigned int gl_type(TextureFormat format);
+    int bytes_per_pixel(TextureFormat format);
     std::string get_log(unsigned int id, bool isProgram);
     std::string gl_error(unsigned int error) noexcept;
     unsigned int gl_type(DataType type);
@@ -62,6 +62,12 @@ MTLPixelFormat paz::pixel_format(TextureFormat format)
         CASE0(Depth32Float, Depth32Float)
 
         CASE0(BGRA8UNorm, BGRA8Unorm)
+
+        CASE0(BC1RGBAUNorm, BC1_RGBA)
+        CASE0(BC3RGBAUNorm, BC3_RGBA)
+        CASE0(BC4RUNorm, BC4_RUnorm)
+        CASE0(BC5RGUNorm, BC5_RGUnorm)
+        CASE0(BC7RGBAUNorm, BC7_RGBAUnorm)
     }
 
     throw std::runtime_error("Invalid texture format requested.");
@@ -115,6 +121,14 @@ int paz::bytes_per_pixel(TextureFormat format)
         CASE1(Depth32Float, 1, 32)
 
         CASE1(BGRA8UNorm, 4, 8)
+
+        // Block-compressed formats have no per-pixel layout.
+        case TextureFormat::BC1RGBAUNorm:
+        case TextureFormat::BC3RGBAUNorm:
+        case TextureFormat::BC4RUNorm:
+        case TextureFormat::BC5RGUNorm:
+        case TextureFormat::BC7RGBAUNorm:
+            break;
     }
 
     throw std::runtime_error("Invalid texture format requested.");
@@ -123,24 +123,30 @@ void paz::VertexBuffer::addAttribute(int dim, DataType type)
 void paz::VertexBuffer::addAttribute(int dim, const GLfloat* data, std::size_t
     size)
 {
+    PAZ_PROFILE("VertexBuffer::addAttribute");
     _data->checkSize(dim, size);
     _data->addAttribute(dim, DataType::Float);
+    frame_stats().bytesUploaded += sizeof(GLfloat)*size;
     glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*size, data, GL_STATIC_DRAW);
 }
 
 void paz::VertexBuffer::addAttribute(int dim, const GLuint* data, std::size_t
     size)
 {
+    PAZ_PROFILE("VertexBuffer::addAttribute");
     _data->checkSize(dim, size);
     _data->addAttribute(dim, DataType::UInt);
+    frame_stats().bytesUploaded += sizeof(GLuint)*size;
     glBufferData(GL_ARRAY_BUFFER, sizeof(GLuint)*size, data, GL_STATIC_DRAW);
 }
 
 void paz::VertexBuffer::addAttribute(int dim, const GLint* data, std::size_t
     size)
 {
+    PAZ_PROFILE("VertexBuffer::addAttribute");
     _data->checkSize(dim, size);
     _data->addAttribute(dim, DataType::SInt);
+    frame_stats().bytesUploaded += sizeof(GLint)*size;
     glBufferData(GL_ARRAY_BUFFER, sizeof(GLint)*size, data, GL_STATIC_DRAW);
 }
 
@@ -159,6 +165,7 @@ void paz::VertexBuffer::subAttribute(std::size_t idx, const GLfloat* data, std::
     }
     _data->checkSize(_data->_dims[idx], size);
     glBindBuffer(GL_ARRAY_BUFFER, _data->_ids[idx]);
+    frame_stats().bytesUploaded += sizeof(GLfloat)*size;
     glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(GLfloat)*size, data);
 }
 
@@ -177,6 +184,7 @@ void paz::VertexBuffer::subAttribute(std::size_t idx, const GLuint* data, std::
     }
     _data->checkSize(_data->_dims[idx], size);
     glBindBuffer(GL_ARRAY_BUFFER, _data->_ids[idx]);
+    frame_stats().bytesUploaded += sizeof(GLuint)*size;
     glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(GLuint)*size, data);
 }
 
@@ -195,6 +203,7 @@ void paz::VertexBuffer::subAttribute(std::size_t idx, const GLint* data, std::
     }
     _data->checkSize(_data->_dims[idx], size);
     glBindBuffer(GL_ARRAY_BUFFER, _data->_ids[idx]);
+    frame_stats().bytesUploaded += sizeof(GLint)*size;
     glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(GLint)*size, data);
 }
 
@@ -80,10 +80,12 @@ void paz::VertexBuffer::addAttribute(int dim, DataType type)
 void paz::VertexBuffer::addAttribute(int dim, const float* data, std::size_t
     size)
 {
+    PAZ_PROFILE("VertexBuffer::addAttribute");
     _data->_dims.push_back(dim);
     _data->checkSize(dim, size);
     if(size)
     {
+        frame_stats().bytesUploaded += sizeof(*data)*size;
         _data->_buffers.push_back([DEVICE newBufferWithBytes:data length:sizeof(
             float)*size options:MTLStorageModeShared]);
     }
@@ -92,10 +94,12 @@ void paz::VertexBuffer::addAttribute(int dim, const float* data, std::size_t
 void paz::VertexBuffer::addAttribute(int dim, const unsigned int* data, std::
     size_t size)
 {
+    PAZ_PROFILE("VertexBuffer::addAttribute");
     _data->_dims.push_back(dim);
     _data->checkSize(dim, size);
     if(size)
     {
+        frame_stats().bytesUploaded += sizeof(*data)*size;
         _data->_buffers.push_back([DEVICE newBufferWithBytes:data length:sizeof(
             unsigned int)*size options:MTLStorageModeShared]);
     }
@@ -103,10 +107,12 @@ void paz::VertexBuffer::addAttribute(int dim, const unsigned int* data, std::
 
 void paz::VertexBuffer::addAttribute(int dim, const int* data, std::size_t size)
 {
+    PAZ_PROFILE("VertexBuffer::addAttribute");
     _data->_dims.push_back(dim);
     _data->checkSize(dim, size);
     if(size)
     {
+        frame_stats().bytesUploaded += sizeof(*data)*size;
         _data->_buffers.push_back([DEVICE newBufferWithBytes:data length:sizeof(
             int)*size options:MTLStorageModeShared]);
     }
@@ -123,6 +129,7 @@ void paz::VertexBuffer::subAttribute(std::size_t idx, const float* data, std::
     _data->checkSize(_data->_dims[idx], size);
     std::copy(data, data + size, reinterpret_cast<float*>([static_cast<id<
         MTLBuffer>>(_data->_buffers[idx]) contents]));
+    frame_stats().bytesUploaded += sizeof(*data)*size;
 }
 
 void paz::VertexBuffer::subAttribute(std::size_t idx, const unsigned int* data,
@@ -136,6 +143,7 @@ void paz::VertexBuffer::subAttribute(std::size_t idx, const unsigned int* data,
     _data->checkSize(_data->_dims[idx], size);
     std::copy(data, data + size, reinterpret_cast<unsigned int*>([static_cast<
         id<MTLBuffer>>(_data->_buffers[idx]) contents]));
+    frame_stats().bytesUploaded += sizeof(*data)*size;
 }
 
 void paz::VertexBuffer::subAttribute(std::size_t idx, const int* data, std::
@@ -149,6 +157,7 @@ void paz::VertexBuffer::subAttribute(std::size_t idx, const int* data, std::
     _data->checkSize(_data->_dims[idx], size);
     std::copy(data, data + size, reinterpret_cast<int*>([static_cast<id<
         MTLBuffer>>(_data->_buffers[idx]) contents]));
+    frame_stats().bytesUploaded += sizeof(*data)*size;
 }
 
 bool paz::VertexBuffer::empty() const
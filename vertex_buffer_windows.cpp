@@ -34,6 +34,7 @@ void paz::VertexBuffer::Data::addAttribute(int dim, DataType type, const void*
         bufDescriptor.BindFlags = D3D11_BIND_VERTEX_BUFFER;
         D3D11_SUBRESOURCE_DATA srData = {};
         srData.pSysMem = data;
+        frame_stats().bytesUploaded += bufDescriptor.ByteWidth;
         const auto hr = d3d_device()->CreateBuffer(&bufDescriptor, &srData,
             &_buffers.back());
         if(hr)
@@ -118,17 +119,20 @@ void paz::VertexBuffer::addAttribute(int dim, DataType type)
 void paz::VertexBuffer::addAttribute(int dim, const float* data, std::size_t
     size)
 {
+    PAZ_PROFILE("VertexBuffer::addAttribute");
     _data->addAttribute(dim, DataType::Float, data, size);
 }
 
 void paz::VertexBuffer::addAttribute(int dim, const unsigned int* data, std::
     size_t size)
 {
+    PAZ_PROFILE("VertexBuffer::addAttribute");
     _data->addAttribute(dim, DataType::UInt, data, size);
 }
 
 void paz::VertexBuffer::addAttribute(int dim, const int* data, std::size_t size)
 {
+    PAZ_PROFILE("VertexBuffer::addAttribute");
     _data->addAttribute(dim, DataType::SInt, data, size);
 }
 
@@ -145,6 +149,7 @@ void paz::VertexBuffer::subAttribute(std::size_t idx, const float* data, std::
     }
     std::copy(data, data + size, reinterpret_cast<float*>(mappedSr.pData));
     d3d_context()->Unmap(_data->_buffers[idx], 0);
+    frame_stats().bytesUploaded += sizeof(*data)*size;
 }
 
 void paz::VertexBuffer::subAttribute(std::size_t idx, const unsigned int* data,
@@ -161,6 +166,7 @@ void paz::VertexBuffer::subAttribute(std::size_t idx, const unsigned int* data,
     std::copy(data, data + size, reinterpret_cast<unsigned int*>(mappedSr.
         pData));
     d3d_context()->Unmap(_data->_buffers[idx], 0);
+    frame_stats().bytesUploaded += sizeof(*data)*size;
 }
 
 void paz::VertexBuffer::subAttribute(std::size_t idx, const int* data, std::
@@ -176,6 +182,7 @@ void paz::VertexBuffer::subAttribute(std::size_t idx, const int* data, std::
     }
     std::copy(data, data + size, reinterpret_cast<int*>(mappedSr.pData));
     d3d_context()->Unmap(_data->_buffers[idx], 0);
+    frame_stats().bytesUploaded += sizeof(*data)*size;
 }
 
 bool paz::VertexBuffer::empty() const
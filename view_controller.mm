@@ -6,6 +6,7 @@
 #import "view_controller.hh"
 #import "app_delegate.hh"
 #include "keycodes.hpp"
+#include "common.hpp"
 
 @implementation ViewController
 {
@@ -332,6 +333,7 @@
             {
                 _gamepadActive = true;
                 _mouseActive = false;
+                paz::mark_redraw();
                 if(!_gamepadDown[i])
                 {
                     _gamepadPressed[i] = true;
@@ -344,6 +346,7 @@
                 {
                     _gamepadActive = true;
                     _mouseActive = false;
+                    paz::mark_redraw();
                     _gamepadReleased[i] = true;
                 }
                 _gamepadDown[i] = false;
@@ -353,36 +356,42 @@
         {
             _gamepadActive = true;
             _mouseActive = false;
+            paz::mark_redraw();
             _gamepadLeftStick.first = state.axes[0];
         }
         if(std::abs(state.axes[1]) > 0.1)
         {
             _gamepadActive = true;
             _mouseActive = false;
+            paz::mark_redraw();
             _gamepadLeftStick.second = state.axes[1];
         }
         if(std::abs(state.axes[2]) > 0.1)
         {
             _gamepadActive = true;
             _mouseActive = false;
+            paz::mark_redraw();
             _gamepadRightStick.first = state.axes[2];
         }
         if(std::abs(state.axes[3]) > 0.1)
         {
             _gamepadActive = true;
             _mouseActive = false;
+            paz::mark_redraw();
             _gamepadRightStick.second = state.axes[3];
         }
         if(state.axes[4] > -0.9)
         {
             _gamepadActive = true;
             _mouseActive = false;
+            paz::mark_redraw();
             _gamepadLeftTrigger = state.axes[4];
         }
         if(state.axes[5] > -0.9)
         {
             _gamepadActive = true;
             _mouseActive = false;
+            paz::mark_redraw();
             _gamepadRightTrigger = state.axes[5];
         }
     }
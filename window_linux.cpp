@@ -9,10 +9,17 @@
 #include "internal_data.hpp"
 #include "util_linux.hpp"
 #include "gl_core_4_1.h"
+#ifdef PAZ_HEADLESS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#else
 #include <GLFW/glfw3.h>
+#endif
 #include <cmath>
 #include <chrono>
+#include <deque>
 
+#ifndef PAZ_HEADLESS
 static const char* QuadVertSrc = 1 + R"===(
 layout(location = 0) in vec2 pos;
 out vec2 uv;
@@ -69,53 +76,75 @@ static constexpr std::array<float, 8> QuadPos =
     -1, -1,
     -1,  1
 };
+#endif
+
+#ifdef PAZ_HEADLESS
+static constexpr int DontCare = -1;
+static constexpr int HeadlessWidth = 1280;
+static constexpr int HeadlessHeight = 720;
+
+static PAZ_CONTEXT_LOCAL EGLContext _context = EGL_NO_CONTEXT;
+static PAZ_CONTEXT_LOCAL bool _shouldClose;
+#else
+static constexpr int DontCare = GLFW_DONT_CARE;
 
 static GLFWwindow* _windowPtr;
-static int _windowWidth;
-static int _windowHeight;
-static bool _windowIsKey;
-static bool _windowIsFullscreen;
+#endif
+static PAZ_CONTEXT_LOCAL int _windowWidth;
+static PAZ_CONTEXT_LOCAL int _windowHeight;
+static PAZ_CONTEXT_LOCAL bool _windowIsKey;
+static PAZ_CONTEXT_LOCAL bool _windowIsFullscreen;
+#ifndef PAZ_HEADLESS
 static int _prevX;
 static int _prevY;
 static int _prevHeight;
 static int _prevWidth;
-static int _fboWidth;
-static int _fboHeight;
-static float _fboAspectRatio;
-static int _minWidth = GLFW_DONT_CARE;
-static int _minHeight = GLFW_DONT_CARE;
-static int _maxWidth = GLFW_DONT_CARE;
-static int _maxHeight = GLFW_DONT_CARE;
-static std::array<bool, paz::NumKeys> _keyDown;
-static std::array<bool, paz::NumKeys> _keyPressed;
-static std::array<bool, paz::NumKeys> _keyReleased;
-static std::array<bool, paz::NumMouseButtons> _mouseDown;
-static std::array<bool, paz::NumMouseButtons> _mousePressed;
-static std::array<bool, paz::NumMouseButtons> _mouseReleased;
-static std::pair<double, double> _mousePos;
-static std::pair<double, double> _scrollOffset;
-static std::array<bool, paz::NumGamepadButtons> _gamepadDown;
-static std::array<bool, paz::NumGamepadButtons> _gamepadPressed;
-static std::array<bool, paz::NumGamepadButtons> _gamepadReleased;
-static std::pair<double, double> _gamepadLeftStick;
-static std::pair<double, double> _gamepadRightStick;
-static double _gamepadLeftTrigger = -1.;
-static double _gamepadRightTrigger = -1.;
-static bool _gamepadActive;
-static bool _mouseActive;
-static bool _cursorDisabled;
-static bool _frameInProgress;
-static bool _hidpiEnabled = true;
-static bool _syncEnabled = true;
-static float _gamma = 2.2;
-static bool _dither;
-static std::chrono::time_point<std::chrono::steady_clock> _frameStart;
-static int _maxAnisotropy;
-
-static double PrevFrameTime = 1./60.;
-
+#endif
+static PAZ_CONTEXT_LOCAL int _fboWidth;
+static PAZ_CONTEXT_LOCAL int _fboHeight;
+static PAZ_CONTEXT_LOCAL float _fboAspectRatio;
+static PAZ_CONTEXT_LOCAL int _minWidth = DontCare;
+static PAZ_CONTEXT_LOCAL int _minHeight = DontCare;
+static PAZ_CONTEXT_LOCAL int _maxWidth = DontCare;
+static PAZ_CONTEXT_LOCAL int _maxHeight = DontCare;
+static PAZ_CONTEXT_LOCAL std::array<bool, paz::NumKeys> _keyDown;
+static PAZ_CONTEXT_LOCAL std::array<bool, paz::NumKeys> _keyPressed;
+static PAZ_CONTEXT_LOCAL std::array<bool, paz::NumKeys> _keyReleased;
+static PAZ_CONTEXT_LOCAL std::array<bool, paz::NumMouseButtons> _mouseDown;
+static PAZ_CONTEXT_LOCAL std::array<bool, paz::NumMouseButtons> _mousePressed;
+static PAZ_CONTEXT_LOCAL std::array<bool, paz::NumMouseButtons> _mouseReleased;
+static PAZ_CONTEXT_LOCAL std::pair<double, double> _mousePos;
+static PAZ_CONTEXT_LOCAL std::pair<double, double> _scrollOffset;
+static PAZ_CONTEXT_LOCAL std::array<bool, paz::NumGamepadButtons> _gamepadDown;
+static PAZ_CONTEXT_LOCAL std::array<bool, paz::NumGamepadButtons>
+    _gamepadPressed;
+static PAZ_CONTEXT_LOCAL std::array<bool, paz::NumGamepadButtons>
+    _gamepadReleased;
+static PAZ_CONTEXT_LOCAL std::pair<double, double> _gamepadLeftStick;
+static PAZ_CONTEXT_LOCAL std::pair<double, double> _gamepadRightStick;
+static PAZ_CONTEXT_LOCAL double _gamepadLeftTrigger = -1.;
+static PAZ_CONTEXT_LOCAL double _gamepadRightTrigger = -1.;
+static PAZ_CONTEXT_LOCAL bool _gamepadActive;
+static PAZ_CONTEXT_LOCAL bool _mouseActive;
+static PAZ_CONTEXT_LOCAL bool _cursorDisabled;
+static PAZ_CONTEXT_LOCAL bool _frameInProgress;
+static PAZ_CONTEXT_LOCAL bool _resizePending;
+static PAZ_CONTEXT_LOCAL bool _hidpiEnabled = true;
+static PAZ_CONTEXT_LOCAL bool _syncEnabled = true;
+static PAZ_CONTEXT_LOCAL int _maxFramesInFlight;
+static PAZ_CONTEXT_LOCAL std::deque<GLsync> _frameFences;
+static PAZ_CONTEXT_LOCAL float _gamma = 2.2;
+static PAZ_CONTEXT_LOCAL bool _dither;
+static PAZ_CONTEXT_LOCAL std::chrono::time_point<std::chrono::steady_clock>
+    _frameStart;
+static PAZ_CONTEXT_LOCAL int _maxAnisotropy;
+
+static PAZ_CONTEXT_LOCAL double PrevFrameTime = 1./60.;
+
+#ifndef PAZ_HEADLESS
 static void key_callback(int key, int action)
 {
+    paz::mark_redraw();
     _gamepadActive = false;
     _mouseActive = false;
 
@@ -140,6 +169,7 @@ static void key_callback(int key, int action)
 
 static void mouse_button_callback(int button, int action)
 {
+    paz::mark_redraw();
     _gamepadActive = false;
     _mouseActive = true;
 
@@ -174,6 +204,7 @@ static void cursor_position_callback(double xPos, double yPos)
 
     if(newMousePos != _mousePos)
     {
+        paz::mark_redraw();
         _gamepadActive = false;
         _mouseActive = true;
 
@@ -183,6 +214,7 @@ static void cursor_position_callback(double xPos, double yPos)
 
 static void scroll_callback(double xOffset, double yOffset)
 {
+    paz::mark_redraw();
     _gamepadActive = false;
     _mouseActive = true;
 
@@ -192,17 +224,25 @@ static void scroll_callback(double xOffset, double yOffset)
 
 static void focus_callback(int focused)
 {
+    paz::mark_redraw();
     _windowIsKey = focused;
 }
+#endif
 
 static void resize_callback(int width, int height)
 {
     _windowWidth = width;
     _windowHeight = height;
 
+#ifdef PAZ_HEADLESS
+    _fboWidth = width;
+    _fboHeight = height;
+#else
     glfwGetFramebufferSize(_windowPtr, &_fboWidth, &_fboHeight);
+#endif
     _fboAspectRatio = static_cast<float>(_fboWidth)/_fboHeight;
-    paz::resize_targets();
+    _resizePending = true;
+    paz::mark_redraw();
 }
 
 static void reset_events()
@@ -224,6 +264,158 @@ static void reset_events()
     _gamepadRightTrigger = -1.;
 }
 
+#ifdef PAZ_HEADLESS
+static EGLDisplay get_display()
+{
+    // Prefer a display that needs neither a window system nor a surface, then
+    // one backed directly by a GPU device.
+    const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    const auto getPlatformDisplay = reinterpret_cast<
+        PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisp"
+        "layEXT"));
+    if(extensions && getPlatformDisplay)
+    {
+        const std::string str = extensions;
+        if(str.find("EGL_MESA_platform_surfaceless") != std::string::npos)
+        {
+            const EGLDisplay display = getPlatformDisplay(
+                EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if(display != EGL_NO_DISPLAY)
+            {
+                return display;
+            }
+        }
+        const auto queryDevices = reinterpret_cast<PFNEGLQUERYDEVICESEXTPROC>(
+            eglGetProcAddress("eglQueryDevicesEXT"));
+        EGLDeviceEXT device;
+        EGLint numDevices;
+        if(str.find("EGL_EXT_platform_device") != std::string::npos &&
+            queryDevices && queryDevices(1, &device, &numDevices) &&
+            numDevices > 0)
+        {
+            const EGLDisplay display = getPlatformDisplay(
+                EGL_PLATFORM_DEVICE_EXT, device, nullptr);
+            if(display != EGL_NO_DISPLAY)
+            {
+                return display;
+            }
+        }
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+namespace
+{
+    // Shared by the contexts of every thread and terminated at exit.
+    struct Display
+    {
+        EGLDisplay _display = EGL_NO_DISPLAY;
+        EGLConfig _config;
+
+        Display()
+        {
+            _display = get_display();
+            if(_display == EGL_NO_DISPLAY || !eglInitialize(_display, nullptr,
+                nullptr))
+            {
+                throw std::runtime_error("Failed to initialize EGL display.");
+            }
+
+            // No surface is created, so any config that can render OpenGL
+            // will do.
+            const std::array<EGLint, 5> configAttribs = {EGL_SURFACE_TYPE, 0,
+                EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+            EGLint numConfigs;
+            if(!eglChooseConfig(_display, configAttribs.data(), &_config, 1,
+                &numConfigs) || numConfigs < 1)
+            {
+                eglTerminate(_display);
+                throw std::runtime_error("Failed to find an EGL config for Open"
+                    "GL.");
+            }
+        }
+
+        ~Display()
+        {
+            eglTerminate(_display);
+        }
+    };
+}
+
+static const Display& display()
+{
+    static const Display d;
+    return d;
+}
+
+paz::Initializer::~Initializer()
+{
+    eglMakeCurrent(display()._display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+        EGL_NO_CONTEXT);
+    eglDestroyContext(display()._display, _context);
+    eglReleaseThread();
+}
+
+paz::Initializer::Initializer()
+{
+    // The bound API is per thread.
+    if(!eglBindAPI(EGL_OPENGL_API))
+    {
+        throw std::runtime_error("EGL display does not support OpenGL.");
+    }
+
+    // Create context and set as current without a surface.
+    const std::array<EGLint, 7> contextAttribs = {EGL_CONTEXT_MAJOR_VERSION,
+        GlMajorVersion, EGL_CONTEXT_MINOR_VERSION, GlMinorVersion,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE};
+    _context = eglCreateContext(display()._display, display()._config,
+        EGL_NO_CONTEXT, contextAttribs.data());
+    if(_context == EGL_NO_CONTEXT)
+    {
+        throw std::runtime_error("Failed to create EGL context. Your GPU may no"
+            "t be OpenGL " + std::to_string(paz::GlMajorVersion) + "." + std::
+            to_string(paz::GlMinorVersion) + " compatible.");
+    }
+    if(!eglMakeCurrent(display()._display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+        _context))
+    {
+        throw std::runtime_error("Failed to make EGL context current. The drive"
+            "r may not support surfaceless contexts.");
+    }
+
+    // Size the offscreen viewport; there is no display to size it from.
+    _windowIsKey = true;
+    _windowWidth = HeadlessWidth;
+    _windowHeight = HeadlessHeight;
+    _fboWidth = _windowWidth;
+    _fboHeight = _windowHeight;
+    _fboAspectRatio = static_cast<float>(_fboWidth)/_fboHeight;
+
+    // Load OpenGL functions. Entry points are shared by every context.
+    static const bool loaded = ogl_LoadFunctions() != ogl_LOAD_FAILED;
+    if(!loaded)
+    {
+        throw std::runtime_error("Could not load OpenGL functions.");
+    }
+
+    // Activate depth clamping (for logarithmic depth).
+    glEnable(GL_DEPTH_CLAMP);
+
+    // Enable `gl_PointSize`.
+    glEnable(GL_PROGRAM_POINT_SIZE);
+
+    // Get maximum supported anisotropy.
+    {
+        float temp;
+        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &temp);
+        _maxAnisotropy = std::max(1, static_cast<int>(std::round(temp)));
+    }
+
+    // Start recording frame time.
+    _frameStart = std::chrono::steady_clock::now();
+}
+#else
 paz::Initializer::~Initializer()
 {
     glfwTerminate();
@@ -310,6 +502,8 @@ paz::Initializer::Initializer()
         focus_callback(focused); });
     glfwSetWindowSizeCallback(_windowPtr, [](GLFWwindow*, int width, int
         height){ resize_callback(width, height); });
+    glfwSetWindowRefreshCallback(_windowPtr, [](GLFWwindow*){ paz::
+        mark_redraw(); });
 
     // Get maximum supported anisotropy.
     {
@@ -321,11 +515,13 @@ paz::Initializer::Initializer()
     // Start recording frame time.
     _frameStart = std::chrono::steady_clock::now();
 }
+#endif
 
 void paz::Window::MakeFullscreen()
 {
     initialize();
 
+#ifndef PAZ_HEADLESS
     if(!_windowIsFullscreen)
     {
         glfwGetWindowPos(_windowPtr, &_prevX, &_prevY);
@@ -342,12 +538,14 @@ void paz::Window::MakeFullscreen()
         // Keep vsync.
         glfwSwapInterval(_syncEnabled);
     }
+#endif
 }
 
 void paz::Window::MakeWindowed()
 {
     initialize();
 
+#ifndef PAZ_HEADLESS
     if(_windowIsFullscreen)
     {
         glfwSetWindowMonitor(_windowPtr, nullptr, _prevX, _prevY, _prevWidth,
@@ -357,13 +555,18 @@ void paz::Window::MakeWindowed()
         // Keep vsync.
         glfwSwapInterval(_syncEnabled);
     }
+#endif
 }
 
 void paz::Window::SetTitle(const std::string& title)
 {
     initialize();
 
+#ifdef PAZ_HEADLESS
+    static_cast<void>(title);
+#else
     glfwSetWindowTitle(_windowPtr, title.c_str());
+#endif
 }
 
 bool paz::Window::IsKeyWindow()
@@ -454,6 +657,9 @@ std::pair<double, double> paz::Window::MousePos()
 {
     initialize();
 
+#ifdef PAZ_HEADLESS
+    return _mousePos;
+#else
     if(_cursorDisabled)
     {
         return _mousePos;
@@ -464,6 +670,7 @@ std::pair<double, double> paz::Window::MousePos()
         glfwGetCursorPos(_windowPtr, &xPos, &yPos);
         return {xPos, _windowHeight - yPos};
     }
+#endif
 }
 
 std::pair<double, double> paz::Window::ScrollOffset()
@@ -540,6 +747,13 @@ void paz::Window::SetCursorMode(CursorMode mode)
 {
     initialize();
 
+#ifdef PAZ_HEADLESS
+    if(mode != CursorMode::Normal && mode != CursorMode::Hidden && mode !=
+        CursorMode::Disable)
+    {
+        throw std::runtime_error("Unknown cursor mode.");
+    }
+#else
     if(mode == CursorMode::Normal)
     {
         glfwSetInputMode(_windowPtr, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
@@ -556,6 +770,7 @@ void paz::Window::SetCursorMode(CursorMode mode)
     {
         throw std::runtime_error("Unknown cursor mode.");
     }
+#endif
     _cursorDisabled = (mode == CursorMode::Disable);
 }
 
@@ -579,13 +794,20 @@ bool paz::Window::Done()
 {
     initialize();
 
+#ifdef PAZ_HEADLESS
+    return _shouldClose;
+#else
     return glfwWindowShouldClose(_windowPtr);
+#endif
 }
 
 void paz::Window::PollEvents()
 {
     initialize();
 
+    PAZ_PROFILE("Window::PollEvents");
+
+#ifndef PAZ_HEADLESS
     glfwPollEvents();
     GLFWgamepadstate state;
     if(glfwGetGamepadState(GLFW_JOYSTICK_1, &state))
@@ -597,6 +819,7 @@ void paz::Window::PollEvents()
             {
                 _gamepadActive = true;
                 _mouseActive = false;
+                mark_redraw();
                 if(!_gamepadDown[idx])
                 {
                     _gamepadPressed[idx] = true;
@@ -609,6 +832,7 @@ void paz::Window::PollEvents()
                 {
                     _gamepadActive = true;
                     _mouseActive = false;
+                    mark_redraw();
                     _gamepadReleased[idx] = true;
                 }
                 _gamepadDown[idx] = false;
@@ -618,36 +842,42 @@ void paz::Window::PollEvents()
         {
             _gamepadActive = true;
             _mouseActive = false;
+            mark_redraw();
             _gamepadLeftStick.first = state.axes[GLFW_GAMEPAD_AXIS_LEFT_X];
         }
         if(std::abs(state.axes[GLFW_GAMEPAD_AXIS_LEFT_Y]) > 0.1)
         {
             _gamepadActive = true;
             _mouseActive = false;
+            mark_redraw();
             _gamepadLeftStick.second = state.axes[GLFW_GAMEPAD_AXIS_LEFT_Y];
         }
         if(std::abs(state.axes[GLFW_GAMEPAD_AXIS_RIGHT_X]) > 0.1)
         {
             _gamepadActive = true;
             _mouseActive = false;
+            mark_redraw();
             _gamepadRightStick.first = state.axes[GLFW_GAMEPAD_AXIS_RIGHT_X];
         }
         if(std::abs(state.axes[GLFW_GAMEPAD_AXIS_RIGHT_Y]) > 0.1)
         {
             _gamepadActive = true;
             _mouseActive = false;
+            mark_redraw();
             _gamepadRightStick.second = state.axes[GLFW_GAMEPAD_AXIS_RIGHT_Y];
         }
         if(state.axes[GLFW_GAMEPAD_AXIS_LEFT_TRIGGER] > -0.9)
         {
             _gamepadActive = true;
             _mouseActive = false;
+            mark_redraw();
             _gamepadLeftTrigger = state.axes[GLFW_GAMEPAD_AXIS_LEFT_TRIGGER];
         }
         if(state.axes[GLFW_GAMEPAD_AXIS_RIGHT_TRIGGER] > -0.9)
         {
             _gamepadActive = true;
             _mouseActive = false;
+            mark_redraw();
             _gamepadRightTrigger = state.axes[GLFW_GAMEPAD_AXIS_RIGHT_TRIGGER];
         }
     }
@@ -655,14 +885,47 @@ void paz::Window::PollEvents()
     {
         glfwSetCursorPos(_windowPtr, _windowWidth/2, _windowHeight/2);
     }
+#endif
+}
+
+void paz::Window::WaitEvents(double timeout)
+{
+    initialize();
+
+    if(!(timeout >= 0.))
+    {
+        throw std::invalid_argument("Timeout must be nonnegative.");
+    }
+    if(!NeedsRedraw())
+    {
+#ifdef PAZ_HEADLESS
+        wait_for_redraw_request(timeout);
+#else
+        glfwWaitEventsTimeout(timeout);
+#endif
+    }
+    PollEvents();
+}
+
+void paz::wake_event_loop()
+{
+#ifndef PAZ_HEADLESS
+    if(_windowPtr)
+    {
+        glfwPostEmptyEvent();
+    }
+#endif
 }
 
 void paz::Window::EndFrame()
 {
     initialize();
 
+    PAZ_PROFILE("Window::EndFrame");
+
     _frameInProgress = false;
 
+#ifndef PAZ_HEADLESS
     static const unsigned int quadShaderId = []()
     {
         static const std::string headerStr = "#version " + std::to_string(paz::
@@ -755,7 +1018,36 @@ void paz::Window::EndFrame()
     }
 
     glfwSwapBuffers(_windowPtr);
+#else
+    // Nothing is presented, so the frame must be submitted explicitly.
+    glFlush();
+#endif
+    if(_maxFramesInFlight)
+    {
+        // Wait for the oldest frames to finish so that no more than the
+        // maximum are queued.
+        _frameFences.push_back(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        while(_frameFences.size() > static_cast<std::size_t>(
+            _maxFramesInFlight))
+        {
+            glClientWaitSync(_frameFences.front(), GL_SYNC_FLUSH_COMMANDS_BIT,
+                GL_TIMEOUT_IGNORED);
+            glDeleteSync(_frameFences.front());
+            _frameFences.pop_front();
+        }
+    }
+    capture_frame();
+    process_uploads();
+    resolve_gpu_timing();
+    end_frame_stats();
+#ifdef PAZ_HEADLESS
+    pace_frame(false);
+#else
+    pace_frame(!_windowIsKey || glfwGetWindowAttrib(_windowPtr,
+        GLFW_ICONIFIED));
+#endif
     reset_events();
+    release_transients();
     const auto now = std::chrono::steady_clock::now();
     PrevFrameTime = std::chrono::duration_cast<std::chrono::microseconds>(now -
         _frameStart).count()*1e-6;
@@ -766,7 +1058,11 @@ void paz::Window::Quit()
 {
     initialize();
 
+#ifdef PAZ_HEADLESS
+    _shouldClose = true;
+#else
     glfwSetWindowShouldClose(_windowPtr, GLFW_TRUE);
+#endif
 }
 
 double paz::Window::FrameTime()
@@ -782,8 +1078,10 @@ void paz::Window::SetMinSize(int width, int height)
 
     _minWidth = width;
     _minHeight = height;
+#ifndef PAZ_HEADLESS
     glfwSetWindowSizeLimits(_windowPtr, _minWidth, _minHeight, _maxWidth,
         _maxHeight);
+#endif
 }
 
 void paz::Window::SetMaxSize(int width, int height)
@@ -792,22 +1090,28 @@ void paz::Window::SetMaxSize(int width, int height)
 
     _maxWidth = width;
     _maxHeight = height;
+#ifndef PAZ_HEADLESS
     glfwSetWindowSizeLimits(_windowPtr, _minWidth, _minHeight, _maxWidth,
         _maxHeight);
+#endif
 }
 
 void paz::Window::MakeResizable()
 {
     initialize();
 
+#ifndef PAZ_HEADLESS
     glfwSetWindowAttrib(_windowPtr, GLFW_RESIZABLE, GLFW_TRUE);
+#endif
 }
 
 void paz::Window::MakeNotResizable()
 {
     initialize();
 
+#ifndef PAZ_HEADLESS
     glfwSetWindowAttrib(_windowPtr, GLFW_RESIZABLE, GLFW_FALSE);
+#endif
 }
 
 void paz::Window::Resize(int width, int height, bool viewportCoords)
@@ -821,23 +1125,26 @@ void paz::Window::Resize(int width, int height, bool viewportCoords)
     }
     else
     {
-        if(_minWidth != GLFW_DONT_CARE)
+        if(_minWidth != DontCare)
         {
             width = std::max(width, _minWidth);
         }
-        if(_maxWidth != GLFW_DONT_CARE)
+        if(_maxWidth != DontCare)
         {
             width = std::min(width, _maxWidth);
         }
-        if(_minHeight != GLFW_DONT_CARE)
+        if(_minHeight != DontCare)
         {
             height = std::max(height, _minHeight);
         }
-        if(_maxHeight != GLFW_DONT_CARE)
+        if(_maxHeight != DontCare)
         {
             height = std::min(height, _maxHeight);
         }
     }
+#ifdef PAZ_HEADLESS
+    resize_callback(width, height);
+#else
     glfwSetWindowSize(_windowPtr, width, height);
 
     //TEMP - wait until resize has been completed
@@ -848,6 +1155,7 @@ void paz::Window::Resize(int width, int height, bool viewportCoords)
             resize_callback(width, height);
         }
     }
+#endif
 }
 
 void paz::register_target(void* t)
@@ -869,6 +1177,13 @@ void paz::unregister_target(void* t)
 }
 
 paz::Image paz::Window::ReadPixels()
+{
+    Image srgb;
+    ReadPixels(srgb);
+    return srgb;
+}
+
+void paz::Window::ReadPixels(Image& dst)
 {
     initialize();
 
@@ -877,43 +1192,47 @@ paz::Image paz::Window::ReadPixels()
         throw std::logic_error("Cannot read pixels before ending frame.");
     }
 
-    const auto width = ViewportWidth();
-    const auto height = ViewportHeight();
+    const auto width = final_framebuffer().width();
+    const auto height = final_framebuffer().height();
 
-    std::vector<float> linear(4*width*height);
+    // Convert straight out of a pooled pack buffer.
+    ReadbackRequest::Data req;
+    final_framebuffer().colorAttachment(0)._data->queueRead(req, 0, 0, width,
+        height, 8*static_cast<std::size_t>(width)*height);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, final_framebuffer().colorAttachment(0)._data->
-        _id);
-    glPixelStorei(GL_PACK_ALIGNMENT, 1);
-    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, linear.data());
-    const GLenum error = glGetError();
-    if(error != GL_NO_ERROR)
+    if(dst.width() != width || dst.height() != height || dst.format() !=
+        ImageFormat::RGBA8UNorm_sRGB)
     {
-        throw std::runtime_error("Error reading window pixels: " + gl_error(
-            error) + ".");
+        dst = Image(ImageFormat::RGBA8UNorm_sRGB, width, height);
     }
+    convert_to_srgb(static_cast<const std::uint16_t*>(req.map()), 8*width, dst.
+        bytes().data(), width, height, false);
+    req.unmap();
+}
+
+paz::ReadbackRequest paz::Window::ReadPixelsAsync()
+{
+    initialize();
 
-    Image srgb(ImageFormat::RGBA8UNorm_sRGB, width, height);
-    for(int i = 0; i < height; ++i)
+    if(_frameInProgress)
     {
-        for(int j = 0; j < width; ++j)
-        {
-            srgb.bytes()[4*(width*i + j) + 0] = to_srgb(linear[4*(width*i + j)
-                + 0]);
-            srgb.bytes()[4*(width*i + j) + 1] = to_srgb(linear[4*(width*i + j)
-                + 1]);
-            srgb.bytes()[4*(width*i + j) + 2] = to_srgb(linear[4*(width*i + j)
-                + 2]);
-            srgb.bytes()[4*(width*i + j) + 3] = linear[4*(width*i + j) + 3];
-        }
+        throw std::logic_error("Cannot read pixels before ending frame.");
     }
 
-    return srgb;
+    const auto color = final_framebuffer().colorAttachment(0);
+    ReadbackRequest req = color.readAsync(0, 0, color.width(), color.height());
+    req._data->_toSrgb = true;
+    return req;
 }
 
 void paz::begin_frame()
 {
+    // Window size changes are coalesced and applied once per frame.
+    if(_resizePending)
+    {
+        _resizePending = false;
+        resize_targets();
+    }
     _frameInProgress = true;
 }
 
@@ -928,8 +1247,11 @@ float paz::Window::UiScale()
 {
     initialize();
 
-    float xScale, yScale;
+    float xScale = 1.f;
+#ifndef PAZ_HEADLESS
+    float yScale;
     glfwGetWindowContentScale(_windowPtr, &xScale, &yScale);
+#endif
     if(!_hidpiEnabled)
     {
         xScale *= static_cast<float>(_windowWidth)/_fboWidth;
@@ -942,7 +1264,7 @@ void paz::Window::DisableHidpi()
     initialize();
 
     _hidpiEnabled = false;
-    resize_targets();
+    _resizePending = true;
 }
 
 void paz::Window::EnableHidpi()
@@ -950,7 +1272,7 @@ void paz::Window::EnableHidpi()
     initialize();
 
     _hidpiEnabled = true;
-    resize_targets();
+    _resizePending = true;
 }
 
 bool paz::Window::HidpiEnabled()
@@ -1023,4 +1345,31 @@ bool paz::Window::SyncToggleSupported()
     return true;
 }
 
+void paz::Window::SetMaxFramesInFlight(int n)
+{
+    initialize();
+
+    if(n < 0)
+    {
+        throw std::invalid_argument("Maximum number of frames in flight must be"
+            " nonnegative.");
+    }
+    _maxFramesInFlight = n;
+    while(_frameFences.size() > static_cast<std::size_t>(n))
+    {
+        glDeleteSync(_frameFences.front());
+        _frameFences.pop_front();
+    }
+}
+
+void paz::Window::EnableGrowOnlyTargets()
+{
+    initialize().growOnlyTargets = true;
+}
+
+void paz::Window::DisableGrowOnlyTargets()
+{
+    initialize().growOnlyTargets = false;
+}
+
 #endif
@@ -324,6 +324,8 @@ void paz::Window::PollEvents()
 {
     initialize();
 
+    PAZ_PROFILE("Window::PollEvents");
+
     while(true)
     {
         NSEvent* event = [NSApp nextEventMatchingMask:NSEventMaskAny untilDate:
@@ -332,21 +334,63 @@ void paz::Window::PollEvents()
         {
             break;
         }
+        mark_redraw();
         [NSApp sendEvent:event];
         [NSApp updateWindows];
     }
     [VIEW_CONTROLLER pollGamepadState];
 }
 
+void paz::Window::WaitEvents(double timeout)
+{
+    initialize();
+
+    if(!(timeout >= 0.))
+    {
+        throw std::invalid_argument("Timeout must be nonnegative.");
+    }
+    if(!NeedsRedraw())
+    {
+        [NSApp nextEventMatchingMask:NSEventMaskAny untilDate:[NSDate
+            dateWithTimeIntervalSinceNow:timeout] inMode:NSDefaultRunLoopMode
+            dequeue:NO];
+    }
+    PollEvents();
+}
+
+void paz::wake_event_loop()
+{
+    if(!NSApp)
+    {
+        return;
+    }
+    @autoreleasepool
+    {
+        [NSApp postEvent:[NSEvent otherEventWithType:
+            NSEventTypeApplicationDefined location:NSZeroPoint modifierFlags:0
+            timestamp:0 windowNumber:0 context:nil subtype:0 data1:0 data2:0]
+            atStart:NO];
+    }
+}
+
 void paz::Window::EndFrame()
 {
     initialize();
 
+    PAZ_PROFILE("Window::EndFrame");
+
     [RENDERER blitToScreen:static_cast<id<MTLTexture>>(final_framebuffer().
         colorAttachment(0)._data->_texture)];
 
     [[VIEW_CONTROLLER mtkView] draw];
+    capture_frame();
+    process_uploads();
+    resolve_gpu_timing();
+    end_frame_stats();
+    pace_frame(![APP_DELEGATE isFocus] || !([[APP_DELEGATE window]
+        occlusionState]&NSWindowOcclusionStateVisible));
     [VIEW_CONTROLLER resetEvents];
+    release_transients();
     const auto now = std::chrono::steady_clock::now();
     PrevFrameTime = std::chrono::duration_cast<std::chrono::microseconds>(now -
         _frameStart).count()*1e-6;
@@ -429,6 +473,13 @@ void paz::Window::Resize(int width, int height, bool viewportCoords)
 }
 
 paz::Image paz::Window::ReadPixels()
+{
+    Image srgb;
+    ReadPixels(srgb);
+    return srgb;
+}
+
+void paz::Window::ReadPixels(Image& dst)
 {
     initialize();
 
@@ -437,32 +488,38 @@ paz::Image paz::Window::ReadPixels()
         throw std::logic_error("Cannot read pixels before ending frame.");
     }
 
-    const int width = ViewportWidth();
-    const int height = ViewportHeight();
+    const int width = final_framebuffer().width();
+    const int height = final_framebuffer().height();
 
-    std::vector<std::uint16_t> linearFlipped(4*width*height);
+    // Every texel is overwritten, so skip value-initialization.
+    std::unique_ptr<std::uint16_t[]> linearFlipped(new std::uint16_t[4*
+        static_cast<std::size_t>(width)*height]);
     [static_cast<id<MTLTexture>>(final_framebuffer().colorAttachment(0)._data->
-        _texture) getBytes:linearFlipped.data() bytesPerRow:8*width fromRegion:
+        _texture) getBytes:linearFlipped.get() bytesPerRow:8*width fromRegion:
         MTLRegionMake2D(0, 0, width, height) mipmapLevel:0];
 
-    Image rgba(ImageFormat::RGBA8UNorm_sRGB, width, height);
-    static constexpr double d = 1./std::numeric_limits<std::uint16_t>::max();
-    for(int y = 0; y < height; ++y)
+    if(dst.width() != width || dst.height() != height || dst.format() !=
+        ImageFormat::RGBA8UNorm_sRGB)
     {
-        for(int x = 0; x < width; ++x)
-        {
-            const int yFlipped = height - 1 - y;
-            for(int i = 0; i < 3; ++i)
-            {
-                rgba.bytes()[4*(width*y + x) + i] = to_srgb(linearFlipped[4*
-                    (width*yFlipped + x) + i]*d);
-            }
-            rgba.bytes()[4*(width*y + x) + 3] = linearFlipped[4*(width*yFlipped
-                + x) + 3]*d;
-        }
+        dst = Image(ImageFormat::RGBA8UNorm_sRGB, width, height);
+    }
+    convert_to_srgb(linearFlipped.get(), 8*width, dst.bytes().data(), width,
+        height, true);
+}
+
+paz::ReadbackRequest paz::Window::ReadPixelsAsync()
+{
+    initialize();
+
+    if([RENDERER commandBuffer])
+    {
+        throw std::logic_error("Cannot read pixels before ending frame.");
     }
 
-    return rgba;
+    const auto color = final_framebuffer().colorAttachment(0);
+    ReadbackRequest req = color.readAsync(0, 0, color.width(), color.height());
+    req._data->_toSrgb = true;
+    return req;
 }
 
 float paz::Window::DpiScale()
@@ -561,4 +618,29 @@ bool paz::Window::SyncToggleSupported()
     return false;
 }
 
+void paz::Window::SetMaxFramesInFlight(int n)
+{
+    initialize();
+
+    if(n < 0)
+    {
+        throw std::invalid_argument("Maximum number of frames in flight must be"
+            " nonnegative.");
+    }
+
+    // `EndFrame()` waits for the GPU, so only drawables can be queued ahead.
+    [static_cast<CAMetalLayer*>([[VIEW_CONTROLLER mtkView] layer])
+        setMaximumDrawableCount:(n == 1 ? 2 : 3)];
+}
+
+void paz::Window::EnableGrowOnlyTargets()
+{
+    initialize().growOnlyTargets = true;
+}
+
+void paz::Window::DisableGrowOnlyTargets()
+{
+    initialize().growOnlyTargets = false;
+}
+
 #endif
@@ -147,6 +147,7 @@ static bool _mouseActive;
 static bool _cursorDisabled;
 static POINT _priorCursorPos;
 static bool _frameInProgress;
+static bool _resizePending;
 static bool _hidpiEnabled = true;
 static bool _syncEnabled = true;
 static float _gamma = 2.2;
@@ -750,6 +751,13 @@ static LRESULT CALLBACK window_proc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM
         return DefWindowProc(hWnd, uMsg, wParam, lParam);
     }
 
+    if((uMsg >= WM_KEYFIRST && uMsg <= WM_KEYLAST) || (uMsg >= WM_MOUSEFIRST &&
+        uMsg <= WM_MOUSELAST) || uMsg == WM_INPUT || uMsg == WM_SIZE || uMsg ==
+        WM_SETFOCUS || uMsg == WM_KILLFOCUS || uMsg == WM_PAINT)
+    {
+        paz::mark_redraw();
+    }
+
     switch(uMsg)
     {
         case WM_MOUSEACTIVATE:
@@ -1138,7 +1146,7 @@ static LRESULT CALLBACK window_proc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM
                     _fboAspectRatio = static_cast<float>(_fboWidth)/_fboHeight;
                     if(_device)
                     {
-                        paz::resize_targets();
+                        _resizePending = true;
                     }
                 }
             }
@@ -1246,7 +1254,7 @@ static LRESULT CALLBACK window_proc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM
             }
             if(_device)
             {
-                paz::resize_targets();
+                _resizePending = true;
             }
             break;
         }
@@ -1930,6 +1938,8 @@ void paz::Window::PollEvents()
 {
     initialize();
 
+    PAZ_PROFILE("Window::PollEvents");
+
     MSG msg;
     while(PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE))
     {
@@ -1988,6 +1998,7 @@ void paz::Window::PollEvents()
             {
                 _gamepadActive = true;
                 _mouseActive = false;
+                mark_redraw();
                 if(!_gamepadDown[i])
                 {
                     _gamepadPressed[i] = true;
@@ -2000,6 +2011,7 @@ void paz::Window::PollEvents()
                 {
                     _gamepadActive = true;
                     _mouseActive = false;
+                    mark_redraw();
                     _gamepadReleased[i] = true;
                 }
                 _gamepadDown[i] = false;
@@ -2009,24 +2021,28 @@ void paz::Window::PollEvents()
         {
             _gamepadActive = true;
             _mouseActive = false;
+            mark_redraw();
             _gamepadLeftStick.first = state.axes[0];
         }
         if(std::abs(state.axes[1]) > 0.1)
         {
             _gamepadActive = true;
             _mouseActive = false;
+            mark_redraw();
             _gamepadLeftStick.second = state.axes[1];
         }
         if(std::abs(state.axes[2]) > 0.1)
         {
             _gamepadActive = true;
             _mouseActive = false;
+            mark_redraw();
             _gamepadRightStick.first = state.axes[2];
         }
         if(std::abs(state.axes[3]) > 0.1)
         {
             _gamepadActive = true;
             _mouseActive = false;
+            mark_redraw();
             _gamepadRightStick.second = state.axes[3];
         }
 #if 0 //TEMP - need to use XInput to handle XBox controller triggers independently
@@ -2034,12 +2050,14 @@ void paz::Window::PollEvents()
         {
             _gamepadActive = true;
             _mouseActive = false;
+            mark_redraw();
             _gamepadLeftTrigger = state.axes[4];
         }
         if(state.axes[5] > -0.9)
         {
             _gamepadActive = true;
             _mouseActive = false;
+            mark_redraw();
             _gamepadRightTrigger = state.axes[5];
         }
 #else
@@ -2047,22 +2065,50 @@ void paz::Window::PollEvents()
         {
             _gamepadActive = true;
             _mouseActive = false;
+            mark_redraw();
             _gamepadLeftTrigger = 2.*state.axes[4] - 1.;
         }
         else if(state.axes[4] < -0.1)
         {
             _gamepadActive = true;
             _mouseActive = false;
+            mark_redraw();
             _gamepadRightTrigger = -2.*state.axes[4] - 1.;
         }
 #endif
     }
 }
 
+void paz::Window::WaitEvents(double timeout)
+{
+    initialize();
+
+    if(!(timeout >= 0.))
+    {
+        throw std::invalid_argument("Timeout must be nonnegative.");
+    }
+    if(!NeedsRedraw())
+    {
+        MsgWaitForMultipleObjectsEx(0, nullptr, static_cast<DWORD>(std::ceil(
+            1e3*timeout)), QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+    }
+    PollEvents();
+}
+
+void paz::wake_event_loop()
+{
+    if(_windowHandle)
+    {
+        PostMessage(_windowHandle, WM_NULL, 0, 0);
+    }
+}
+
 void paz::Window::EndFrame()
 {
     initialize();
 
+    PAZ_PROFILE("Window::EndFrame");
+
     _frameInProgress = false;
 
     _deviceContext->RSSetState(_blitState);
@@ -2099,7 +2145,13 @@ void paz::Window::EndFrame()
     _deviceContext->Draw(QuadPos.size()/2, 0);
 
     _swapChain->Present(_syncEnabled, 0);
+    capture_frame();
+    process_uploads();
+    resolve_gpu_timing();
+    end_frame_stats();
+    pace_frame(!_windowIsKey || IsIconic(_windowHandle));
     reset_events();
+    release_transients();
     const auto now = std::chrono::steady_clock::now();
     PrevFrameTime = std::chrono::duration_cast<std::chrono::microseconds>(now -
         _frameStart).count()*1e-6;
@@ -2203,7 +2255,7 @@ void paz::Window::Resize(int width, int height, bool viewportCoords)
             rect.bottom - rect.top, SWP_NOACTIVATE|SWP_NOOWNERZORDER|SWP_NOMOVE|
             SWP_NOZORDER);
 
-        resize_targets();
+        _resizePending = true;
     }
 }
 
@@ -2226,6 +2278,13 @@ void paz::unregister_target(void* t)
 }
 
 paz::Image paz::Window::ReadPixels()
+{
+    Image srgb;
+    ReadPixels(srgb);
+    return srgb;
+}
+
+void paz::Window::ReadPixels(Image& dst)
 {
     initialize();
 
@@ -2234,8 +2293,8 @@ paz::Image paz::Window::ReadPixels()
         throw std::logic_error("Cannot read pixels before ending frame.");
     }
 
-    const auto width = ViewportWidth();
-    const auto height = ViewportHeight();
+    const auto width = final_framebuffer().width();
+    const auto height = final_framebuffer().height();
 
     D3D11_TEXTURE2D_DESC descriptor = {};
     descriptor.Width = width;
@@ -2261,36 +2320,46 @@ paz::Image paz::Window::ReadPixels()
     hr = _deviceContext->Map(staging, 0, D3D11_MAP_READ, 0, &mappedSr);
     if(hr)
     {
+        staging->Release();
         throw std::runtime_error("Failed to map staging texture (" +
             format_hresult(hr) + ").");
     }
 
-    Image srgb(ImageFormat::RGBA8UNorm_sRGB, width, height);
-    static constexpr double d = 1./std::numeric_limits<std::uint16_t>::max();
-    for(int y = 0; y < height; ++y)
+    if(dst.width() != width || dst.height() != height || dst.format() !=
+        ImageFormat::RGBA8UNorm_sRGB)
     {
-        for(int x = 0; x < width; ++x)
-        {
-            const int yFlipped = height - 1 - y;
-            std::uint16_t* rowStart = reinterpret_cast<std::uint16_t*>(
-                reinterpret_cast<unsigned char*>(mappedSr.pData) + mappedSr.
-                RowPitch*yFlipped);
-            for(int i = 0; i < 3; ++i)
-            {
-                srgb.bytes()[4*(width*y + x) + i] = to_srgb(*(rowStart + 4*x +
-                    i)*d);
-            }
-            srgb.bytes()[4*(width*y + x) + 3] = *(rowStart + 4*x + 3)*d;
-        }
+        dst = Image(ImageFormat::RGBA8UNorm_sRGB, width, height);
     }
+    convert_to_srgb(reinterpret_cast<const std::uint16_t*>(mappedSr.pData),
+        mappedSr.RowPitch, dst.bytes().data(), width, height, true);
 
     _deviceContext->Unmap(staging, 0);
+    staging->Release();
+}
 
-    return srgb;
+paz::ReadbackRequest paz::Window::ReadPixelsAsync()
+{
+    initialize();
+
+    if(_frameInProgress)
+    {
+        throw std::logic_error("Cannot read pixels before ending frame.");
+    }
+
+    const auto color = final_framebuffer().colorAttachment(0);
+    ReadbackRequest req = color.readAsync(0, 0, color.width(), color.height());
+    req._data->_toSrgb = true;
+    return req;
 }
 
 void paz::begin_frame()
 {
+    // Window size changes are coalesced and applied once per frame.
+    if(_resizePending)
+    {
+        _resizePending = false;
+        resize_targets();
+    }
     _frameInProgress = true;
 }
 
@@ -2321,7 +2390,7 @@ void paz::Window::DisableHidpi()
     initialize();
 
     _hidpiEnabled = false;
-    resize_targets();
+    _resizePending = true;
 }
 
 void paz::Window::EnableHidpi()
@@ -2329,7 +2398,7 @@ void paz::Window::EnableHidpi()
     initialize();
 
     _hidpiEnabled = true;
-    resize_targets();
+    _resizePending = true;
 }
 
 bool paz::Window::HidpiEnabled()
@@ -2402,4 +2471,42 @@ bool paz::Window::SyncToggleSupported()
     return true;
 }
 
+void paz::Window::SetMaxFramesInFlight(int n)
+{
+    initialize();
+
+    if(n < 0)
+    {
+        throw std::invalid_argument("Maximum number of frames in flight must be"
+            " nonnegative.");
+    }
+
+    // DXGI accepts at most 16, and zero restores its default of three.
+    IDXGIDevice1* dxgiDevice;
+    auto hr = d3d_device()->QueryInterface(__uuidof(IDXGIDevice1),
+        reinterpret_cast<void**>(&dxgiDevice));
+    if(hr)
+    {
+        throw std::runtime_error("Failed to get DXGI device (" + format_hresult(
+            hr) + ").");
+    }
+    hr = dxgiDevice->SetMaximumFrameLatency(std::min(n, 16));
+    dxgiDevice->Release();
+    if(hr)
+    {
+        throw std::runtime_error("Failed to set maximum frame latency (" +
+            format_hresult(hr) + ").");
+    }
+}
+
+void paz::Window::EnableGrowOnlyTargets()
+{
+    initialize().growOnlyTargets = true;
+}
+
+void paz::Window::DisableGrowOnlyTargets()
+{
+    initialize().growOnlyTargets = false;
+}
+
 #endif
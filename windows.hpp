@@ -31,6 +31,7 @@
 #include <ntddmou.h>
 #include <d3dcompiler.h>
 #include <d3d11.h>
+#include <d3d11_1.h>
 #include <windowsx.h>
 #include <shellscalingapi.h>
 #include <dbt.h>